@@ -0,0 +1,284 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#include "sync_alloc.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Memory-efficiency benchmark. One explicit arena goes through long phases that change	*
+ * what the heap looks like, and every so often the bytes the program asked for are	*
+ * compared with what the arena mapped (total_arena_bytes) and with what the process	*
+ * really holds (RSS from /proc/self/statm):						*
+ *   grow     small blocks until the live target is reached.				*
+ *   thin     random frees down to a quarter of the target, leaving holes everywhere.	*
+ *   shift    churn at half the target, with medium and large blocks now.		*
+ *   regrow   small blocks up to the target, they should fit the holes left behind.	*
+ *   drain    everything but one block in sixteen is freed.				*
+ *   reset    the arena is reset and grown back to the target, from a clean slate.	*
+ * A sample line is printed at every step, and the peaks of each phase at the end.	*
+ * Tuning from SYN_ALLOC_CONF applies, so two configurations can be compared directly.	*
+ *											*
+ * Usage: frag_bench [live_mib] [ops_per_phase]						*/
+
+static constexpr usize DEFAULT_LIVE_MIB = 16;
+static constexpr u64 DEFAULT_OPS = 200000;
+static constexpr u32 SAMPLES_PER_PHASE = 8;
+
+typedef enum Frag_Phase {
+	PHASE_GROW,
+	PHASE_THIN,
+	PHASE_SHIFT,
+	PHASE_REGROW,
+	PHASE_DRAIN,
+	PHASE_RESET,
+	PHASE_COUNT,
+} frag_phase_t;
+
+static const char *const PHASE_NAMES[PHASE_COUNT] = {"grow", "thin", "shift", "regrow", "drain", "reset"};
+
+typedef enum Size_Mix {
+	MIX_SMALL,
+	MIX_LARGE,
+} size_mix_t;
+
+typedef struct Live_Block {
+	syn_handle_t handle;
+	usize size;
+} live_block_t;
+
+/// Every block the benchmark holds, freed in random order by swapping with the last one.
+typedef struct Live_Set {
+	live_block_t *blocks;
+	usize count;
+	usize capacity;
+	usize bytes;
+} live_set_t;
+
+typedef struct Phase_Peaks {
+	double max_arena_ratio;
+	double max_rss_ratio;
+	usize max_arena_overhead;
+	usize max_rss_overhead;
+} phase_peaks_t;
+
+static syn_arena_t *arena = nullptr;
+static live_set_t live = {};
+static usize rss_baseline = 0;
+static usize phase_start_count = 0;
+static u64 seed = 0x2545F4914F6CDD1DULL;
+
+
+static usize rss_bytes()
+{
+	FILE *statm = fopen("/proc/self/statm", "r");
+	if (statm == nullptr) {
+		return 0;
+	}
+	unsigned long size_pages = 0;
+	unsigned long resident_pages = 0;
+	if (fscanf(statm, "%lu %lu", &size_pages, &resident_pages) != 2) {
+		resident_pages = 0;
+	}
+	fclose(statm);
+	return (usize)resident_pages * (usize)sysconf(_SC_PAGESIZE);
+}
+
+
+static inline u64 next_random()
+{
+	seed ^= seed << 13;
+	seed ^= seed >> 7;
+	seed ^= seed << 17;
+	return seed;
+}
+
+
+static inline usize random_size(const size_mix_t mix)
+{
+	const u64 roll = next_random();
+	if (mix == MIX_SMALL) {
+		return 16 + (usize)(roll % 497);
+	}
+	// Half medium, half large, so neither fits the other's holes exactly.
+	return ((roll >> 32) & 1) ? 4096 + (usize)(roll % (60 * 1024)) : 640 + (usize)(roll % 3456);
+}
+
+
+static inline double mib(const usize bytes)
+{
+	return (double)bytes / (1024.0 * 1024.0);
+}
+
+
+static bool live_alloc(const usize size)
+{
+	if (live.count == live.capacity) {
+		const usize new_capacity = (live.capacity == 0) ? 4096 : live.capacity * 2;
+		live_block_t *new_blocks = realloc(live.blocks, new_capacity * sizeof(live_block_t));
+		if (new_blocks == nullptr) {
+			return false;
+		}
+		live.blocks = new_blocks;
+		live.capacity = new_capacity;
+	}
+
+	syn_handle_t handle = syn_alloc_in(arena, size);
+	char *block = syn_freeze_in(arena, &handle);
+	if (block == nullptr) {
+		return false;
+	}
+	// The whole payload is written, so RSS sees every page the program would use.
+	memset(block, (int)(live.count & 0xFF), size);
+	handle = syn_thaw_in(arena, block);
+
+	live.blocks[live.count++] = (live_block_t){.handle = handle, .size = size};
+	live.bytes += size;
+	return true;
+}
+
+
+static void live_free_random()
+{
+	if (live.count == 0) {
+		return;
+	}
+	const usize index = (usize)(next_random() % live.count);
+	live_block_t *victim = &live.blocks[index];
+
+	live.bytes -= victim->size;
+	syn_free_in(arena, &victim->handle);
+	*victim = live.blocks[--live.count];
+}
+
+
+static void sample(const frag_phase_t phase, const u64 step, phase_peaks_t *peaks)
+{
+	const usize arena_bytes = arena->total_arena_bytes;
+	const usize rss = rss_bytes();
+	const usize held = (rss > rss_baseline) ? rss - rss_baseline : 0;
+	const usize arena_overhead = (arena_bytes > live.bytes) ? arena_bytes - live.bytes : 0;
+	const usize rss_overhead = (held > live.bytes) ? held - live.bytes : 0;
+	const double arena_ratio = (live.bytes != 0) ? (double)arena_bytes / (double)live.bytes : 0.0;
+	const double rss_ratio = (live.bytes != 0) ? (double)held / (double)live.bytes : 0.0;
+
+	printf("%-7s %10lu %10.1f %10.1f %10.1f %9.2f %9.2f\n",
+	       PHASE_NAMES[phase],
+	       (unsigned long)step,
+	       mib(live.bytes),
+	       mib(arena_bytes),
+	       mib(held),
+	       arena_ratio,
+	       rss_ratio);
+	fflush(stdout);
+
+	if (arena_ratio > peaks->max_arena_ratio) {
+		peaks->max_arena_ratio = arena_ratio;
+	}
+	if (rss_ratio > peaks->max_rss_ratio) {
+		peaks->max_rss_ratio = rss_ratio;
+	}
+	if (arena_overhead > peaks->max_arena_overhead) {
+		peaks->max_arena_overhead = arena_overhead;
+	}
+	if (rss_overhead > peaks->max_rss_overhead) {
+		peaks->max_rss_overhead = rss_overhead;
+	}
+}
+
+
+/// Runs one step of a phase, false once the phase has reached its goal early.
+static bool phase_step(const frag_phase_t phase, const usize target)
+{
+	switch (phase) {
+	case PHASE_GROW:
+	case PHASE_REGROW:
+	case PHASE_RESET:
+		return live.bytes < target && live_alloc(random_size(MIX_SMALL));
+	case PHASE_THIN:
+		if (live.bytes <= target / 4) {
+			return false;
+		}
+		live_free_random();
+		return true;
+	case PHASE_SHIFT:
+		if (live.bytes >= target / 2) {
+			live_free_random();
+			return true;
+		}
+		return live_alloc(random_size(MIX_LARGE));
+	case PHASE_DRAIN:
+		if (live.count <= phase_start_count / 16) {
+			return false;
+		}
+		live_free_random();
+		return true;
+	default:
+		return false;
+	}
+}
+
+
+int main(const int argc, char **argv)
+{
+	usize live_mib = DEFAULT_LIVE_MIB;
+	u64 ops = DEFAULT_OPS;
+	if (argc > 1) {
+		live_mib = strtoul(argv[1], nullptr, 10);
+	}
+	if (argc > 2) {
+		ops = strtoull(argv[2], nullptr, 10);
+	}
+	if (live_mib == 0 || ops < SAMPLES_PER_PHASE) {
+		fprintf(stderr, "usage: %s [live_mib] [ops_per_phase]\n", argv[0]);
+		return 1;
+	}
+	const usize target = live_mib * 1024 * 1024;
+
+	rss_baseline = rss_bytes();
+	arena = syn_arena_create(nullptr);
+	if (arena == nullptr) {
+		fprintf(stderr, "could not create an arena!\n");
+		return 1;
+	}
+
+	phase_peaks_t peaks[PHASE_COUNT] = {};
+	printf("%-7s %10s %10s %10s %10s %9s %9s\n", "phase", "step", "live MiB", "arena MiB", "rss MiB", "arena/live", "rss/live");
+
+	for (u32 phase = PHASE_GROW; phase < PHASE_COUNT; phase++) {
+		if (phase == PHASE_RESET) {
+			syn_arena_reset(arena);
+			live.count = 0;
+			live.bytes = 0;
+		}
+		phase_start_count = live.count;
+		const u64 sample_every = ops / SAMPLES_PER_PHASE;
+		u64 step = 0;
+		for (; step < ops; step++) {
+			if (step % sample_every == 0) {
+				sample((frag_phase_t)phase, step, &peaks[phase]);
+			}
+			if (!phase_step((frag_phase_t)phase, target)) {
+				break;
+			}
+		}
+		sample((frag_phase_t)phase, step, &peaks[phase]);
+	}
+
+	printf("\n%-7s %12s %12s %16s %16s\n", "phase", "peak a/l", "peak r/l", "peak arena ovh", "peak rss ovh");
+	for (u32 phase = PHASE_GROW; phase < PHASE_COUNT; phase++) {
+		printf("%-7s %12.2f %12.2f %12.1f MiB %12.1f MiB\n",
+		       PHASE_NAMES[phase],
+		       peaks[phase].max_arena_ratio,
+		       peaks[phase].max_rss_ratio,
+		       mib(peaks[phase].max_arena_overhead),
+		       mib(peaks[phase].max_rss_overhead));
+	}
+
+	syn_arena_destroy(arena);
+	free(live.blocks);
+	return 0;
+}
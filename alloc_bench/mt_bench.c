@@ -0,0 +1,414 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+// mremap() and its flags are GNU extensions.
+#define _GNU_SOURCE
+
+#include "sync_alloc.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Scalability benchmark for the per-thread arenas, in raw mode so blocks can be handed	*
+ * between threads. Three workloads are run at 1..N threads:				*
+ *   churn    every thread allocates and frees a random mix on its own, nothing shared.	*
+ *   spawn    short-lived threads, each one builds an arena, uses it and destroys it,	*
+ *            every thread started counts as one op.					*
+ *   handoff  producer/consumer pairs, every block is freed by the thread that did not	*
+ *            allocate it, so it goes through the owner's remote free list.		*
+ * Every line reports throughput, scaling against one thread, memory syscalls per op	*
+ * and RSS while the arenas are still live.						*
+ *											*
+ * Usage: mt_bench [max_threads] [ops_per_thread]					*/
+
+static constexpr u32 DEFAULT_MAX_THREADS = 16;
+static constexpr u64 DEFAULT_OPS = 2000000;
+static constexpr u32 CHURN_SLOTS = 1024;
+static constexpr u32 SPAWN_ALLOCS = 256;
+static constexpr u32 RING_SLOTS = 256;
+
+typedef enum Bench_Kind {
+	BENCH_CHURN,
+	BENCH_SPAWN,
+	BENCH_HANDOFF,
+} bench_kind_t;
+
+static const char *const BENCH_NAMES[] = {"churn", "spawn", "handoff"};
+
+/// Single-producer single-consumer ring, one per handoff pair.
+typedef struct Handoff_Ring {
+	_Alignas(64) _Atomic u64 head;
+	_Alignas(64) _Atomic u64 tail;
+	_Alignas(64) char *slots[RING_SLOTS];
+} handoff_ring_t;
+
+typedef struct Bench_Thread {
+	pthread_t thread;
+	bench_kind_t kind;
+	u32 index;
+	u64 ops;
+	u64 seed;
+	handoff_ring_t *ring;
+} bench_thread_t;
+
+static pthread_barrier_t start_barrier;
+static pthread_barrier_t end_barrier;
+static pthread_barrier_t release_barrier;
+
+/* The allocator's memory syscalls, counted by interposing the libc wrappers below.	*
+ * The executable's definitions come first in symbol lookup, so every call the library	*
+ * makes through its PLT lands here and goes to the kernel with syscall().		*/
+static _Atomic u64 mmap_calls = 0;
+static _Atomic u64 munmap_calls = 0;
+static _Atomic u64 mprotect_calls = 0;
+static _Atomic u64 madvise_calls = 0;
+static _Atomic u64 mremap_calls = 0;
+
+
+void *mmap(void *addr, const size_t len, const int prot, const int flags, const int fd, const off_t off)
+{
+	atomic_fetch_add_explicit(&mmap_calls, 1, memory_order_relaxed);
+	return (void *)syscall(SYS_mmap, addr, len, prot, flags, fd, off);
+}
+
+
+int munmap(void *addr, const size_t len)
+{
+	atomic_fetch_add_explicit(&munmap_calls, 1, memory_order_relaxed);
+	return (int)syscall(SYS_munmap, addr, len);
+}
+
+
+int mprotect(void *addr, const size_t len, const int prot)
+{
+	atomic_fetch_add_explicit(&mprotect_calls, 1, memory_order_relaxed);
+	return (int)syscall(SYS_mprotect, addr, len, prot);
+}
+
+
+int madvise(void *addr, const size_t len, const int advice)
+{
+	atomic_fetch_add_explicit(&madvise_calls, 1, memory_order_relaxed);
+	return (int)syscall(SYS_madvise, addr, len, advice);
+}
+
+
+void *mremap(void *old_addr, const size_t old_len, const size_t new_len, const int flags, ...)
+{
+	void *new_addr = nullptr;
+	if (flags & MREMAP_FIXED) {
+		va_list args;
+		va_start(args, flags);
+		new_addr = va_arg(args, void *);
+		va_end(args);
+	}
+	atomic_fetch_add_explicit(&mremap_calls, 1, memory_order_relaxed);
+	return (void *)syscall(SYS_mremap, old_addr, old_len, new_len, flags, new_addr);
+}
+
+
+static u64 memory_syscalls()
+{
+	return atomic_load(&mmap_calls) + atomic_load(&munmap_calls) + atomic_load(&mprotect_calls) +
+	       atomic_load(&madvise_calls) + atomic_load(&mremap_calls);
+}
+
+
+static double now_seconds()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + ((double)ts.tv_nsec / 1e9);
+}
+
+
+/// Resident set size from /proc/self/statm, in bytes.
+static usize rss_bytes()
+{
+	FILE *statm = fopen("/proc/self/statm", "r");
+	if (statm == nullptr) {
+		return 0;
+	}
+	unsigned long size_pages = 0;
+	unsigned long resident_pages = 0;
+	if (fscanf(statm, "%lu %lu", &size_pages, &resident_pages) != 2) {
+		resident_pages = 0;
+	}
+	fclose(statm);
+	return (usize)resident_pages * (usize)sysconf(_SC_PAGESIZE);
+}
+
+
+static inline u64 next_random(u64 *seed)
+{
+	u64 x = *seed;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	*seed = x;
+	return x;
+}
+
+
+/// Mostly small blocks, some medium ones and a few large ones, like a typical heap.
+static inline usize random_size(u64 *seed)
+{
+	const u64 roll = next_random(seed);
+	const u32 bucket = (u32)(roll % 100);
+	if (bucket < 80) {
+		return 16 + (usize)((roll >> 8) % 241);
+	}
+	if (bucket < 95) {
+		return 257 + (usize)((roll >> 8) % 3840);
+	}
+	return 4097 + (usize)((roll >> 8) % (60 * 1024));
+}
+
+
+static void run_churn(bench_thread_t *self)
+{
+	char *slots[CHURN_SLOTS] = {};
+
+	pthread_barrier_wait(&start_barrier);
+	for (u64 i = 0; i < self->ops; i++) {
+		const u32 slot = (u32)(next_random(&self->seed) % CHURN_SLOTS);
+		if (slots[slot] != nullptr) {
+			syn_free(slots[slot]);
+			slots[slot] = nullptr;
+			continue;
+		}
+		slots[slot] = syn_alloc(random_size(&self->seed));
+		slots[slot][0] = (char)i;
+	}
+	pthread_barrier_wait(&end_barrier);
+	pthread_barrier_wait(&release_barrier);
+
+	for (u32 slot = 0; slot < CHURN_SLOTS; slot++) {
+		syn_free(slots[slot]);
+	}
+	syn_destroy();
+}
+
+
+static void *spawn_worker(void *arg)
+{
+	bench_thread_t *self = arg;
+	char *blocks[SPAWN_ALLOCS];
+
+	for (u32 i = 0; i < SPAWN_ALLOCS; i++) {
+		blocks[i] = syn_alloc(random_size(&self->seed));
+		blocks[i][0] = (char)i;
+	}
+	for (u32 i = 0; i < SPAWN_ALLOCS; i++) {
+		syn_free(blocks[i]);
+	}
+	syn_destroy();
+	return nullptr;
+}
+
+
+/// Keeps starting one short-lived thread after another, so arena_init and syn_destroy dominate.
+static void run_spawn(bench_thread_t *self)
+{
+	const u64 rounds = self->ops / (SPAWN_ALLOCS * 2);
+
+	pthread_barrier_wait(&start_barrier);
+	for (u64 i = 0; i < rounds; i++) {
+		bench_thread_t worker = {.seed = self->seed + i};
+		pthread_t thread;
+		if (pthread_create(&thread, nullptr, spawn_worker, &worker) != 0) {
+			break;
+		}
+		pthread_join(thread, nullptr);
+	}
+	pthread_barrier_wait(&end_barrier);
+	pthread_barrier_wait(&release_barrier);
+}
+
+
+/// Even threads produce, odd threads consume what their neighbour produced.
+static void run_handoff(bench_thread_t *self)
+{
+	handoff_ring_t *ring = self->ring;
+	const bool producer = (self->index % 2) == 0;
+
+	pthread_barrier_wait(&start_barrier);
+	for (u64 i = 0; i < self->ops; i++) {
+		if (producer) {
+			const u64 head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+			while (head - atomic_load_explicit(&ring->tail, memory_order_acquire) == RING_SLOTS) {
+				sched_yield();
+			}
+			char *block = syn_alloc(64 + (next_random(&self->seed) % 961));
+			block[0] = (char)i;
+			ring->slots[head % RING_SLOTS] = block;
+			atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+			continue;
+		}
+		const u64 tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+		while (atomic_load_explicit(&ring->head, memory_order_acquire) == tail) {
+			sched_yield();
+		}
+		char *block = ring->slots[tail % RING_SLOTS];
+		atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+		if (block[0] != (char)i) {
+			fprintf(stderr, "handoff: block %lu arrived out of order!\n", (unsigned long)i);
+		}
+		syn_free(block);
+	}
+	pthread_barrier_wait(&end_barrier);
+	pthread_barrier_wait(&release_barrier);
+
+	// Every block was consumed by now, the last remote frees are dropped with the producer's pools.
+	syn_destroy();
+}
+
+
+static void *bench_thread_main(void *arg)
+{
+	bench_thread_t *self = arg;
+	switch (self->kind) {
+	case BENCH_CHURN:
+		run_churn(self);
+		break;
+	case BENCH_SPAWN:
+		run_spawn(self);
+		break;
+	case BENCH_HANDOFF:
+		run_handoff(self);
+		break;
+	}
+	return nullptr;
+}
+
+
+typedef struct Bench_Result {
+	double seconds;
+	u64 ops;
+	u64 syscalls;
+	usize rss;
+} bench_result_t;
+
+
+static bench_result_t run_bench(const bench_kind_t kind, const u32 thread_count, const u64 ops)
+{
+	bench_thread_t threads[thread_count];
+	handoff_ring_t *rings = nullptr;
+	if (kind == BENCH_HANDOFF) {
+		rings = aligned_alloc(64, sizeof(handoff_ring_t) * ((thread_count + 1) / 2));
+	}
+
+	pthread_barrier_init(&start_barrier, nullptr, thread_count + 1);
+	pthread_barrier_init(&end_barrier, nullptr, thread_count + 1);
+	pthread_barrier_init(&release_barrier, nullptr, thread_count + 1);
+
+	for (u32 i = 0; i < thread_count; i++) {
+		threads[i] = (bench_thread_t){
+			.kind = kind,
+			.index = i,
+			.ops = ops,
+			.seed = 0x9E3779B97F4A7C15ULL * (i + 1),
+			.ring = nullptr,
+		};
+		if (rings != nullptr) {
+			threads[i].ring = &rings[i / 2];
+			if (i % 2 == 0) {
+				atomic_init(&rings[i / 2].head, 0);
+				atomic_init(&rings[i / 2].tail, 0);
+			}
+		}
+		pthread_create(&threads[i].thread, nullptr, bench_thread_main, &threads[i]);
+	}
+
+	pthread_barrier_wait(&start_barrier);
+	const u64 syscalls_before = memory_syscalls();
+	const double start = now_seconds();
+	pthread_barrier_wait(&end_barrier);
+	const double end = now_seconds();
+	const u64 syscalls_after = memory_syscalls();
+	const usize rss = rss_bytes();
+	pthread_barrier_wait(&release_barrier);
+
+	for (u32 i = 0; i < thread_count; i++) {
+		pthread_join(threads[i].thread, nullptr);
+	}
+	pthread_barrier_destroy(&start_barrier);
+	pthread_barrier_destroy(&end_barrier);
+	pthread_barrier_destroy(&release_barrier);
+	free(rings);
+
+	// A handoff is counted once, on the producer's side.
+	u64 total_ops = ops * thread_count;
+	if (kind == BENCH_HANDOFF) {
+		total_ops = ops * (thread_count / 2);
+	} else if (kind == BENCH_SPAWN) {
+		total_ops = (ops / (SPAWN_ALLOCS * 2)) * thread_count;
+	}
+
+	return (bench_result_t){
+		.seconds = end - start,
+		.ops = total_ops,
+		.syscalls = syscalls_after - syscalls_before,
+		.rss = rss,
+	};
+}
+
+
+int main(const int argc, char **argv)
+{
+	u32 max_threads = (u32)sysconf(_SC_NPROCESSORS_ONLN);
+	if (max_threads > DEFAULT_MAX_THREADS) {
+		max_threads = DEFAULT_MAX_THREADS;
+	}
+	u64 ops = DEFAULT_OPS;
+	if (argc > 1) {
+		max_threads = (u32)strtoul(argv[1], nullptr, 10);
+	}
+	if (argc > 2) {
+		ops = strtoull(argv[2], nullptr, 10);
+	}
+	if (max_threads == 0 || ops == 0) {
+		fprintf(stderr, "usage: %s [max_threads] [ops_per_thread]\n", argv[0]);
+		return 1;
+	}
+
+	printf("%-8s %7s %14s %9s %14s %10s\n", "bench", "threads", "ops/s", "scaling", "syscalls/kop", "rss MiB");
+	for (u32 kind = BENCH_CHURN; kind <= BENCH_HANDOFF; kind++) {
+		double unit_rate = 0.0;
+
+		for (u32 thread_count = 1; thread_count <= max_threads; thread_count *= 2) {
+			// A handoff needs a pair.
+			const u32 threads = (kind == BENCH_HANDOFF && thread_count == 1) ? 2 : thread_count;
+			const bench_result_t result = run_bench((bench_kind_t)kind, threads, ops);
+
+			// Scaling is against one thread, or one pair for handoffs.
+			const double rate = (double)result.ops / result.seconds;
+			const u32 units = (kind == BENCH_HANDOFF) ? threads / 2 : threads;
+			if (unit_rate == 0.0) {
+				unit_rate = rate / units;
+			}
+			printf("%-8s %7u %14.0f %8.2fx %14.3f %10.1f\n",
+			       BENCH_NAMES[kind],
+			       threads,
+			       rate,
+			       rate / unit_rate,
+			       (double)result.syscalls * 1000.0 / (double)result.ops,
+			       (double)result.rss / (1024.0 * 1024.0));
+			fflush(stdout);
+
+			if (kind == BENCH_HANDOFF && thread_count == 1) {
+				thread_count = 2;
+			}
+		}
+	}
+	return 0;
+}
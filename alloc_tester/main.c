@@ -1,4 +1,5 @@
 #include "sync_alloc.h"
+#include "tests.h"
 #include <assert.h>
 #include <stdio.h>
 #include <string.h>
@@ -13,7 +14,7 @@ static constexpr u_int32_t SIZE = 64;
 static constexpr char TEXTDATA[SIZE] =
 	"meowmeowmeowmeowmeowmeowmeowmeowmeowmeowmeowmeowmeowmeowmeowmeo";
 
-int main()
+static void test_churn()
 {
 	// syn_handle_t new_hdl = syn_alloc((128 * 1024) - 16);
 	// char *msg = syn_freeze(&new_hdl);
@@ -74,6 +75,37 @@ int main()
 }
 
 
+int main()
+{
+	test_churn();
+	test_scope_realloc();
+	test_scope_stale_handle();
+	test_arena_isolation();
+	test_aligned_gap_reuse();
+	test_aligned_realloc();
+	test_memops_kernels();
+	test_memops_stream();
+	test_calloc_reuse();
+	test_quarantine_scrub();
+	test_guard_sampled();
+	test_ref_lifecycle();
+	test_handle_table_growth();
+	test_slab_release_full();
+	test_pin_deferred_free();
+	test_destroy_sensitive();
+	test_config_override();
+	test_persist_reopen();
+	test_snapshot_restore();
+	test_shared_view();
+	test_objpool_lifecycle();
+	test_huge_remap();
+	test_growbuf_in_place();
+	test_limit_pressure();
+	puts("tester: all tests passed");
+	return 0;
+}
+
+
 //void test_memcpy()
 //{
 //	srand(time(nullptr));
@@ -0,0 +1,18 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#include "sync_alloc.h"
+#include "tests.h"
+#include <stdio.h>
+
+
+int main()
+{
+	test_raw_scope_realloc();
+	test_raw_thread_exit();
+	test_raw_remote_double_free();
+	test_raw_shim();
+	puts("tester_raw: all tests passed");
+	return 0;
+}
@@ -0,0 +1,36 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#include "sync_alloc.h"
+#include "tests.h"
+#include <assert.h>
+#include <string.h>
+
+
+/// A ptr from before a scope must survive the pop, even if it was reallocated inside it.
+void test_raw_scope_realloc()
+{
+	char *outer = syn_alloc(64);
+	memset(outer, 'o', 64);
+
+	const syn_scope_t mark = syn_scope_push();
+	assert(syn_realloc(outer, 4096) == nullptr);
+	assert(syn_realloc(outer, 32) == outer);
+
+	char *inner = syn_alloc(64);
+	inner = syn_realloc(inner, 4096);
+	assert(inner != nullptr);
+	syn_scope_pop(mark);
+
+	char *fresh = syn_alloc(4096);
+	memset(fresh, 'f', 4096);
+	assert(outer[0] == 'o' && outer[63] == 'o');
+
+	outer = syn_realloc(outer, 4096);
+	assert(outer != nullptr && outer[0] == 'o' && outer[63] == 'o');
+	syn_free(outer);
+	syn_free(fresh);
+
+	syn_destroy();
+}
@@ -0,0 +1,49 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#include "sync_alloc.h"
+#include "tests.h"
+#include <assert.h>
+#include <errno.h>
+#include <malloc.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/// The libc entry points must hand out arena blocks, and keep libc's semantics while doing so.
+void test_raw_shim()
+{
+	char *block = malloc(100);
+	// Only a block with our header in front of it can be frozen.
+	assert(block != nullptr && syn_freeze(block) == block);
+	syn_thaw(block);
+	assert(malloc_usable_size(block) >= 100);
+	memset(block, 'm', 100);
+
+	block = realloc(block, 20000);
+	assert(block != nullptr && block[0] == 'm' && block[99] == 'm');
+	free(block);
+
+	const u8 *zeroed = calloc(64, 64);
+	assert(zeroed != nullptr);
+	for (usize i = 0; i < 64 * 64; i++) {
+		assert(zeroed[i] == 0);
+	}
+	free((void *)zeroed);
+
+	// Volatile, so the compiler can not see the overflow coming and warn about it.
+	volatile usize huge_count = SIZE_MAX / 2;
+	errno = 0;
+	assert(calloc(huge_count, 4) == nullptr && errno == ENOMEM);
+
+	void *aligned = nullptr;
+	assert(posix_memalign(&aligned, 256, 300) == 0);
+	assert(aligned != nullptr && ((uintptr_t)aligned & 255) == 0);
+	free(aligned);
+	assert(posix_memalign(&aligned, 48, 300) == EINVAL);
+	free(nullptr);
+
+	syn_destroy();
+}
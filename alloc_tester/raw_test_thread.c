@@ -0,0 +1,66 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#include "sync_alloc.h"
+#include "tests.h"
+#include <assert.h>
+#include <pthread.h>
+#include <string.h>
+
+// Past a page, so the guard sampler never takes it and both threads get a pool block.
+constexpr usize THREAD_BLOCK_SIZE = 5000;
+
+
+static void *alloc_and_exit(void *arg)
+{
+	(void)arg;
+	char *block = syn_alloc(THREAD_BLOCK_SIZE);
+	assert(block != nullptr);
+	memset(block, 't', THREAD_BLOCK_SIZE);
+	return block;
+}
+
+
+/// The arena of an exited thread must outlive it, and be adopted with the frees it got meanwhile.
+void test_raw_thread_exit()
+{
+	pthread_t thread;
+	char *orphaned = nullptr;
+	assert(pthread_create(&thread, nullptr, alloc_and_exit, nullptr) == 0);
+	assert(pthread_join(thread, (void **)&orphaned) == 0);
+
+	// Still readable after its thread is gone, and freeing it queues it on the parked arena.
+	assert(orphaned[0] == 't' && orphaned[THREAD_BLOCK_SIZE - 1] == 't');
+	syn_free(orphaned);
+
+	char *adopted = nullptr;
+	assert(pthread_create(&thread, nullptr, alloc_and_exit, nullptr) == 0);
+	assert(pthread_join(thread, (void **)&adopted) == 0);
+	assert(adopted == orphaned);
+	syn_free(adopted);
+}
+
+
+/// A block freed twice by threads that do not own it must be queued, and handed out, only once.
+void test_raw_remote_double_free()
+{
+	pthread_t thread;
+	char *orphaned = nullptr;
+	assert(pthread_create(&thread, nullptr, alloc_and_exit, nullptr) == 0);
+	assert(pthread_join(thread, (void **)&orphaned) == 0);
+
+	syn_free(orphaned);
+	syn_free(orphaned);
+
+	char *first = nullptr;
+	assert(pthread_create(&thread, nullptr, alloc_and_exit, nullptr) == 0);
+	assert(pthread_join(thread, (void **)&first) == 0);
+	char *second = nullptr;
+	assert(pthread_create(&thread, nullptr, alloc_and_exit, nullptr) == 0);
+	assert(pthread_join(thread, (void **)&second) == 0);
+
+	assert(first == orphaned && second != orphaned);
+	syn_free(first);
+	syn_free(second);
+}
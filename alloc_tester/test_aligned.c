@@ -0,0 +1,66 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#include "sync_alloc.h"
+#include "tests.h"
+#include <assert.h>
+#include <stdint.h>
+
+constexpr usize GAP_ALIGN = 128;
+
+
+static uintptr_t block_addr(syn_handle_t *hdl)
+{
+	const uintptr_t addr = (uintptr_t)syn_freeze(hdl);
+	*hdl = syn_thaw((void *)addr);
+	return addr;
+}
+
+
+/// The leading gap of an over-aligned block has to be handed out again by some later allocation.
+void test_aligned_gap_reuse()
+{
+	// A sampled block would not land next to its neighbours, the default rate is turned back on below.
+	syn_set_sample_rate(0);
+
+	syn_handle_t first = syn_alloc(64);
+	syn_handle_t second = syn_alloc(64);
+	const uintptr_t stride = block_addr(&second) - block_addr(&first);
+
+	// Every filler shifts the frontier by one stride, which walks it through the 128 byte residues.
+	for (int i = 0; i < 8; i++) {
+		syn_handle_t filler = syn_alloc(64);
+		syn_handle_t aligned = syn_alloc_aligned(64, GAP_ALIGN);
+		const uintptr_t gap_block = block_addr(&filler) + stride;
+		const uintptr_t aligned_block = block_addr(&aligned);
+		assert(aligned_block % GAP_ALIGN == 0);
+		if (aligned_block == gap_block) {
+			continue;
+		}
+
+		bool reused = false;
+		for (usize size = 64; size <= aligned_block - gap_block && !reused; size += 16) {
+			syn_handle_t probe = syn_alloc(size);
+			reused = (block_addr(&probe) == gap_block);
+		}
+		assert(reused);
+	}
+
+	syn_set_sample_rate(4096);
+	syn_destroy();
+}
+
+
+/// A realloc that moves an over-aligned block must keep its alignment.
+void test_aligned_realloc()
+{
+	syn_handle_t aligned = syn_alloc_aligned(100, 256);
+	for (usize size = 200; size <= 6400; size *= 2) {
+		syn_handle_t filler = syn_alloc(48);
+		(void)filler;
+		assert(syn_realloc(&aligned, size) == 0);
+		assert(block_addr(&aligned) % 256 == 0);
+	}
+	syn_destroy();
+}
@@ -0,0 +1,48 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#include "sync_alloc.h"
+#include "tests.h"
+#include <assert.h>
+#include <string.h>
+
+
+/// Explicit arenas are independent of each other and of the thread arena, and reject each other's handles.
+void test_arena_isolation()
+{
+	syn_arena_t *first = syn_arena_create(nullptr);
+	const syn_arena_opts_t opts = {.first_pool_size = 256 * 1024};
+	syn_arena_t *second = syn_arena_create(&opts);
+	assert(first != nullptr && second != nullptr && first != second);
+
+	syn_handle_t first_hdl = syn_alloc_in(first, 64);
+	syn_handle_t second_hdl = syn_calloc_in(second, 64);
+	char *first_msg = syn_freeze_in(first, &first_hdl);
+	assert(first_msg != nullptr);
+	memset(first_msg, '1', 64);
+	first_hdl = syn_thaw_in(first, first_msg);
+
+	assert(syn_freeze_in(second, &first_hdl) == nullptr);
+	syn_free_in(second, &first_hdl);
+	first_msg = syn_pin_in(first, &first_hdl);
+	assert(first_msg != nullptr && first_msg[0] == '1' && first_msg[63] == '1');
+	syn_unpin_in(first, &first_hdl);
+
+	// Resetting one arena leaves the other's blocks alone.
+	syn_arena_reset(second);
+	assert(syn_freeze_in(second, &second_hdl) == nullptr);
+	first_msg = syn_freeze_in(first, &first_hdl);
+	assert(first_msg != nullptr && first_msg[0] == '1');
+	first_hdl = syn_thaw_in(first, first_msg);
+
+	assert(syn_realloc_in(first, &first_hdl, 8192) == 0);
+	first_msg = syn_freeze_in(first, &first_hdl);
+	assert(first_msg != nullptr && first_msg[0] == '1' && first_msg[63] == '1');
+	first_hdl = syn_thaw_in(first, first_msg);
+	syn_free_in(first, &first_hdl);
+
+	syn_arena_destroy(second);
+	syn_arena_destroy(first);
+	syn_destroy();
+}
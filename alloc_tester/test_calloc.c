@@ -0,0 +1,66 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#include "sync_alloc.h"
+#include "tests.h"
+#include <assert.h>
+#include <string.h>
+
+static constexpr usize CALLOC_SIZE = 3000;
+static constexpr usize CALLOC_COUNT = 64;
+
+
+static void dirty_and_free(const u8 byte)
+{
+	syn_handle_t hdls[CALLOC_COUNT];
+	for (usize i = 0; i < CALLOC_COUNT; i++) {
+		hdls[i] = syn_alloc(CALLOC_SIZE);
+		char *msg = syn_freeze(&hdls[i]);
+		assert(msg != nullptr);
+		memset(msg, byte, CALLOC_SIZE);
+		hdls[i] = syn_thaw(msg);
+	}
+	for (usize i = 0; i < CALLOC_COUNT; i++) {
+		syn_free(&hdls[i]);
+	}
+}
+
+
+static void calloc_all_zeroed()
+{
+	syn_handle_t hdls[CALLOC_COUNT];
+	for (usize i = 0; i < CALLOC_COUNT; i++) {
+		hdls[i] = syn_calloc(CALLOC_SIZE);
+		const u8 *msg = syn_freeze(&hdls[i]);
+		assert(msg != nullptr);
+		for (usize j = 0; j < CALLOC_SIZE; j++) {
+			assert(msg[j] == 0);
+		}
+		hdls[i] = syn_thaw((void *)msg);
+	}
+	for (usize i = 0; i < CALLOC_COUNT; i++) {
+		syn_free(&hdls[i]);
+	}
+}
+
+
+/// calloc may only skip the memset for memory nothing ever wrote, reused blocks and pools still get zeroed.
+void test_calloc_reuse()
+{
+	// Freed blocks, reused from the free list.
+	dirty_and_free('f');
+	calloc_all_zeroed();
+
+	// A reset pool, bumped over again from the start.
+	dirty_and_free('r');
+	syn_reset();
+	calloc_all_zeroed();
+
+	// A destroyed arena's pool, handed to the next arena by the region cache.
+	dirty_and_free('d');
+	syn_destroy();
+	calloc_all_zeroed();
+
+	syn_destroy();
+}
@@ -0,0 +1,54 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#include "sync_alloc.h"
+#include "tests.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+static constexpr usize CONFIG_BLOCK_SIZE = 96;
+static constexpr int CONFIG_TRIES = 16;
+
+
+/// Reports whether any of a few allocations landed in a guard slot, right against a page end.
+static bool config_sampling_on()
+{
+	bool sampled = false;
+	for (int i = 0; i < CONFIG_TRIES; i++) {
+		syn_handle_t hdl = syn_alloc(CONFIG_BLOCK_SIZE);
+		char *block = syn_freeze(&hdl);
+		assert(block != nullptr);
+		sampled |= (((uintptr_t)block + CONFIG_BLOCK_SIZE) % 4096 == 0);
+		hdl = syn_thaw(block);
+		syn_free(&hdl);
+	}
+	return sampled;
+}
+
+
+/// A bad configuration changes nothing, and SYN_ALLOC_CONF applies on top of a good one pair by pair.
+void test_config_override()
+{
+	const syn_config_t defaults = syn_default_config();
+
+	syn_config_t config = defaults;
+	config.pool_growth = 1;
+	assert(syn_configure(&config) == 1);
+	assert(syn_configure(nullptr) == 1);
+
+	// The bad pairs are reported and skipped, the good one still overrides the program's choice.
+	config = defaults;
+	config.sample_rate = 0;
+	assert(setenv("SYN_ALLOC_CONF", "bogus=1,sample_rate=1,pool_growth=99", 1) == 0);
+	assert(syn_configure(&config) == 0);
+	assert(config_sampling_on());
+
+	assert(unsetenv("SYN_ALLOC_CONF") == 0);
+	assert(syn_configure(&config) == 0);
+	assert(!config_sampling_on());
+
+	assert(syn_configure(&defaults) == 0);
+	syn_destroy();
+}
@@ -0,0 +1,64 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#include "sync_alloc.h"
+#include "tests.h"
+#include <assert.h>
+
+static constexpr usize GROWBUF_MAX = 64 * 1024 * 1024;
+static constexpr usize GROWBUF_FILLED = 8 * 1024 * 1024;
+static constexpr usize GROWBUF_STEP = 100 * 1000;
+
+
+/// A growbuf commits pages in place while pinned, so its payload never moves, up to its maximum and no further.
+void test_growbuf_in_place()
+{
+	syn_handle_t hdl = syn_growbuf_create(GROWBUF_MAX);
+	unsigned char *buf = syn_pin(&hdl);
+	assert(buf != nullptr);
+	for (usize i = 0; i < 4096 - 64; i++) {
+		assert(buf[i] == 0);
+	}
+
+	// Grown a little at a time, like a builder appending, every byte written so far stays put.
+	for (usize end = GROWBUF_STEP; end <= GROWBUF_FILLED; end += GROWBUF_STEP) {
+		assert(syn_growbuf_reserve(buf, end) == 0);
+		buf[end - 1] = (unsigned char)(end / GROWBUF_STEP);
+	}
+	for (usize end = GROWBUF_STEP; end <= GROWBUF_FILLED; end += GROWBUF_STEP) {
+		assert(buf[end - 1] == (unsigned char)(end / GROWBUF_STEP));
+	}
+	// The reservation is rounded up to a page, so only a whole page past the maximum is out of reach.
+	assert(syn_growbuf_reserve(buf, GROWBUF_MAX + 4096) == 1);
+	syn_unpin(&hdl);
+
+	// syn_realloc() grows it in place as well, the handle keeps pointing at the same payload.
+	assert(syn_realloc(&hdl, GROWBUF_FILLED * 2) == 0);
+	unsigned char *grown = syn_freeze(&hdl);
+	assert(grown == buf && grown[GROWBUF_STEP - 1] == 1);
+	grown[(GROWBUF_FILLED * 2) - 1] = 'z';
+	hdl = syn_thaw(grown);
+
+	// Past its maximum it is not quietly moved into an ordinary block, the realloc fails and it stays put.
+	assert(syn_realloc(&hdl, GROWBUF_MAX + 4096) == 1);
+	grown = syn_freeze(&hdl);
+	assert(grown == buf && grown[(GROWBUF_FILLED * 2) - 1] == 'z');
+	assert(syn_growbuf_reserve(grown, GROWBUF_FILLED * 4) == 0);
+	hdl = syn_thaw(grown);
+
+	// Ordinary blocks are turned away, and a scope refuses to make a growbuf at all.
+	syn_handle_t plain = syn_alloc(64);
+	void *plain_ptr = syn_freeze(&plain);
+	assert(syn_growbuf_reserve(plain_ptr, 128) == 1);
+	plain = syn_thaw(plain_ptr);
+	const syn_scope_t mark = syn_scope_push();
+	syn_handle_t scoped = syn_growbuf_create(GROWBUF_MAX);
+	assert(syn_freeze(&scoped) == nullptr);
+	syn_scope_pop(mark);
+
+	syn_free(&hdl);
+	assert(syn_freeze(&hdl) == nullptr);
+	syn_free(&plain);
+	syn_destroy();
+}
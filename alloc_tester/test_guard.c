@@ -0,0 +1,84 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#include "sync_alloc.h"
+#include "tests.h"
+#include <assert.h>
+#include <signal.h>
+#include <stdint.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Neither is a multiple of ALIGNMENT, so any padding would leave room for an overflow that does not fault.
+static constexpr usize GUARD_BLOCK_SIZE = 24;
+static constexpr usize GUARD_ODD_SIZE = 17;
+static constexpr int GUARD_TRIES = 16;
+
+
+/// Runs the access in a child, and reports whether it died on a fault.
+static bool access_faults(volatile char *byte, const bool write)
+{
+	const pid_t pid = fork();
+	assert(pid >= 0);
+	if (pid == 0) {
+		if (write) {
+			*byte = 'x';
+		} else {
+			(void)*byte;
+		}
+		_exit(0);
+	}
+	int status = 0;
+	assert(waitpid(pid, &status, 0) == pid);
+	return WIFSIGNALED(status) && WTERMSIG(status) == SIGSEGV;
+}
+
+
+/// Allocates until a block lands in a guard slot, which ends exactly on a page boundary.
+static char *sample_guarded(const usize size, syn_handle_t *guarded_hdl)
+{
+	for (int i = 0; i < GUARD_TRIES; i++) {
+		syn_handle_t hdl = syn_alloc(size);
+		char *block = syn_freeze(&hdl);
+		assert(block != nullptr);
+		hdl = syn_thaw(block);
+		if (((uintptr_t)block + size) % 4096 == 0) {
+			*guarded_hdl = hdl;
+			return block;
+		}
+	}
+	return nullptr;
+}
+
+
+/// A sampled block sits against a guard page, so an overflow by a single byte or a use after free faults on the spot.
+void test_guard_sampled()
+{
+	syn_set_sample_rate(1);
+	syn_handle_t guarded_hdl = {};
+	char *guarded = sample_guarded(GUARD_BLOCK_SIZE, &guarded_hdl);
+	syn_handle_t odd_hdl = {};
+	char *odd = sample_guarded(GUARD_ODD_SIZE, &odd_hdl);
+	syn_set_sample_rate(4096);
+	assert(guarded != nullptr && odd != nullptr);
+	assert((uintptr_t)guarded % 8 == 0);
+
+	guarded[0] = 'g';
+	guarded[GUARD_BLOCK_SIZE - 1] = 'g';
+	assert(access_faults(guarded + GUARD_BLOCK_SIZE, true));
+	odd[GUARD_ODD_SIZE - 1] = 'o';
+	assert(access_faults(odd + GUARD_ODD_SIZE, true));
+
+	// Growing a guarded block moves it out of the slot with its contents.
+	assert(syn_realloc(&odd_hdl, 4 * GUARD_ODD_SIZE) == 0);
+	char *moved = syn_freeze(&odd_hdl);
+	assert(moved != nullptr && moved[GUARD_ODD_SIZE - 1] == 'o');
+	odd_hdl = syn_thaw(moved);
+	assert(access_faults(odd, false));
+
+	syn_free(&guarded_hdl);
+	assert(access_faults(guarded, false));
+
+	syn_destroy();
+}
@@ -0,0 +1,68 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#include "sync_alloc.h"
+#include "tests.h"
+#include <assert.h>
+#include <stdlib.h>
+
+// Hundreds of tables, so they span several table slabs of growing size.
+static constexpr u32 TABLE_HANDLES = 20000;
+
+
+static void check_handle(syn_handle_t *hdl, const u32 id)
+{
+	u32 *block = syn_freeze(hdl);
+	assert(block != nullptr && *block == id);
+	*hdl = syn_thaw(block);
+}
+
+
+/// Handles stay valid while their tables are carved from one slab after another, and freed entries are reused.
+void test_handle_table_growth()
+{
+	syn_handle_t *hdls = malloc(sizeof(syn_handle_t) * TABLE_HANDLES);
+	assert(hdls != nullptr);
+
+	for (u32 i = 0; i < TABLE_HANDLES; i++) {
+		hdls[i] = syn_alloc(sizeof(u32));
+		u32 *block = syn_freeze(&hdls[i]);
+		assert(block != nullptr);
+		*block = i;
+		hdls[i] = syn_thaw(block);
+	}
+	for (u32 i = 0; i < TABLE_HANDLES; i++) {
+		check_handle(&hdls[i], i);
+	}
+
+	for (u32 i = 0; i < TABLE_HANDLES; i += 2) {
+		syn_free(&hdls[i]);
+	}
+	for (u32 i = 0; i < TABLE_HANDLES; i += 2) {
+		hdls[i] = syn_alloc(sizeof(u32));
+		u32 *block = syn_freeze(&hdls[i]);
+		assert(block != nullptr);
+		*block = i;
+		hdls[i] = syn_thaw(block);
+	}
+	for (u32 i = 0; i < TABLE_HANDLES; i++) {
+		check_handle(&hdls[i], i);
+	}
+
+	// A reset keeps the first table only, and the arena has to grow its tables again from there.
+	syn_reset();
+	for (u32 i = 0; i < TABLE_HANDLES; i++) {
+		hdls[i] = syn_alloc(sizeof(u32));
+		u32 *block = syn_freeze(&hdls[i]);
+		assert(block != nullptr);
+		*block = ~i;
+		hdls[i] = syn_thaw(block);
+	}
+	for (u32 i = 0; i < TABLE_HANDLES; i++) {
+		check_handle(&hdls[i], ~i);
+	}
+
+	free(hdls);
+	syn_destroy();
+}
@@ -0,0 +1,62 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#include "sync_alloc.h"
+#include "tests.h"
+#include <assert.h>
+
+// Large enough to get a pool of its own, so syn_realloc() can remap it instead of copying.
+static constexpr usize HUGE_START_SIZE = 4 * 1024 * 1024;
+static constexpr usize HUGE_GROWN_SIZE = 32 * 1024 * 1024;
+static constexpr usize HUGE_STRIDE = 4096;
+
+
+static void fill_pages(syn_handle_t *hdl, const usize from, const usize to)
+{
+	unsigned char *block = syn_freeze(hdl);
+	assert(block != nullptr);
+	for (usize i = from; i < to; i += HUGE_STRIDE) {
+		block[i] = (unsigned char)(i / HUGE_STRIDE);
+	}
+	block[to - 1] = 0xEE;
+	*hdl = syn_thaw(block);
+}
+
+
+static void check_pages(syn_handle_t *hdl, const usize size)
+{
+	unsigned char *block = syn_freeze(hdl);
+	assert(block != nullptr);
+	for (usize i = 0; i < size; i += HUGE_STRIDE) {
+		assert(block[i] == (unsigned char)(i / HUGE_STRIDE));
+	}
+	*hdl = syn_thaw(block);
+}
+
+
+/// A block alone in its pool grows by remapping, keeping every byte, and the handle follows it.
+void test_huge_remap()
+{
+	syn_handle_t hdl = syn_alloc(HUGE_START_SIZE);
+	fill_pages(&hdl, 0, HUGE_START_SIZE);
+
+	const syn_handle_t before = hdl;
+	assert(syn_realloc(&hdl, HUGE_GROWN_SIZE) == 0);
+	check_pages(&hdl, HUGE_START_SIZE);
+	syn_handle_t stale = before;
+	assert(syn_freeze(&stale) == nullptr);
+
+	// The whole new size is usable, and a second remap keeps what the first one added.
+	fill_pages(&hdl, HUGE_START_SIZE, HUGE_GROWN_SIZE);
+	assert(syn_realloc(&hdl, HUGE_GROWN_SIZE * 2) == 0);
+	check_pages(&hdl, HUGE_GROWN_SIZE);
+
+	// Small blocks around it are untouched by the pool moving.
+	syn_handle_t small = syn_alloc(64);
+	assert(syn_realloc(&hdl, HUGE_START_SIZE) == 0);
+	check_pages(&hdl, HUGE_START_SIZE);
+	assert(syn_freeze(&small) != nullptr);
+
+	syn_destroy();
+}
@@ -0,0 +1,71 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#include "sync_alloc.h"
+#include "tests.h"
+#include <assert.h>
+
+static constexpr usize LIMIT_POOL_SIZE = 64 * 1024;
+static constexpr usize LIMIT_BYTES = 512 * 1024;
+static constexpr usize LIMIT_BLOCK_SIZE = 20000;
+static constexpr int LIMIT_MAX_BLOCKS = 256;
+
+typedef struct Limit_State {
+	int calls[SYN_PRESSURE_OOM + 1];
+	syn_arena_t *arena;
+	syn_handle_t *victim;	/**< Freed by the next call, if any.	*/
+} limit_state_t;
+
+
+static void limit_callback(syn_arena_t *arena, const syn_pressure_t reason, const size_t request_bytes, void *user_data)
+{
+	limit_state_t *state = user_data;
+	assert(arena == state->arena && request_bytes == LIMIT_BLOCK_SIZE);
+	state->calls[reason]++;
+	if (reason == SYN_PRESSURE_LIMIT && state->victim != nullptr) {
+		syn_free_in(arena, state->victim);
+		state->victim = nullptr;
+	}
+}
+
+
+/// An arena stops growing at its limit, and the pressure callback can make room for the allocation that hit it.
+void test_limit_pressure()
+{
+	const syn_arena_opts_t opts = {.first_pool_size = LIMIT_POOL_SIZE};
+	limit_state_t state = {.arena = syn_arena_create(&opts)};
+	assert(state.arena != nullptr);
+	syn_set_limit(state.arena, LIMIT_BYTES);
+	syn_set_pressure_callback(limit_callback, &state);
+
+	syn_handle_t hdls[LIMIT_MAX_BLOCKS];
+	int count = 0;
+	while (count < LIMIT_MAX_BLOCKS) {
+		hdls[count] = syn_alloc_in(state.arena, LIMIT_BLOCK_SIZE);
+		if (hdls[count].header == nullptr) {
+			break;
+		}
+		count++;
+	}
+	assert(count > 0 && count < LIMIT_MAX_BLOCKS);
+	assert(state.calls[SYN_PRESSURE_LIMIT] == 1);
+	assert((usize)count * LIMIT_BLOCK_SIZE <= LIMIT_BYTES);
+
+	// The callback frees a block that fits, so the allocation that hit the limit goes through.
+	state.victim = &hdls[0];
+	syn_handle_t fitted = syn_alloc_in(state.arena, LIMIT_BLOCK_SIZE);
+	assert(fitted.header != nullptr && state.victim == nullptr);
+	assert(state.calls[SYN_PRESSURE_LIMIT] == 2);
+	assert(syn_freeze_in(state.arena, &fitted) != nullptr);
+
+	// Without a limit the arena grows again, and the callback is not consulted.
+	syn_set_pressure_callback(nullptr, nullptr);
+	syn_set_limit(state.arena, 0);
+	syn_handle_t unlimited = syn_alloc_in(state.arena, LIMIT_BLOCK_SIZE);
+	assert(unlimited.header != nullptr);
+	assert(state.calls[SYN_PRESSURE_LIMIT] == 2 && state.calls[SYN_PRESSURE_OOM] == 0);
+
+	syn_arena_destroy(state.arena);
+	syn_destroy();
+}
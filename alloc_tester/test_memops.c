@@ -0,0 +1,111 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#include "sync_alloc.h"
+#include "syn_memops.h"
+#include "tests.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Room for the largest copy, every misalignment and a fence of untouched bytes on both ends.	*/
+static constexpr usize KERNEL_MAX_SIZE = 256 * 1024;
+static constexpr usize KERNEL_FENCE = 64;
+static constexpr usize KERNEL_OFFSETS[] = {0, 1, 7, 16, 33, 63};
+
+// Used when sysconf() does not know the LLC, the same fallback the kernels take.
+static constexpr usize STREAM_FALLBACK_LLC_SIZE = 8 * 1024 * 1024;
+
+
+static void check_fences(const u8 *buffer, const usize offset, const usize size)
+{
+	for (usize i = 0; i < KERNEL_FENCE + offset; i++) {
+		assert(buffer[i] == 0xEE);
+	}
+	for (usize i = KERNEL_FENCE + offset + size; i < (KERNEL_FENCE * 2) + offset + size; i++) {
+		assert(buffer[i] == 0xEE);
+	}
+}
+
+
+static void check_kernels_at(u8 *src, u8 *dest, const usize size)
+{
+	for (usize s = 0; s < sizeof(KERNEL_OFFSETS) / sizeof(KERNEL_OFFSETS[0]); s++) {
+		for (usize d = 0; d < sizeof(KERNEL_OFFSETS) / sizeof(KERNEL_OFFSETS[0]); d++) {
+			const usize src_offset = KERNEL_OFFSETS[s];
+			const usize dest_offset = KERNEL_OFFSETS[d];
+			u8 *from = src + KERNEL_FENCE + src_offset;
+			u8 *to = dest + KERNEL_FENCE + dest_offset;
+
+			memset(dest, 0xEE, (KERNEL_FENCE * 2) + dest_offset + size);
+			syn_memcpy(to, from, size);
+			assert(memcmp(to, from, size) == 0);
+			check_fences(dest, dest_offset, size);
+
+			syn_memset(to, 0x5A, size);
+			for (usize i = 0; i < size; i++) {
+				assert(to[i] == 0x5A);
+			}
+			check_fences(dest, dest_offset, size);
+		}
+	}
+}
+
+
+/// Whatever kernel the cpu gets, every size and misalignment must copy and fill exactly its bytes.
+void test_memops_kernels()
+{
+	u8 *src = malloc(KERNEL_MAX_SIZE + (KERNEL_FENCE * 3));
+	u8 *dest = malloc(KERNEL_MAX_SIZE + (KERNEL_FENCE * 3));
+	assert(src != nullptr && dest != nullptr);
+	for (usize i = 0; i < KERNEL_MAX_SIZE + (KERNEL_FENCE * 3); i++) {
+		src[i] = (u8)(i * 31 + 7);
+	}
+
+	// Every size up to a few vectors, then both sides of each power of two up to the rep thresholds and past them.
+	for (usize size = 1; size <= 300; size++) {
+		check_kernels_at(src, dest, size);
+	}
+	for (usize size = 512; size <= KERNEL_MAX_SIZE; size *= 2) {
+		check_kernels_at(src, dest, size - 1);
+		check_kernels_at(src, dest, size);
+		check_kernels_at(src, dest, size + 1);
+	}
+
+	free(src);
+	free(dest);
+}
+
+
+/// Copies and fills past the LLC threshold stream around the cache, and must still land exactly.
+void test_memops_stream()
+{
+	const long llc_size = sysconf(_SC_LEVEL3_CACHE_SIZE);
+	// Streaming starts at a quarter of the LLC, so half of it streams, and the odd tail takes the scalar end.
+	const usize size = ((llc_size > 0) ? (usize)llc_size : STREAM_FALLBACK_LLC_SIZE) / 2 + 13;
+
+	u8 *src = malloc(size + 1);
+	u8 *dest = malloc(size + 2);
+	assert(src != nullptr && dest != nullptr);
+	for (usize i = 0; i < size + 1; i++) {
+		src[i] = (u8)(i * 131 + 3);
+	}
+	dest[0] = 0xEE;
+	dest[size + 1] = 0xEE;
+
+	// Off by one on both sides, so the streamed body is not aligned to anything.
+	syn_memcpy(dest + 1, src + 1, size);
+	assert(memcmp(dest + 1, src + 1, size) == 0);
+	assert(dest[0] == 0xEE && dest[size + 1] == 0xEE);
+
+	syn_memset(dest + 1, 0, size);
+	for (usize i = 1; i <= size; i++) {
+		assert(dest[i] == 0);
+	}
+	assert(dest[0] == 0xEE && dest[size + 1] == 0xEE);
+
+	free(src);
+	free(dest);
+}
@@ -0,0 +1,69 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#include "sync_alloc.h"
+#include "tests.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Enough objects of this size to spill over several chunks.
+static constexpr usize OBJ_SIZE = 48;
+static constexpr usize OBJ_ALIGN = 64;
+static constexpr u32 OBJ_COUNT = 10000;
+
+
+/// Pool objects are aligned and kept apart, freed ones come back first, and their compact handles go stale.
+void test_objpool_lifecycle()
+{
+	syn_objpool_t *pool = syn_objpool_create(OBJ_SIZE, OBJ_ALIGN, SYN_OBJPOOL_HANDLES);
+	assert(pool != nullptr);
+	assert(syn_objpool_create(OBJ_SIZE, 24, SYN_OBJPOOL_DEFAULT) == nullptr);
+
+	u32 **objs = malloc(sizeof(u32 *) * OBJ_COUNT);
+	assert(objs != nullptr);
+	for (u32 i = 0; i < OBJ_COUNT; i++) {
+		objs[i] = syn_objpool_alloc(pool);
+		assert(objs[i] != nullptr && (uintptr_t)objs[i] % OBJ_ALIGN == 0);
+		objs[i][0] = i;
+		objs[i][(OBJ_SIZE / sizeof(u32)) - 1] = ~i;
+	}
+	for (u32 i = 0; i < OBJ_COUNT; i++) {
+		assert(objs[i][0] == i && objs[i][(OBJ_SIZE / sizeof(u32)) - 1] == ~i);
+	}
+	syn_objpool_stats_t stats = syn_objpool_stats(pool);
+	assert(stats.live == OBJ_COUNT && stats.capacity >= OBJ_COUNT && stats.chunk_count > 1);
+
+	const syn_ref_t ref = syn_objpool_ref(pool, objs[7]);
+	assert(ref != SYN_REF_INVALID && syn_objpool_deref(pool, ref) == objs[7]);
+
+	for (u32 i = 0; i < OBJ_COUNT; i += 2) {
+		syn_objpool_free(pool, objs[i]);
+	}
+	stats = syn_objpool_stats(pool);
+	assert(stats.live == OBJ_COUNT / 2);
+	assert(syn_objpool_ref(pool, objs[0]) == SYN_REF_INVALID);
+	assert(syn_objpool_deref(pool, ref) == objs[7]);
+
+	// A ref stays stale even once its slot is handed out again.
+	const syn_ref_t freed_ref = syn_objpool_ref(pool, objs[9]);
+	syn_objpool_free(pool, objs[9]);
+	assert(syn_objpool_deref(pool, freed_ref) == nullptr);
+
+	// Freed slots are reused before the pool maps anything new.
+	const usize capacity = stats.capacity;
+	for (u32 i = 0; i <= OBJ_COUNT / 2; i++) {
+		void *obj = syn_objpool_alloc(pool);
+		assert(obj != nullptr);
+		if (obj == objs[9]) {
+			assert(syn_objpool_deref(pool, freed_ref) == nullptr);
+		}
+	}
+	stats = syn_objpool_stats(pool);
+	assert(stats.live == OBJ_COUNT && stats.capacity == capacity);
+
+	free(objs);
+	syn_objpool_destroy(pool);
+	syn_destroy();
+}
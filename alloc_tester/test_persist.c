@@ -0,0 +1,131 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#include "sync_alloc.h"
+#include "tests.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static constexpr usize PERSIST_SIZE = 1024 * 1024;
+static constexpr char PERSIST_TEXT[] = "persisted across a reopen";
+static constexpr int SNAPSHOT_BLOCKS = 64;
+static constexpr char SHARED_TEXT[] = "written by the owner";
+
+
+/// A file-backed arena keeps its blocks and its root across a close and a reopen.
+void test_persist_reopen()
+{
+	char path[] = "/tmp/syn_persist_XXXXXX";
+	const int fd = mkstemp(path);
+	assert(fd >= 0);
+	close(fd);
+
+	syn_arena_t *arena = syn_arena_open(path, PERSIST_SIZE);
+	assert(arena != nullptr && syn_arena_root(arena) == SYN_REF_INVALID);
+	syn_handle_t hdl = syn_alloc_in(arena, sizeof(PERSIST_TEXT));
+	char *msg = syn_freeze_in(arena, &hdl);
+	assert(msg != nullptr);
+	memcpy(msg, PERSIST_TEXT, sizeof(PERSIST_TEXT));
+	hdl = syn_thaw_in(arena, msg);
+	const syn_ref_t ref = syn_ref_from_handle_in(arena, &hdl);
+	assert(ref != SYN_REF_INVALID);
+	syn_arena_set_root(arena, ref);
+	syn_arena_destroy(arena);
+
+	arena = syn_arena_open(path, 0);
+	assert(arena != nullptr && syn_arena_root(arena) == ref);
+	hdl = syn_handle_from_ref_in(arena, ref);
+	const char *reopened = syn_pin_in(arena, &hdl);
+	assert(reopened != nullptr && strcmp(reopened, PERSIST_TEXT) == 0);
+	syn_unpin_in(arena, &hdl);
+	syn_arena_destroy(arena);
+
+	unlink(path);
+}
+
+
+/// A restored snapshot resolves every compact handle saved before it, and leaves the original arena as it was.
+void test_snapshot_restore()
+{
+	syn_ref_t refs[SNAPSHOT_BLOCKS];
+	for (int i = 0; i < SNAPSHOT_BLOCKS; i++) {
+		refs[i] = syn_ref_alloc(32 + (i * 40));
+		char *msg = syn_ref_pin(refs[i]);
+		assert(msg != nullptr);
+		memset(msg, 'a' + (i % 26), 32 + (i * 40));
+		syn_ref_unpin(refs[i]);
+	}
+	// Freed before the snapshot, so it must be stale in the copy as well.
+	syn_ref_free(refs[0]);
+
+	FILE *file = tmpfile();
+	assert(file != nullptr);
+	assert(syn_arena_snapshot(nullptr, fileno(file)) == 0);
+	assert(lseek(fileno(file), 0, SEEK_SET) == 0);
+	syn_arena_t *restored = syn_arena_restore(fileno(file));
+	fclose(file);
+	assert(restored != nullptr);
+
+	syn_handle_t hdl = syn_handle_from_ref_in(restored, refs[0]);
+	assert(syn_pin_in(restored, &hdl) == nullptr);
+	for (int i = 1; i < SNAPSHOT_BLOCKS; i++) {
+		hdl = syn_handle_from_ref_in(restored, refs[i]);
+		const char *copy = syn_pin_in(restored, &hdl);
+		const char *original = syn_ref_pin(refs[i]);
+		assert(copy != nullptr && original != nullptr && copy != original);
+		assert(memcmp(copy, original, 32 + (i * 40)) == 0);
+		syn_unpin_in(restored, &hdl);
+		syn_ref_unpin(refs[i]);
+	}
+
+	syn_arena_destroy(restored);
+	syn_destroy();
+}
+
+
+/// Reads the owner's block through a view of its own, the way a second process would.
+static int shared_read_child(const int fd, const syn_ref_t ref)
+{
+	syn_shared_t *view = syn_shared_attach(fd);
+	if (view == nullptr) {
+		return 1;
+	}
+	const char *msg = syn_shared_freeze(view, ref);
+	const bool intact = msg != nullptr && strcmp(msg, SHARED_TEXT) == 0;
+	// A forged ref must be turned away instead of reaching outside the view.
+	const bool forged_rejected = syn_shared_freeze(view, ref ^ 0xFFFFF) == nullptr &&
+	                             syn_shared_freeze(view, SYN_REF_INVALID) == nullptr;
+	syn_shared_detach(view);
+	return (intact && forged_rejected) ? 0 : 1;
+}
+
+
+/// Another process that maps a shared arena reads the owner's blocks in place.
+void test_shared_view()
+{
+	syn_arena_t *arena = syn_arena_share(PERSIST_SIZE);
+	assert(arena != nullptr && syn_arena_fd(arena) >= 0);
+	syn_handle_t hdl = syn_alloc_in(arena, sizeof(SHARED_TEXT));
+	char *msg = syn_freeze_in(arena, &hdl);
+	assert(msg != nullptr);
+	memcpy(msg, SHARED_TEXT, sizeof(SHARED_TEXT));
+	hdl = syn_thaw_in(arena, msg);
+	const syn_ref_t ref = syn_ref_from_handle_in(arena, &hdl);
+	assert(ref != SYN_REF_INVALID);
+
+	const pid_t pid = fork();
+	assert(pid >= 0);
+	if (pid == 0) {
+		_exit(shared_read_child(syn_arena_fd(arena), ref));
+	}
+	int status = 0;
+	assert(waitpid(pid, &status, 0) == pid);
+	assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+	syn_arena_destroy(arena);
+}
@@ -0,0 +1,34 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#include "sync_alloc.h"
+#include "tests.h"
+#include <assert.h>
+#include <string.h>
+
+
+/// Freeing a pinned block is deferred to the last unpin, and the pins keep the payload readable until then.
+void test_pin_deferred_free()
+{
+	syn_handle_t owner = syn_alloc(64);
+	const syn_handle_t reader = owner;
+	char *pinned = syn_pin(&owner);
+	assert(pinned != nullptr);
+	memset(pinned, 'p', 64);
+
+	syn_free(&owner);
+	assert(owner.addr == nullptr);
+	assert(pinned[0] == 'p' && pinned[63] == 'p');
+
+	// The block is freed, so no new pin may be taken, but the held one is still released through any copy.
+	syn_handle_t copy = reader;
+	assert(syn_pin(&copy) == nullptr);
+	syn_unpin(&copy);
+	assert(syn_freeze(&copy) == nullptr);
+
+	syn_handle_t reused = syn_alloc(64);
+	assert(syn_freeze(&reused) == pinned);
+
+	syn_destroy();
+}
@@ -0,0 +1,70 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#include "sync_alloc.h"
+#include "tests.h"
+#include <assert.h>
+#include <string.h>
+
+constexpr int SECRET_BLOCKS = 32;
+constexpr usize SECRET_SIZE = 256;
+
+
+/// A freed sensitive block is held back until the quarantine is scrubbed, and comes back zeroed.
+void test_quarantine_scrub()
+{
+	// Sampled blocks skip the quarantine for their guard slots, so sampling is off for this one.
+	syn_set_sample_rate(0);
+
+	syn_handle_t secret_hdl = syn_alloc(SECRET_SIZE);
+	assert(syn_mark_sensitive(&secret_hdl) == 0);
+	char *secret = syn_freeze(&secret_hdl);
+	memset(secret, 'Q', SECRET_SIZE);
+	secret_hdl = syn_thaw(secret);
+	syn_free(&secret_hdl);
+
+	// Still quarantined, so a block of the same size has to come from elsewhere.
+	syn_handle_t other = syn_alloc(SECRET_SIZE);
+	assert(syn_freeze(&other) != secret);
+
+	syn_scrub_quarantine();
+	for (usize i = 0; i < SECRET_SIZE; i++) {
+		assert(secret[i] == 0);
+	}
+	syn_handle_t reused = syn_alloc(SECRET_SIZE);
+	assert(syn_freeze(&reused) == secret);
+
+	syn_set_sample_rate(4096);
+	syn_destroy();
+}
+
+
+/// Sensitive blocks, freed or still live, must not reach the next arena through the region cache.
+void test_destroy_sensitive()
+{
+	syn_handle_t secrets[SECRET_BLOCKS];
+	for (int i = 0; i < SECRET_BLOCKS; i++) {
+		secrets[i] = syn_alloc(SECRET_SIZE);
+		assert(syn_mark_sensitive(&secrets[i]) == 0);
+		char *secret = syn_freeze(&secrets[i]);
+		memset(secret, 'S', SECRET_SIZE);
+		secrets[i] = syn_thaw(secret);
+	}
+	// Half of them sit in the quarantine at destroy time, the other half are still allocated.
+	for (int i = 0; i < SECRET_BLOCKS; i += 2) {
+		syn_free(&secrets[i]);
+	}
+	syn_destroy();
+
+	// The new arena gets the cached region back, and the same bump offsets with it.
+	for (int i = 0; i < SECRET_BLOCKS; i++) {
+		syn_handle_t reused = syn_alloc(SECRET_SIZE);
+		const char *block = syn_freeze(&reused);
+		assert(block != nullptr);
+		for (usize j = 0; j < SECRET_SIZE; j++) {
+			assert(block[j] != 'S');
+		}
+	}
+	syn_destroy();
+}
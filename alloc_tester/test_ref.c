@@ -0,0 +1,53 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#include "sync_alloc.h"
+#include "tests.h"
+#include <assert.h>
+#include <string.h>
+
+static_assert(sizeof(syn_ref_t) == 8, "a compact handle has to fit in a register");
+
+
+/// Compact handles go stale exactly when full handles would, and convert to and from them losslessly.
+void test_ref_lifecycle()
+{
+	const syn_ref_t ref = syn_ref_alloc(64);
+	assert(ref != SYN_REF_INVALID);
+	char *msg = syn_ref_pin(ref);
+	assert(msg != nullptr);
+	memset(msg, 'r', 64);
+	syn_ref_unpin(ref);
+
+	syn_handle_t hdl = syn_handle_from_ref(ref);
+	assert(syn_ref_from_handle(&hdl) == ref);
+
+	// A realloc hands out a new ref, and the old one is stale from then on.
+	const syn_ref_t grown = syn_ref_realloc(ref, 4096);
+	assert(grown != SYN_REF_INVALID && grown != ref);
+	assert(syn_ref_pin(ref) == nullptr);
+	hdl = syn_handle_from_ref(ref);
+	assert(syn_freeze(&hdl) == nullptr);
+
+	// Frozen, the ref is stale until the block is thawed into a new one.
+	msg = syn_ref_freeze(grown);
+	assert(msg != nullptr && msg[0] == 'r' && msg[63] == 'r');
+	assert(syn_ref_pin(grown) == nullptr);
+	const syn_ref_t thawed = syn_ref_thaw(msg);
+	assert(thawed != SYN_REF_INVALID && syn_ref_pin(thawed) == msg);
+	syn_ref_unpin(thawed);
+
+	syn_ref_free(thawed);
+	assert(syn_ref_pin(thawed) == nullptr);
+
+	const syn_ref_t zeroed = syn_ref_calloc(128);
+	const char *zeroed_msg = syn_ref_pin(zeroed);
+	assert(zeroed_msg != nullptr);
+	for (usize i = 0; i < 128; i++) {
+		assert(zeroed_msg[i] == 0);
+	}
+	syn_ref_unpin(zeroed);
+
+	syn_destroy();
+}
@@ -0,0 +1,70 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#include "sync_alloc.h"
+#include "tests.h"
+#include <assert.h>
+#include <string.h>
+
+
+/// A block from before a scope must survive the pop, even if it was reallocated inside it.
+void test_scope_realloc()
+{
+	syn_handle_t outer = syn_alloc(64);
+	char *msg = syn_freeze(&outer);
+	memset(msg, 'o', 64);
+	outer = syn_thaw(msg);
+
+	const syn_scope_t mark = syn_scope_push();
+	assert(syn_realloc(&outer, 4096) != 0);
+
+	syn_handle_t inner = syn_alloc(64);
+	assert(syn_realloc(&inner, 4096) == 0);
+	syn_scope_pop(mark);
+
+	// The rewound memory is handed out again, it must not be where outer points.
+	syn_handle_t fresh = syn_alloc(4096);
+	memset(syn_freeze(&fresh), 'f', 4096);
+
+	msg = syn_freeze(&outer);
+	assert(msg != nullptr && msg[0] == 'o' && msg[63] == 'o');
+	outer = syn_thaw(msg);
+	assert(syn_realloc(&outer, 4096) == 0);
+	msg = syn_freeze(&outer);
+	assert(msg[0] == 'o' && msg[63] == 'o');
+
+	syn_destroy();
+}
+
+
+/// Handles made inside a scope go stale at the pop, and stay stale once their entries are reused.
+void test_scope_stale_handle()
+{
+	syn_handle_t outer = syn_alloc(32);
+
+	syn_scope_t mark = syn_scope_push();
+	syn_handle_t scoped = syn_alloc(32);
+	syn_handle_t frozen = syn_alloc(32);
+	assert(syn_freeze(&frozen) != nullptr);
+	syn_scope_pop(mark);
+
+	assert(syn_freeze(&scoped) == nullptr);
+	assert(syn_freeze(&frozen) == nullptr);
+
+	// The next scope bumps the same entries out of the table again.
+	mark = syn_scope_push();
+	syn_handle_t reused[4];
+	for (int i = 0; i < 4; i++) {
+		reused[i] = syn_alloc(32);
+	}
+	assert(syn_freeze(&scoped) == nullptr);
+	assert(syn_freeze(&frozen) == nullptr);
+	for (int i = 0; i < 4; i++) {
+		assert(syn_freeze(&reused[i]) != nullptr);
+	}
+	syn_scope_pop(mark);
+
+	assert(syn_freeze(&outer) != nullptr);
+	syn_destroy();
+}
@@ -0,0 +1,35 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#include "sync_alloc.h"
+#include "tests.h"
+#include <assert.h>
+
+// Enough 64 byte blocks to fill a couple of slabs, the full ones sit on no partial list.
+constexpr int SLAB_FILL_BLOCKS = 2048;
+
+
+/// Destroying an arena must give back its full slabs too, the next arena claims the same chunk zeroed.
+void test_slab_release_full()
+{
+	const syn_arena_opts_t opts = {.meta_layout = SYN_META_OUT_OF_LINE};
+	syn_arena_t *arena = syn_arena_create(&opts);
+	assert(arena != nullptr);
+
+	syn_handle_t first = syn_alloc_in(arena, 64);
+	char *first_block = syn_freeze_in(arena, &first);
+	first_block[0] = 'x';
+	for (int i = 1; i < SLAB_FILL_BLOCKS; i++) {
+		syn_handle_t hdl = syn_alloc_in(arena, 64);
+		assert(hdl.header != nullptr);
+	}
+	syn_arena_destroy(arena);
+
+	arena = syn_arena_create(&opts);
+	assert(arena != nullptr);
+	syn_handle_t reused = syn_alloc_in(arena, 64);
+	const char *reused_block = syn_freeze_in(arena, &reused);
+	assert(reused_block == first_block && reused_block[0] == 0);
+	syn_arena_destroy(arena);
+}
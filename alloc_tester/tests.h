@@ -0,0 +1,43 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#ifndef ARENA_ALLOCATOR_TESTS_H
+#define ARENA_ALLOCATOR_TESTS_H
+
+/* Behaviour tests, one function per feature, run one after the other by main().		*
+ * tester builds the handle API, tester_raw the raw API of the preload library, and each	*
+ * test checks with assert() and leaves no arena behind, so the next one starts clean.	*/
+
+#ifndef SYN_USE_RAW
+extern void test_scope_realloc();
+extern void test_scope_stale_handle();
+extern void test_arena_isolation();
+extern void test_aligned_gap_reuse();
+extern void test_aligned_realloc();
+extern void test_memops_kernels();
+extern void test_memops_stream();
+extern void test_calloc_reuse();
+extern void test_quarantine_scrub();
+extern void test_guard_sampled();
+extern void test_ref_lifecycle();
+extern void test_destroy_sensitive();
+extern void test_config_override();
+extern void test_persist_reopen();
+extern void test_snapshot_restore();
+extern void test_shared_view();
+extern void test_objpool_lifecycle();
+extern void test_huge_remap();
+extern void test_growbuf_in_place();
+extern void test_limit_pressure();
+extern void test_handle_table_growth();
+extern void test_slab_release_full();
+extern void test_pin_deferred_free();
+#else
+extern void test_raw_scope_realloc();
+extern void test_raw_thread_exit();
+extern void test_raw_remote_double_free();
+extern void test_raw_shim();
+#endif
+
+#endif //ARENA_ALLOCATOR_TESTS_H
@@ -13,4 +13,7 @@ extern int syn_memcpy(void *restrict destination, const void *restrict source, u
 [[gnu::hot]]
 extern int syn_memset(void *restrict target, u8 byte, usize bytes);
 
+/// syn_memset() that the compiler can never drop as a dead store, for scrubbing secrets.
+extern int syn_memset_explicit(void *restrict target, u8 byte, usize bytes);
+
 #endif //ARENA_ALLOCATOR_SYN_MEMOPS_H
\ No newline at end of file
@@ -8,34 +8,123 @@
 #include "syn_memops.h"
 #include "defs.h"
 #include "types.h"
+#include <cpuid.h>
 #include <emmintrin.h>
 #include <immintrin.h>
+#include <stdatomic.h>
 #include <stdint.h>
 
 
 enum Simd_Width {
 	WIDTH_STD = 8,
 	WIDTH_SSE = 16,
-	WIDTH_AVX = 32
+	WIDTH_AVX = 32,
+	WIDTH_AVX512 = 64,
 };
 
 enum Simd_Flags {
 	SIMD_NONE = 0,
 	SIMD_SSE = 1 << 0,
 	SIMD_AVX = 1 << 1,
+	SIMD_AVX512 = 1 << 2,
+	SIMD_ERMS = 1 << 3, /**< Enhanced rep movsb/stosb.			*/
+	SIMD_FSRM = 1 << 4, /**< Fast short rep movsb, cheap rep startup.	*/
 };
 
-//#define __AVX2__
-static constexpr int simd_capability =
-	#if defined(__AVX2__) && defined(__SSE__)
-	SIMD_AVX | SIMD_SSE;
-	#elif defined(__AVX2__) && !defined(__SSE__)
-	SIMD_AVX;
-	#elif defined(__SSE__) && !defined(__AVX2__)
-	SIMD_SSE;
-	#else
-	SIMD_NONE;
-	#endif
+/* Sizes where rep movsb/stosb start beating the widest vector loop. Measured with every	*
+ * kernel forced on an AVX-512 Xeon with ERMS and FSRM, destination misaligned: rep wins	*
+ * over SSE from ~1 KiB and over AVX2 from ~2 KiB, but 64-byte stores keep up with it	*
+ * until the copy falls out of L2. Without FSRM the rep startup cost doubles these.	*/
+static constexpr usize REP_THRESHOLD_SSE = 1024;
+static constexpr usize REP_THRESHOLD_AVX = 2048;
+static constexpr usize REP_THRESHOLD_AVX512 = 65536;
+
+/* Past a quarter of the last-level cache, fills and copies switch to non-temporal stores,	*
+ * so a multi-MiB calloc or realloc does not push the hot working set out of the cache.	*
+ * The LLC size comes from cpuid; the fallback assumes a small 8 MiB desktop part.	*/
+static constexpr usize NT_THRESHOLD_LLC_SHARE = 4;
+static constexpr usize NT_THRESHOLD_MIN = 1024 * 1024;
+static constexpr usize NT_FALLBACK_LLC_SIZE = 8 * 1024 * 1024;
+
+typedef void (*memcpy_kernel_t)(u8 *restrict dest, const u8 *restrict src, usize size);
+typedef void (*memset_kernel_t)(u8 *restrict target, u8 byte, usize size);
+
+static void syn_memcpy_resolve(u8 *restrict dest, const u8 *restrict src, usize size);
+static void syn_memset_resolve(u8 *restrict target, u8 byte, usize size);
+
+/* Kernels are picked on the first call from cpuid, not at compile time, so a generic	*
+ * x86-64 build still gets AVX2/AVX-512 and an AVX2 build still runs on older hosts.	*
+ * Racing first calls all resolve to the same kernel, so relaxed stores are enough.	*/
+static _Atomic(memcpy_kernel_t) memcpy_kernel = syn_memcpy_resolve;
+static _Atomic(memset_kernel_t) memset_kernel = syn_memset_resolve;
+static _Atomic usize rep_threshold = SIZE_MAX;
+static _Atomic usize nt_threshold = SIZE_MAX;
+
+
+[[gnu::cold]]
+static int detect_simd_capability()
+{
+	int capability = SIMD_SSE; // SSE2 is part of x86-64
+
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		capability |= SIMD_AVX;
+	}
+	if (__builtin_cpu_supports("avx512f")) {
+		capability |= SIMD_AVX512;
+	}
+
+	u32 eax = 0;
+	u32 ebx = 0;
+	u32 ecx = 0;
+	u32 edx = 0;
+	if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+		capability |= (ebx & (1U << 9)) ? SIMD_ERMS : 0;
+		capability |= (edx & (1U << 4)) ? SIMD_FSRM : 0;
+	}
+	return capability;
+}
+
+
+/// Walks the deterministic cache parameter leaf (4 on Intel, 0x8000001D on AMD) and
+/// returns the size of the highest level data or unified cache, or 0 if neither exists.
+[[gnu::cold]]
+static usize detect_llc_size()
+{
+	u32 eax = 0;
+	u32 ebx = 0;
+	u32 ecx = 0;
+	u32 edx = 0;
+
+	u32 leaf = 4;
+	if (!__get_cpuid_count(leaf, 0, &eax, &ebx, &ecx, &edx) || (eax & 0x1F) == 0) {
+		leaf = 0x8000001D;
+	}
+
+	usize llc_size = 0;
+	u32 llc_level = 0;
+	for (u32 subleaf = 0; subleaf < 16; subleaf++) {
+		if (!__get_cpuid_count(leaf, subleaf, &eax, &ebx, &ecx, &edx)) {
+			break;
+		}
+		const u32 type = eax & 0x1F;
+		const u32 level = (eax >> 5) & 0x7;
+		if (type == 0) {
+			break;
+		}
+		if (type == 2 || level < llc_level) {
+			continue; // instruction caches and levels below the current llc
+		}
+		const usize ways = ((ebx >> 22) & 0x3FF) + 1;
+		const usize partitions = ((ebx >> 12) & 0x3FF) + 1;
+		const usize line_size = (ebx & 0xFFF) + 1;
+		const usize sets = (usize)ecx + 1;
+
+		llc_size = ways * partitions * line_size * sets;
+		llc_level = level;
+	}
+	return llc_size;
+}
 
 
 [[gnu::hot]]
@@ -47,51 +136,330 @@ static inline void syn_memcpy_scalarcpy(u8 *restrict dest, const u8 *restrict sr
 }
 
 
-[[maybe_unused, gnu::hot]]
-static inline void syn_memcpy_ssecpy(u8 *restrict dest, const u8 *restrict src, const usize size)
+/// Copies less than 16 bytes with two overlapping moves of the largest size that fits.
+[[gnu::hot]]
+static inline void syn_memcpy_smallcpy(u8 *restrict dest, const u8 *restrict src, const usize size)
 {
-	#ifdef __SSE__
-	if (((uintptr_t)src & WIDTH_SSE) == 0 && ((uintptr_t)dest & WIDTH_SSE) == 0) {
-		for (usize i = 0; i + WIDTH_SSE <= size; i += WIDTH_SSE) {
-			const __m128i ssereg = _mm_load_si128((const __m128i *)(src + i));
-			_mm_store_si128((__m128i *)(dest + i), ssereg);
-		}
-	} else {
-		for (usize i = 0; i + WIDTH_SSE <= size; i += WIDTH_SSE) {
-			const __m128i ssereg = _mm_loadu_si128((const __m128i *)(src + i));
-			_mm_storeu_si128((__m128i *)(dest + i), ssereg);
-		}
+	if (size >= WIDTH_STD) {
+		u64 head = 0;
+		u64 tail = 0;
+		__builtin_memcpy(&head, src, sizeof(u64));
+		__builtin_memcpy(&tail, src + size - sizeof(u64), sizeof(u64));
+		__builtin_memcpy(dest, &head, sizeof(u64));
+		__builtin_memcpy(dest + size - sizeof(u64), &tail, sizeof(u64));
+		return;
+	}
+	if (size >= sizeof(u32)) {
+		u32 head = 0;
+		u32 tail = 0;
+		__builtin_memcpy(&head, src, sizeof(u32));
+		__builtin_memcpy(&tail, src + size - sizeof(u32), sizeof(u32));
+		__builtin_memcpy(dest, &head, sizeof(u32));
+		__builtin_memcpy(dest + size - sizeof(u32), &tail, sizeof(u32));
+		return;
 	}
-	#else
 	syn_memcpy_scalarcpy(dest, src, size);
-	#endif
 }
 
 
-[[maybe_unused, gnu::hot]]
-static inline void syn_memcpy_avxcpy(u8 *restrict dest, const u8 *restrict src, const usize size)
+[[gnu::hot]]
+static inline void syn_memcpy_ermscpy(u8 *restrict dest, const u8 *restrict src, usize size)
 {
-	#ifdef __AVX2__
-	if (((uintptr_t)src & WIDTH_AVX) == 0 && ((uintptr_t)dest & WIDTH_AVX) == 0) {
-		for (usize i = 0; i + WIDTH_AVX <= size; i += WIDTH_AVX) {
-			const __m256i avxreg = _mm256_load_si256((const __m256i *)(src + i));
-			_mm256_store_si256((__m256i *)(dest + i), avxreg);
-		}
-	} else {
-		for (usize i = 0; i + WIDTH_AVX <= size; i += WIDTH_AVX) {
-			const __m256i avxreg = _mm256_loadu_si256((const __m256i *)(src + i));
-			_mm256_storeu_si256((__m256i *)(dest + i), avxreg);
-		}
+	__asm__ volatile("rep movsb" : "+D"(dest), "+S"(src), "+c"(size) : : "memory");
+}
+
+
+/* Every vector kernel works the same way for size >= its width: an unaligned store	*
+ * for the head, aligned stores from the first aligned destination address, and one	*
+ * unaligned store that ends exactly at dest + size for the tail. Head and tail overlap	*
+ * the body instead of falling back to scalar loops.					*/
+
+[[gnu::hot]]
+static void syn_memcpy_ssecpy(u8 *restrict dest, const u8 *restrict src, const usize size)
+{
+	const __m128i head = _mm_loadu_si128((const __m128i *)src);
+	const __m128i tail = _mm_loadu_si128((const __m128i *)(src + size - WIDTH_SSE));
+
+	_mm_storeu_si128((__m128i *)dest, head);
+	usize i = WIDTH_SSE - ((uintptr_t)dest & (WIDTH_SSE - 1));
+
+	for (; i + (WIDTH_SSE * 4) <= size; i += WIDTH_SSE * 4) {
+		const __m128i a = _mm_loadu_si128((const __m128i *)(src + i));
+		const __m128i b = _mm_loadu_si128((const __m128i *)(src + i + WIDTH_SSE));
+		const __m128i c = _mm_loadu_si128((const __m128i *)(src + i + (WIDTH_SSE * 2)));
+		const __m128i d = _mm_loadu_si128((const __m128i *)(src + i + (WIDTH_SSE * 3)));
+		_mm_store_si128((__m128i *)(dest + i), a);
+		_mm_store_si128((__m128i *)(dest + i + WIDTH_SSE), b);
+		_mm_store_si128((__m128i *)(dest + i + (WIDTH_SSE * 2)), c);
+		_mm_store_si128((__m128i *)(dest + i + (WIDTH_SSE * 3)), d);
 	}
+	for (; i + WIDTH_SSE <= size; i += WIDTH_SSE) {
+		_mm_store_si128((__m128i *)(dest + i), _mm_loadu_si128((const __m128i *)(src + i)));
+	}
+
+	_mm_storeu_si128((__m128i *)(dest + size - WIDTH_SSE), tail);
+}
+
+
+[[gnu::hot, gnu::target("avx2")]]
+static void syn_memcpy_avxcpy(u8 *restrict dest, const u8 *restrict src, const usize size)
+{
+	const __m256i head = _mm256_loadu_si256((const __m256i *)src);
+	const __m256i tail = _mm256_loadu_si256((const __m256i *)(src + size - WIDTH_AVX));
+
+	_mm256_storeu_si256((__m256i *)dest, head);
+	usize i = WIDTH_AVX - ((uintptr_t)dest & (WIDTH_AVX - 1));
+
+	for (; i + (WIDTH_AVX * 4) <= size; i += WIDTH_AVX * 4) {
+		const __m256i a = _mm256_loadu_si256((const __m256i *)(src + i));
+		const __m256i b = _mm256_loadu_si256((const __m256i *)(src + i + WIDTH_AVX));
+		const __m256i c = _mm256_loadu_si256((const __m256i *)(src + i + (WIDTH_AVX * 2)));
+		const __m256i d = _mm256_loadu_si256((const __m256i *)(src + i + (WIDTH_AVX * 3)));
+		_mm256_store_si256((__m256i *)(dest + i), a);
+		_mm256_store_si256((__m256i *)(dest + i + WIDTH_AVX), b);
+		_mm256_store_si256((__m256i *)(dest + i + (WIDTH_AVX * 2)), c);
+		_mm256_store_si256((__m256i *)(dest + i + (WIDTH_AVX * 3)), d);
+	}
+	for (; i + WIDTH_AVX <= size; i += WIDTH_AVX) {
+		_mm256_store_si256((__m256i *)(dest + i),
+		                   _mm256_loadu_si256((const __m256i *)(src + i)));
+	}
+
+	_mm256_storeu_si256((__m256i *)(dest + size - WIDTH_AVX), tail);
 	/* We have to zero the upper bits of the AVX regs to eliminate the 100-500 cpu cycle	*
 	 * transition state cost that occurs when transitioning from AVX to SSE. This only	*
 	 * takes about 1-10 cycles, so it is very much worth it.				*/
 	_mm256_zeroupper();
-	#elifdef __SSE__
+}
+
+
+[[gnu::hot, gnu::target("avx512f")]]
+static void syn_memcpy_avx512cpy(u8 *restrict dest, const u8 *restrict src, const usize size)
+{
+	const __m512i head = _mm512_loadu_si512((const void *)src);
+	const __m512i tail = _mm512_loadu_si512((const void *)(src + size - WIDTH_AVX512));
+
+	_mm512_storeu_si512((void *)dest, head);
+	usize i = WIDTH_AVX512 - ((uintptr_t)dest & (WIDTH_AVX512 - 1));
+
+	for (; i + (WIDTH_AVX512 * 4) <= size; i += WIDTH_AVX512 * 4) {
+		const __m512i a = _mm512_loadu_si512((const void *)(src + i));
+		const __m512i b = _mm512_loadu_si512((const void *)(src + i + WIDTH_AVX512));
+		const __m512i c = _mm512_loadu_si512((const void *)(src + i + (WIDTH_AVX512 * 2)));
+		const __m512i d = _mm512_loadu_si512((const void *)(src + i + (WIDTH_AVX512 * 3)));
+		_mm512_store_si512((void *)(dest + i), a);
+		_mm512_store_si512((void *)(dest + i + WIDTH_AVX512), b);
+		_mm512_store_si512((void *)(dest + i + (WIDTH_AVX512 * 2)), c);
+		_mm512_store_si512((void *)(dest + i + (WIDTH_AVX512 * 3)), d);
+	}
+	for (; i + WIDTH_AVX512 <= size; i += WIDTH_AVX512) {
+		_mm512_store_si512((void *)(dest + i), _mm512_loadu_si512((const void *)(src + i)));
+	}
+
+	_mm512_storeu_si512((void *)(dest + size - WIDTH_AVX512), tail);
+	_mm256_zeroupper();
+}
+
+
+/* Non-temporal variants of the above. Stream stores need an aligned destination, so	*
+ * the head and tail stay regular stores and the sfence orders the streamed body	*
+ * before anything the caller writes next.						*/
+
+[[gnu::hot]]
+static void syn_memcpy_ssestream(u8 *restrict dest, const u8 *restrict src, const usize size)
+{
+	const __m128i head = _mm_loadu_si128((const __m128i *)src);
+	const __m128i tail = _mm_loadu_si128((const __m128i *)(src + size - WIDTH_SSE));
+
+	_mm_storeu_si128((__m128i *)dest, head);
+	usize i = WIDTH_SSE - ((uintptr_t)dest & (WIDTH_SSE - 1));
+
+	for (; i + (WIDTH_SSE * 4) <= size; i += WIDTH_SSE * 4) {
+		const __m128i a = _mm_loadu_si128((const __m128i *)(src + i));
+		const __m128i b = _mm_loadu_si128((const __m128i *)(src + i + WIDTH_SSE));
+		const __m128i c = _mm_loadu_si128((const __m128i *)(src + i + (WIDTH_SSE * 2)));
+		const __m128i d = _mm_loadu_si128((const __m128i *)(src + i + (WIDTH_SSE * 3)));
+		_mm_stream_si128((__m128i *)(dest + i), a);
+		_mm_stream_si128((__m128i *)(dest + i + WIDTH_SSE), b);
+		_mm_stream_si128((__m128i *)(dest + i + (WIDTH_SSE * 2)), c);
+		_mm_stream_si128((__m128i *)(dest + i + (WIDTH_SSE * 3)), d);
+	}
+	for (; i + WIDTH_SSE <= size; i += WIDTH_SSE) {
+		_mm_stream_si128((__m128i *)(dest + i), _mm_loadu_si128((const __m128i *)(src + i)));
+	}
+	_mm_sfence();
+
+	_mm_storeu_si128((__m128i *)(dest + size - WIDTH_SSE), tail);
+}
+
+
+[[gnu::hot, gnu::target("avx2")]]
+static void syn_memcpy_avxstream(u8 *restrict dest, const u8 *restrict src, const usize size)
+{
+	const __m256i head = _mm256_loadu_si256((const __m256i *)src);
+	const __m256i tail = _mm256_loadu_si256((const __m256i *)(src + size - WIDTH_AVX));
+
+	_mm256_storeu_si256((__m256i *)dest, head);
+	usize i = WIDTH_AVX - ((uintptr_t)dest & (WIDTH_AVX - 1));
+
+	for (; i + (WIDTH_AVX * 4) <= size; i += WIDTH_AVX * 4) {
+		const __m256i a = _mm256_loadu_si256((const __m256i *)(src + i));
+		const __m256i b = _mm256_loadu_si256((const __m256i *)(src + i + WIDTH_AVX));
+		const __m256i c = _mm256_loadu_si256((const __m256i *)(src + i + (WIDTH_AVX * 2)));
+		const __m256i d = _mm256_loadu_si256((const __m256i *)(src + i + (WIDTH_AVX * 3)));
+		_mm256_stream_si256((__m256i *)(dest + i), a);
+		_mm256_stream_si256((__m256i *)(dest + i + WIDTH_AVX), b);
+		_mm256_stream_si256((__m256i *)(dest + i + (WIDTH_AVX * 2)), c);
+		_mm256_stream_si256((__m256i *)(dest + i + (WIDTH_AVX * 3)), d);
+	}
+	for (; i + WIDTH_AVX <= size; i += WIDTH_AVX) {
+		_mm256_stream_si256((__m256i *)(dest + i),
+		                    _mm256_loadu_si256((const __m256i *)(src + i)));
+	}
+	_mm_sfence();
+
+	_mm256_storeu_si256((__m256i *)(dest + size - WIDTH_AVX), tail);
+	_mm256_zeroupper();
+}
+
+
+[[gnu::hot, gnu::target("avx512f")]]
+static void syn_memcpy_avx512stream(u8 *restrict dest, const u8 *restrict src, const usize size)
+{
+	const __m512i head = _mm512_loadu_si512((const void *)src);
+	const __m512i tail = _mm512_loadu_si512((const void *)(src + size - WIDTH_AVX512));
+
+	_mm512_storeu_si512((void *)dest, head);
+	usize i = WIDTH_AVX512 - ((uintptr_t)dest & (WIDTH_AVX512 - 1));
+
+	for (; i + (WIDTH_AVX512 * 4) <= size; i += WIDTH_AVX512 * 4) {
+		const __m512i a = _mm512_loadu_si512((const void *)(src + i));
+		const __m512i b = _mm512_loadu_si512((const void *)(src + i + WIDTH_AVX512));
+		const __m512i c = _mm512_loadu_si512((const void *)(src + i + (WIDTH_AVX512 * 2)));
+		const __m512i d = _mm512_loadu_si512((const void *)(src + i + (WIDTH_AVX512 * 3)));
+		_mm512_stream_si512((void *)(dest + i), a);
+		_mm512_stream_si512((void *)(dest + i + WIDTH_AVX512), b);
+		_mm512_stream_si512((void *)(dest + i + (WIDTH_AVX512 * 2)), c);
+		_mm512_stream_si512((void *)(dest + i + (WIDTH_AVX512 * 3)), d);
+	}
+	for (; i + WIDTH_AVX512 <= size; i += WIDTH_AVX512) {
+		_mm512_stream_si512((void *)(dest + i), _mm512_loadu_si512((const void *)(src + i)));
+	}
+	_mm_sfence();
+
+	_mm512_storeu_si512((void *)(dest + size - WIDTH_AVX512), tail);
+	_mm256_zeroupper();
+}
+
+
+/* The dispatched kernels. Each one only takes sizes >= WIDTH_SSE, streams past the LLC	*
+ * threshold, and otherwise picks the widest vector loop the size can use, or rep movsb	*
+ * once the size passes the ERMS threshold.						*/
+
+[[gnu::hot]]
+static void syn_memcpy_sse_kernel(u8 *restrict dest, const u8 *restrict src, const usize size)
+{
+	if (size >= atomic_load_explicit(&nt_threshold, memory_order_relaxed)) {
+		syn_memcpy_ssestream(dest, src, size);
+		return;
+	}
+	if (size >= atomic_load_explicit(&rep_threshold, memory_order_relaxed)) {
+		syn_memcpy_ermscpy(dest, src, size);
+		return;
+	}
 	syn_memcpy_ssecpy(dest, src, size);
-	#else
-	syn_memcpy_scalarcpy(dest, src, size);
-	#endif
+}
+
+
+[[gnu::hot]]
+static void syn_memcpy_avx_kernel(u8 *restrict dest, const u8 *restrict src, const usize size)
+{
+	if (size >= atomic_load_explicit(&nt_threshold, memory_order_relaxed)) {
+		syn_memcpy_avxstream(dest, src, size);
+		return;
+	}
+	if (size >= atomic_load_explicit(&rep_threshold, memory_order_relaxed)) {
+		syn_memcpy_ermscpy(dest, src, size);
+		return;
+	}
+	if (size >= WIDTH_AVX) {
+		syn_memcpy_avxcpy(dest, src, size);
+		return;
+	}
+	syn_memcpy_ssecpy(dest, src, size);
+}
+
+
+[[gnu::hot]]
+static void syn_memcpy_avx512_kernel(u8 *restrict dest, const u8 *restrict src, const usize size)
+{
+	if (size >= atomic_load_explicit(&nt_threshold, memory_order_relaxed)) {
+		syn_memcpy_avx512stream(dest, src, size);
+		return;
+	}
+	if (size >= atomic_load_explicit(&rep_threshold, memory_order_relaxed)) {
+		syn_memcpy_ermscpy(dest, src, size);
+		return;
+	}
+	if (size >= WIDTH_AVX512) {
+		syn_memcpy_avx512cpy(dest, src, size);
+		return;
+	}
+	if (size >= WIDTH_AVX) {
+		syn_memcpy_avxcpy(dest, src, size);
+		return;
+	}
+	syn_memcpy_ssecpy(dest, src, size);
+}
+
+
+[[gnu::cold]]
+static usize pick_rep_threshold(const int capability)
+{
+	if (!(capability & SIMD_ERMS)) {
+		return SIZE_MAX;
+	}
+	const usize threshold = (capability & SIMD_AVX512) ? REP_THRESHOLD_AVX512
+	                        : (capability & SIMD_AVX)  ? REP_THRESHOLD_AVX
+	                                                   : REP_THRESHOLD_SSE;
+	return (capability & SIMD_FSRM) ? threshold : threshold * 2;
+}
+
+
+/// Detects the cpu once per resolver and publishes the size thresholds both kernels share.
+[[gnu::cold]]
+static int resolve_thresholds()
+{
+	const int capability = detect_simd_capability();
+
+	usize llc_size = detect_llc_size();
+	if (llc_size == 0) {
+		llc_size = NT_FALLBACK_LLC_SIZE;
+	}
+	usize streaming = llc_size / NT_THRESHOLD_LLC_SHARE;
+	if (streaming < NT_THRESHOLD_MIN) {
+		streaming = NT_THRESHOLD_MIN;
+	}
+
+	atomic_store_explicit(&rep_threshold, pick_rep_threshold(capability), memory_order_relaxed);
+	atomic_store_explicit(&nt_threshold, streaming, memory_order_relaxed);
+	return capability;
+}
+
+
+[[gnu::cold]]
+static void syn_memcpy_resolve(u8 *restrict dest, const u8 *restrict src, const usize size)
+{
+	const int capability = resolve_thresholds();
+
+	memcpy_kernel_t kernel = syn_memcpy_sse_kernel;
+	if (capability & SIMD_AVX512) {
+		kernel = syn_memcpy_avx512_kernel;
+	} else if (capability & SIMD_AVX) {
+		kernel = syn_memcpy_avx_kernel;
+	}
+	atomic_store_explicit(&memcpy_kernel, kernel, memory_order_relaxed);
+	kernel(dest, src, size);
 }
 
 
@@ -105,70 +473,12 @@ int syn_memcpy(void *restrict destination, const void *restrict source, const us
 	u8 *dest = destination;
 	const u8 *src = source;
 
-	if (size < ALIGNMENT || simd_capability & SIMD_NONE) {
-		syn_memcpy_scalarcpy(dest, src, size);
+	if (size < WIDTH_SSE) {
+		syn_memcpy_smallcpy(dest, src, size);
 		return 0;
 	}
 
-	const uintptr_t dest_addr = (uintptr_t)dest;
-	constexpr u8 simd_width = (simd_capability & SIMD_AVX)
-	                                  ? WIDTH_AVX
-	                                  : ((simd_capability & SIMD_SSE) ? WIDTH_SSE : WIDTH_STD);
-
-	const uintptr_t misalignment = dest_addr % simd_width;
-	uintptr_t head = (misalignment) ? simd_width - misalignment : 0;
-
-	const uintptr_t body = (size - head) & ~(simd_width - 1);
-	uintptr_t tail = size - head - body;
-	if (head > size) {
-		head = size;
-	}
-	if (!head) {
-		goto skip_head;
-	}
-	if (head == WIDTH_SSE && simd_capability & SIMD_SSE) {
-		syn_memcpy_ssecpy(dest, src, head);
-	} else {
-		syn_memcpy_scalarcpy(dest, src, head);
-	}
-skip_head:
-	switch (simd_capability) {
-	case SIMD_AVX | SIMD_SSE:
-		usize remaining_bytes = size - head;
-		usize avx_chunk = 0;
-		if (remaining_bytes >= WIDTH_AVX) {
-			avx_chunk = remaining_bytes & ~(WIDTH_AVX - 1);
-			syn_memcpy_avxcpy(dest + head, src + head, avx_chunk);
-			remaining_bytes -= avx_chunk;
-		}
-		usize sse_chunk = 0;
-		if (remaining_bytes >= WIDTH_SSE) {
-			sse_chunk = remaining_bytes & ~(WIDTH_SSE - 1);
-			syn_memcpy_ssecpy(dest + head + avx_chunk,
-			                  src + head + avx_chunk,
-			                  sse_chunk);
-		}
-		tail = remaining_bytes - sse_chunk;
-		if (tail) {
-			syn_memcpy_scalarcpy(dest + head + avx_chunk + sse_chunk,
-			                     src + head + avx_chunk + sse_chunk,
-			                     tail);
-		}
-		goto skip_tail;
-	case SIMD_AVX:
-		syn_memcpy_avxcpy(dest + head, src + head, body);
-		break;
-	case SIMD_SSE:
-		syn_memcpy_ssecpy(dest + head, src + head, body);
-		break;
-	default:
-		syn_memcpy_scalarcpy(dest + head, src + head, body);
-		break;
-	}
-	if (tail) {
-		syn_memcpy_scalarcpy(dest + head + body, src + head + body, tail);
-	}
-skip_tail:
+	atomic_load_explicit(&memcpy_kernel, memory_order_relaxed)(dest, src, size);
 	return 0;
 }
 
@@ -176,40 +486,248 @@ skip_tail:
 [[gnu::hot]]
 static inline void syn_memset_scalarset(u8 *restrict target, const u8 byte, const usize size)
 {
-	for (int i = 0; i < size; i++) {
+	for (usize i = 0; i < size; i++) {
 		target[i] = byte;
 	}
 }
 
 
-[[maybe_unused, gnu::hot]]
-static inline void syn_memset_sseset(u8 *restrict target, const u8 byte, const usize size)
+/// Sets less than 16 bytes with two overlapping stores of the largest size that fits.
+[[gnu::hot]]
+static inline void syn_memset_smallset(u8 *restrict target, const u8 byte, const usize size)
 {
-	#ifdef __SSE__
-	const __m128i ssereg = _mm_set1_epi8((char)byte);
-	for (usize i = 0; i + WIDTH_SSE <= size; i += WIDTH_SSE) {
-		_mm_storeu_si128((__m128i *)(target + i), ssereg);
+	if (size >= WIDTH_STD) {
+		const u64 pattern = 0x0101010101010101ULL * byte;
+		__builtin_memcpy(target, &pattern, sizeof(u64));
+		__builtin_memcpy(target + size - sizeof(u64), &pattern, sizeof(u64));
+		return;
+	}
+	if (size >= sizeof(u32)) {
+		const u32 pattern = 0x01010101U * byte;
+		__builtin_memcpy(target, &pattern, sizeof(u32));
+		__builtin_memcpy(target + size - sizeof(u32), &pattern, sizeof(u32));
+		return;
 	}
-	#else
 	syn_memset_scalarset(target, byte, size);
-	#endif
 }
 
 
-[[maybe_unused, gnu::hot]]
-static inline void syn_memset_avxset(u8 *restrict target, const u8 byte, const usize size)
+[[gnu::hot]]
+static inline void syn_memset_ermsset(u8 *restrict target, const u8 byte, usize size)
+{
+	__asm__ volatile("rep stosb" : "+D"(target), "+c"(size) : "a"(byte) : "memory");
+}
+
+
+[[gnu::hot]]
+static void syn_memset_sseset(u8 *restrict target, const u8 byte, const usize size)
+{
+	const __m128i ssereg = _mm_set1_epi8((char)byte);
+
+	_mm_storeu_si128((__m128i *)target, ssereg);
+	usize i = WIDTH_SSE - ((uintptr_t)target & (WIDTH_SSE - 1));
+
+	for (; i + (WIDTH_SSE * 4) <= size; i += WIDTH_SSE * 4) {
+		_mm_store_si128((__m128i *)(target + i), ssereg);
+		_mm_store_si128((__m128i *)(target + i + WIDTH_SSE), ssereg);
+		_mm_store_si128((__m128i *)(target + i + (WIDTH_SSE * 2)), ssereg);
+		_mm_store_si128((__m128i *)(target + i + (WIDTH_SSE * 3)), ssereg);
+	}
+	for (; i + WIDTH_SSE <= size; i += WIDTH_SSE) {
+		_mm_store_si128((__m128i *)(target + i), ssereg);
+	}
+
+	_mm_storeu_si128((__m128i *)(target + size - WIDTH_SSE), ssereg);
+}
+
+
+[[gnu::hot, gnu::target("avx2")]]
+static void syn_memset_avxset(u8 *restrict target, const u8 byte, const usize size)
 {
-	#ifdef __AVX2__
 	const __m256i avxreg = _mm256_set1_epi8((char)byte);
-	for (usize i = 0; i + WIDTH_AVX <= size; i += WIDTH_AVX) {
-		_mm256_storeu_si256((__m256i *)(target + i), avxreg);
+
+	_mm256_storeu_si256((__m256i *)target, avxreg);
+	usize i = WIDTH_AVX - ((uintptr_t)target & (WIDTH_AVX - 1));
+
+	for (; i + (WIDTH_AVX * 4) <= size; i += WIDTH_AVX * 4) {
+		_mm256_store_si256((__m256i *)(target + i), avxreg);
+		_mm256_store_si256((__m256i *)(target + i + WIDTH_AVX), avxreg);
+		_mm256_store_si256((__m256i *)(target + i + (WIDTH_AVX * 2)), avxreg);
+		_mm256_store_si256((__m256i *)(target + i + (WIDTH_AVX * 3)), avxreg);
+	}
+	for (; i + WIDTH_AVX <= size; i += WIDTH_AVX) {
+		_mm256_store_si256((__m256i *)(target + i), avxreg);
 	}
+
+	_mm256_storeu_si256((__m256i *)(target + size - WIDTH_AVX), avxreg);
 	_mm256_zeroupper();
-	#elifdef __SSE__
+}
+
+
+[[gnu::hot, gnu::target("avx512f")]]
+static void syn_memset_avx512set(u8 *restrict target, const u8 byte, const usize size)
+{
+	const __m512i avx512reg = _mm512_set1_epi32((int)(0x01010101U * byte));
+
+	_mm512_storeu_si512((void *)target, avx512reg);
+	usize i = WIDTH_AVX512 - ((uintptr_t)target & (WIDTH_AVX512 - 1));
+
+	for (; i + (WIDTH_AVX512 * 4) <= size; i += WIDTH_AVX512 * 4) {
+		_mm512_store_si512((void *)(target + i), avx512reg);
+		_mm512_store_si512((void *)(target + i + WIDTH_AVX512), avx512reg);
+		_mm512_store_si512((void *)(target + i + (WIDTH_AVX512 * 2)), avx512reg);
+		_mm512_store_si512((void *)(target + i + (WIDTH_AVX512 * 3)), avx512reg);
+	}
+	for (; i + WIDTH_AVX512 <= size; i += WIDTH_AVX512) {
+		_mm512_store_si512((void *)(target + i), avx512reg);
+	}
+
+	_mm512_storeu_si512((void *)(target + size - WIDTH_AVX512), avx512reg);
+	_mm256_zeroupper();
+}
+
+
+[[gnu::hot]]
+static void syn_memset_ssestream(u8 *restrict target, const u8 byte, const usize size)
+{
+	const __m128i ssereg = _mm_set1_epi8((char)byte);
+
+	_mm_storeu_si128((__m128i *)target, ssereg);
+	usize i = WIDTH_SSE - ((uintptr_t)target & (WIDTH_SSE - 1));
+
+	for (; i + (WIDTH_SSE * 4) <= size; i += WIDTH_SSE * 4) {
+		_mm_stream_si128((__m128i *)(target + i), ssereg);
+		_mm_stream_si128((__m128i *)(target + i + WIDTH_SSE), ssereg);
+		_mm_stream_si128((__m128i *)(target + i + (WIDTH_SSE * 2)), ssereg);
+		_mm_stream_si128((__m128i *)(target + i + (WIDTH_SSE * 3)), ssereg);
+	}
+	for (; i + WIDTH_SSE <= size; i += WIDTH_SSE) {
+		_mm_stream_si128((__m128i *)(target + i), ssereg);
+	}
+	_mm_sfence();
+
+	_mm_storeu_si128((__m128i *)(target + size - WIDTH_SSE), ssereg);
+}
+
+
+[[gnu::hot, gnu::target("avx2")]]
+static void syn_memset_avxstream(u8 *restrict target, const u8 byte, const usize size)
+{
+	const __m256i avxreg = _mm256_set1_epi8((char)byte);
+
+	_mm256_storeu_si256((__m256i *)target, avxreg);
+	usize i = WIDTH_AVX - ((uintptr_t)target & (WIDTH_AVX - 1));
+
+	for (; i + (WIDTH_AVX * 4) <= size; i += WIDTH_AVX * 4) {
+		_mm256_stream_si256((__m256i *)(target + i), avxreg);
+		_mm256_stream_si256((__m256i *)(target + i + WIDTH_AVX), avxreg);
+		_mm256_stream_si256((__m256i *)(target + i + (WIDTH_AVX * 2)), avxreg);
+		_mm256_stream_si256((__m256i *)(target + i + (WIDTH_AVX * 3)), avxreg);
+	}
+	for (; i + WIDTH_AVX <= size; i += WIDTH_AVX) {
+		_mm256_stream_si256((__m256i *)(target + i), avxreg);
+	}
+	_mm_sfence();
+
+	_mm256_storeu_si256((__m256i *)(target + size - WIDTH_AVX), avxreg);
+	_mm256_zeroupper();
+}
+
+
+[[gnu::hot, gnu::target("avx512f")]]
+static void syn_memset_avx512stream(u8 *restrict target, const u8 byte, const usize size)
+{
+	const __m512i avx512reg = _mm512_set1_epi32((int)(0x01010101U * byte));
+
+	_mm512_storeu_si512((void *)target, avx512reg);
+	usize i = WIDTH_AVX512 - ((uintptr_t)target & (WIDTH_AVX512 - 1));
+
+	for (; i + (WIDTH_AVX512 * 4) <= size; i += WIDTH_AVX512 * 4) {
+		_mm512_stream_si512((void *)(target + i), avx512reg);
+		_mm512_stream_si512((void *)(target + i + WIDTH_AVX512), avx512reg);
+		_mm512_stream_si512((void *)(target + i + (WIDTH_AVX512 * 2)), avx512reg);
+		_mm512_stream_si512((void *)(target + i + (WIDTH_AVX512 * 3)), avx512reg);
+	}
+	for (; i + WIDTH_AVX512 <= size; i += WIDTH_AVX512) {
+		_mm512_stream_si512((void *)(target + i), avx512reg);
+	}
+	_mm_sfence();
+
+	_mm512_storeu_si512((void *)(target + size - WIDTH_AVX512), avx512reg);
+	_mm256_zeroupper();
+}
+
+
+[[gnu::hot]]
+static void syn_memset_sse_kernel(u8 *restrict target, const u8 byte, const usize size)
+{
+	if (size >= atomic_load_explicit(&nt_threshold, memory_order_relaxed)) {
+		syn_memset_ssestream(target, byte, size);
+		return;
+	}
+	if (size >= atomic_load_explicit(&rep_threshold, memory_order_relaxed)) {
+		syn_memset_ermsset(target, byte, size);
+		return;
+	}
+	syn_memset_sseset(target, byte, size);
+}
+
+
+[[gnu::hot]]
+static void syn_memset_avx_kernel(u8 *restrict target, const u8 byte, const usize size)
+{
+	if (size >= atomic_load_explicit(&nt_threshold, memory_order_relaxed)) {
+		syn_memset_avxstream(target, byte, size);
+		return;
+	}
+	if (size >= atomic_load_explicit(&rep_threshold, memory_order_relaxed)) {
+		syn_memset_ermsset(target, byte, size);
+		return;
+	}
+	if (size >= WIDTH_AVX) {
+		syn_memset_avxset(target, byte, size);
+		return;
+	}
 	syn_memset_sseset(target, byte, size);
-	#else
-	syn_memset_scalarset(target, byte, size);
-	#endif
+}
+
+
+[[gnu::hot]]
+static void syn_memset_avx512_kernel(u8 *restrict target, const u8 byte, const usize size)
+{
+	if (size >= atomic_load_explicit(&nt_threshold, memory_order_relaxed)) {
+		syn_memset_avx512stream(target, byte, size);
+		return;
+	}
+	if (size >= atomic_load_explicit(&rep_threshold, memory_order_relaxed)) {
+		syn_memset_ermsset(target, byte, size);
+		return;
+	}
+	if (size >= WIDTH_AVX512) {
+		syn_memset_avx512set(target, byte, size);
+		return;
+	}
+	if (size >= WIDTH_AVX) {
+		syn_memset_avxset(target, byte, size);
+		return;
+	}
+	syn_memset_sseset(target, byte, size);
+}
+
+
+[[gnu::cold]]
+static void syn_memset_resolve(u8 *restrict target, const u8 byte, const usize size)
+{
+	const int capability = resolve_thresholds();
+
+	memset_kernel_t kernel = syn_memset_sse_kernel;
+	if (capability & SIMD_AVX512) {
+		kernel = syn_memset_avx512_kernel;
+	} else if (capability & SIMD_AVX) {
+		kernel = syn_memset_avx_kernel;
+	}
+	atomic_store_explicit(&memset_kernel, kernel, memory_order_relaxed);
+	kernel(target, byte, size);
 }
 
 
@@ -222,59 +740,21 @@ int syn_memset(void *restrict target, const u8 byte, const usize bytes)
 
 	u8 *dest = target;
 
-	if (bytes < ALIGNMENT || simd_capability & SIMD_NONE) {
-		syn_memset_scalarset(dest, byte, bytes);
+	if (bytes < WIDTH_SSE) {
+		syn_memset_smallset(dest, byte, bytes);
 		return 0;
 	}
-	const uintptr_t dest_addr = (uintptr_t)dest;
-	constexpr u8 simd_width = (simd_capability & SIMD_AVX)
-	                                  ? WIDTH_AVX
-	                                  : ((simd_capability & SIMD_SSE) ? WIDTH_SSE : WIDTH_STD);
 
-	const uintptr_t misalignment = dest_addr % simd_width;
-	uintptr_t head = (misalignment) ? simd_width - misalignment : 0;
+	atomic_load_explicit(&memset_kernel, memory_order_relaxed)(dest, byte, bytes);
+	return 0;
+}
 
-	const uintptr_t body = (bytes - head) & ~(simd_width - 1);
-	uintptr_t tail = bytes - head - body;
-	if (head > bytes) {
-		head = bytes;
-	}
-	if (head) {
-		syn_memset_scalarset(dest, byte, head);
-	}
 
-	switch (simd_capability) {
-	case SIMD_AVX | SIMD_SSE:
-		usize remaining_bytes = bytes - head;
-		usize avx_chunk = 0;
-		if (remaining_bytes >= WIDTH_AVX) {
-			avx_chunk = remaining_bytes & ~(WIDTH_AVX - 1);
-			syn_memset_avxset(dest + head, byte, avx_chunk);
-			remaining_bytes -= avx_chunk;
-		}
-		usize sse_chunk = 0;
-		if (remaining_bytes >= WIDTH_SSE) {
-			sse_chunk = remaining_bytes & ~(WIDTH_SSE - 1);
-			syn_memset_sseset(dest + head + avx_chunk, byte, sse_chunk);
-		}
-		tail = remaining_bytes - sse_chunk;
-		if (tail) {
-			syn_memset_scalarset(dest + head + avx_chunk + sse_chunk, byte, tail);
-		}
-		goto skip_tail;
-	case SIMD_AVX:
-		syn_memset_avxset(dest + head, byte, body);
-		break;
-	case SIMD_SSE:
-		syn_memset_sseset(dest + head, byte, body);
-		break;
-	default:
-		syn_memset_scalarset(dest + head, byte, body);
-		break;
-	}
-	if (tail) {
-		syn_memset_scalarset(dest + head + body, byte, tail);
-	}
-skip_tail:
-	return 0;
+int syn_memset_explicit(void *restrict target, const u8 byte, const usize bytes)
+{
+	const int ret = syn_memset(target, byte, bytes);
+	/* The empty asm claims to read all of memory through target, so the stores above	*
+	 * stay observable even if the block is never read again, like explicit_bzero().	*/
+	__asm__ volatile("" : : "r"(target) : "memory");
+	return ret;
 }
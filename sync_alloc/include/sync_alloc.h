@@ -34,9 +34,145 @@ typedef struct Syn_Handle {
 		generation; /**< generation of pointer, to detect stale handles and use-after-frees.  */
 	//u_int32_t handle_matrix_index;	/**< flattened matrix index.						  */
 } __attribute__((aligned(32))) syn_handle_t;
+
+/**
+ * 	Compact handle, a flattened handle-table index and a generation packed into one integer.
+ *
+ *	@details Unlike syn_handle_t it fits in a register, so it is passed and returned without
+ *	going through memory, and it only costs 8 bytes wherever the user stores it. The header
+ *	is resolved through the handle table on every use, which costs a table walk.
+ *	@details The low 32 bits are the table index, the high 32 bits the generation.
+ *	Failed calls return SYN_REF_INVALID, stale refs are rejected like stale handles.
+ */
+typedef u_int64_t syn_ref_t;
+
+#define SYN_REF_INVALID (~(syn_ref_t)0)
 #endif
 
 
+/**
+ * 	Scope mark, returned by syn_scope_push() and consumed by syn_scope_pop().
+ *
+ *	@details A mark records the bump position of the newest pool and the handle-table
+ *	watermark at the time it was pushed. Popping it rolls back every allocation made since,
+ *	by rewinding that pool and unmapping any pool made after it.
+ *
+ *	@warning Interacting with the structure manually is undefined behavior.
+ */
+typedef struct Syn_Scope {
+	memory_pool_t *pool;	/**< Newest pool when the mark was pushed.	*/
+	u_int32_t offset;	/**< That pool's bump offset.			*/
+	u_int32_t handle_mark;	/**< Handle-table watermark.			*/
+	u_int32_t depth;	/**< Scope depth including this mark.		*/
+} syn_scope_t;
+
+
+/**
+ * 	Explicit arena, for subsystems that want their own pools instead of sharing the thread's.
+ *
+ *	@details Every syn_*_in() function works on the given arena instead of the implicit
+ *	thread arena. An arena is not thread-safe, it may be used from any thread but only
+ *	by one thread at a time.
+ */
+typedef struct Arena syn_arena_t;
+
+/**
+ * 	Read-only view of another process's shared arena, see syn_arena_share().
+ *
+ *	@details A view only reads the owner's arena, it can not allocate, free or pin.
+ */
+typedef struct Persist_Header syn_shared_t;
+
+/**
+ * 	Pool of fixed-size objects, for types that are allocated by the million.
+ *
+ *	@details Objects are packed at a fixed stride in dedicated chunks, with no header, deadzone
+ *	or size search, and freed objects are kept on an intrusive stack, so allocating and freeing
+ *	are a handful of instructions each. A pool is independent of every arena, and like an arena
+ *	it is used by one thread at a time.
+ */
+typedef struct Obj_Pool syn_objpool_t;
+
+typedef enum {
+	SYN_OBJPOOL_DEFAULT = 0,
+	SYN_OBJPOOL_HANDLES = (1 << 0),	/**< Keep a generation per object, for compact handles and double-free checks.	*/
+} syn_objpool_flags_t;
+
+/// How full an object pool is, see syn_objpool_stats().
+typedef struct Syn_Objpool_Stats {
+	size_t live;		/**< Objects handed out and not freed.		*/
+	size_t capacity;	/**< Objects the mapped chunks can hold.	*/
+	size_t chunk_count;	/**< How many chunks are mapped.		*/
+	size_t mapped_bytes;	/**< Memory held by the pool, chunks and index.	*/
+} syn_objpool_stats_t;
+
+/**
+ * 	Where an arena keeps the metadata of small blocks.
+ *
+ *	@details Inline, every block has a header in front of its payload and a deadzone after it.
+ *	Out of line, blocks of up to 256 bytes come from size-class slabs that keep one 16 byte
+ *	header per block in a side array, so their payloads are packed back to back. Larger and
+ *	over-aligned blocks, and anything allocated inside a scope, always use the inline layout.
+ */
+typedef enum {
+	SYN_META_DEFAULT = 0,	/**< Whatever syn_set_meta_layout() last set, inline if never called.	*/
+	SYN_META_INLINE,	/**< Header and deadzone around every payload.				*/
+	SYN_META_OUT_OF_LINE,	/**< Small blocks keep their headers in per-slab side arrays.		*/
+} syn_meta_layout_t;
+
+/** Options for syn_arena_create(). Zeroed fields use the defaults. */
+typedef struct Syn_Arena_Opts {
+	size_t first_pool_size;		/**< Bytes to map for the first pool, rounded up to a page. */
+	syn_meta_layout_t meta_layout;	/**< Metadata layout of the arena's small blocks.	     */
+} syn_arena_opts_t;
+
+/** How much checking validates a block on every call that takes one. */
+typedef enum {
+	SYN_SAFETY_CHECKED = 0,	/**< Deadzones around the block and its pool are verified.	*/
+	SYN_SAFETY_FAST,	/**< Only the handle or magic is verified, deadzones are skipped.	*/
+} syn_safety_t;
+
+/**
+ * 	Process-wide tuning, see syn_configure().
+ *
+ *	@details Start from syn_default_config() and change what needs changing, every field is
+ *	used as given. The same keys can be set without a rebuild through the SYN_ALLOC_CONF
+ *	environment variable, as a comma separated list such as
+ *	@code SYN_ALLOC_CONF="first_pool_size=1M,pool_growth=4,sample_rate=0,safety=fast" @endcode
+ *	Sizes take an optional K, M or G suffix, meta_layout takes inline or out_of_line, and
+ *	safety takes checked or fast.
+ */
+typedef struct Syn_Config {
+	size_t first_pool_size;		/**< Bytes to map for each arena's first pool.			*/
+	unsigned int pool_growth;	/**< How many times bigger each new pool is than the last, 2 to 8.	*/
+	size_t slab_max_size;		/**< Largest block served from slabs in the out-of-line layout.	*/
+	syn_meta_layout_t meta_layout;	/**< Metadata layout of arenas created from now on.		*/
+	syn_safety_t safety;		/**< How much checking every block gets.			*/
+	unsigned int sample_rate;	/**< Mean allocations per guard-paged sample, 0 turns it off.	*/
+	size_t quarantine_budget;	/**< Sensitive bytes to collect before a batch scrub.		*/
+	size_t cache_budget;		/**< Retired mappings to keep for reuse, 0 unmaps them at once.	*/
+	size_t arena_limit;		/**< Soft limit on the pools of each arena made from now on, 0 for none.	*/
+	size_t process_limit;		/**< Soft limit on the pools of every arena together, 0 for none.	*/
+} syn_config_t;
+
+/** Why the pressure callback is called, see syn_set_pressure_callback(). */
+typedef enum {
+	SYN_PRESSURE_NEAR = 0,	/**< A new pool took the arena or the process past 7/8 of a limit.	*/
+	SYN_PRESSURE_LIMIT,	/**< A new pool would go past a limit, the allocation fails unless memory is freed.	*/
+	SYN_PRESSURE_OOM,	/**< The system refused to map a new pool.				*/
+} syn_pressure_t;
+
+/**
+ * Pressure callback, see syn_set_pressure_callback().
+ *
+ * @param arena The arena that needed memory, NULL if it was a new arena that could not be mapped at all.
+ * @param reason Why it was called.
+ * @param request_bytes Size of the allocation that needed the memory.
+ * @param user_data Whatever was registered with the callback.
+ */
+typedef void (*syn_pressure_fn)(syn_arena_t *arena, syn_pressure_t reason, size_t request_bytes, void *user_data);
+
+
 // clang-format off
 typedef enum {
 	ALLOC_SENSITIVE,
@@ -71,6 +207,188 @@ extern void syn_destroy();
 [[gnu::visibility("default")]]
 extern void syn_reset();
 
+/**
+ * @brief Pushes a scope mark, for frame-style lifetimes.
+ *
+ * @details Until the mark is popped, allocations are only bump allocated from the newest pool
+ * and never reuse freed blocks, so everything made inside the scope sits above the mark.
+ * Scopes can be nested, as long as they are popped in reverse order.
+ * @details A block made before the outermost mark can not be moved by syn_realloc() while
+ * the scope is open, since its copy would sit above the mark, such reallocs fail instead.
+ * @return The mark to pass to syn_scope_pop().
+ * @note If the arena_thread is NULL, it is created.
+ */
+[[nodiscard, gnu::visibility("default")]]
+extern syn_scope_t syn_scope_push();
+
+/**
+ * @brief Rolls back every allocation made since the mark was pushed, in O(pools touched).
+ *
+ * @details Blocks allocated before the mark are untouched, even if they were freed inside the scope.
+ * Popping an outer mark also pops every mark nested inside it.
+ * @warning Every handle or ptr obtained since the mark becomes invalid, and should be dropped.
+ */
+[[gnu::visibility("default")]]
+extern void syn_scope_pop(syn_scope_t mark);
+
+/**
+ * @brief Creates a new explicit arena, independent of the implicit thread arena.
+ * @param opts Creation options, may be NULL for the defaults.
+ * @return The new arena, or NULL if there is not enough memory.
+ */
+[[nodiscard, gnu::visibility("default")]]
+extern syn_arena_t *syn_arena_create(const syn_arena_opts_t *opts);
+
+/**
+ * @brief Destroys an explicit arena in O(pools), unmapping every pool and handle table.
+ * A file-backed arena is only closed, its blocks stay in the file.
+ * @warning Every handle or ptr from the arena becomes invalid.
+ */
+[[gnu::visibility("default")]]
+extern void syn_arena_destroy(syn_arena_t *arena);
+
+/**
+ * @brief Resets an explicit arena in O(pools), the same way syn_reset() resets the thread arena.
+ * @warning Every handle or ptr from the arena becomes invalid.
+ */
+[[gnu::visibility("default")]]
+extern void syn_arena_reset(syn_arena_t *arena);
+
+/**
+ * @brief Sets how often allocations are sampled into guard-paged slots, for every thread.
+ *
+ * @details About one in rate allocations that fit a page is given its own page between two
+ * PROT_NONE guard pages, with the payload right-aligned against the trailing one. A sampled
+ * block is not padded, and is aligned only as far as its size allows unless more was asked for,
+ * so an overflow by a single byte faults on the spot, as does a use-after-free. Production builds can drop
+ * the deadzone checks with SYN_ALLOC_DISABLE_SAFETY and still catch memory bugs.
+ * Allocations inside a scope are never sampled. The calling thread switches to the new rate
+ * at once, other threads on their next sample, or within 65536 allocations if sampling was off.
+ * @param rate Mean allocations per sample, GUARD_SAMPLE_RATE by default. 0 turns sampling off.
+ */
+[[gnu::visibility("default")]]
+extern void syn_set_sample_rate(unsigned int rate);
+
+/** @brief Returns the compiled-in configuration, as a base for syn_configure(). */
+[[nodiscard, gnu::visibility("default")]]
+extern syn_config_t syn_default_config();
+
+/**
+ * @brief Replaces the process-wide configuration.
+ *
+ * @details Without a call, the configuration is read once when the first arena is made, from the
+ * compiled-in defaults and SYN_ALLOC_CONF. Keys set in SYN_ALLOC_CONF are applied on top of the
+ * given configuration as well, so a deployment can still override what the program chose.
+ * Pool sizes and the layout apply to arenas and pools made afterwards, everything else at once.
+ * @return 0 on success, 1 if a field is out of range, in which case nothing is changed.
+ * @warning Meant to be called before other threads start allocating.
+ */
+[[gnu::visibility("default")]]
+extern int syn_configure(const syn_config_t *config);
+
+/**
+ * @brief Sets the metadata layout of every arena created from now on, thread arenas included.
+ *
+ * @details Arenas that already exist keep their layout, so this is meant to be called before
+ * the first allocation. syn_arena_create() can override it per arena.
+ * @param layout SYN_META_OUT_OF_LINE to keep small-block headers in side arrays, anything else for inline.
+ */
+[[gnu::visibility("default")]]
+extern void syn_set_meta_layout(syn_meta_layout_t layout);
+
+/**
+ * @brief Scrubs every quarantined sensitive block now, meant to be called when the thread is idle.
+ *
+ * @details Freeing a block marked with syn_mark_sensitive() does not zero it on the spot.
+ * The block is quarantined, so it can not be handed out again, and the whole quarantine is
+ * scrubbed in one batch once it holds the configured quarantine_budget, or when this is called.
+ * Scope pops and resets scrub the quarantine as well.
+ * @note If the arena_thread is NULL, this function does nothing.
+ */
+[[gnu::visibility("default")]]
+extern void syn_scrub_quarantine();
+
+/** @brief syn_scrub_quarantine(), but for an explicit arena. */
+[[gnu::visibility("default")]]
+extern void syn_scrub_quarantine_in(syn_arena_t *arena);
+
+/**
+ * @brief Sets a soft limit on how many bytes of pools an arena, or the whole process, may map.
+ *
+ * @details A new pool that would go past a limit is not mapped right away. The allocator first
+ * makes whatever it can reusable, by scrubbing the quarantine, folding in remote frees and
+ * unmapping cached mappings, then calls the pressure callback and searches the pools once more.
+ * The allocation only fails if that did not free a block that fits and the pool still does not fit.
+ * The same relief runs when mmap() itself fails. Limits are soft, a pool that fits is mapped
+ * whole, and the mappings of guarded blocks, slabs, growbufs and object pools are not counted.
+ * Thread arenas take the arena_limit of the configuration, see syn_config_t.
+ * @param arena The arena to limit, NULL for the process-wide limit.
+ * @param limit_bytes The limit, 0 removes it.
+ */
+[[gnu::visibility("default")]]
+extern void syn_set_limit(syn_arena_t *arena, size_t limit_bytes);
+
+/**
+ * @brief Registers the function called when memory runs short, for every thread.
+ *
+ * @details It is called on the thread that is allocating, with its arena, when a new pool
+ * takes the arena or the process near a limit, past a limit, or when mmap() fails, see
+ * syn_pressure_t. It is the place to drop caches: blocks freed from it are found by the
+ * allocation that is waiting on it. It is not called again while it runs.
+ * @param fn The callback, NULL to remove it.
+ * @param user_data Passed to every call as is.
+ * @warning The callback must not reset or destroy the arena it is given.
+ */
+[[gnu::visibility("default")]]
+extern void syn_set_pressure_callback(syn_pressure_fn fn, void *user_data);
+
+/**
+ * @brief Creates a pool of objects of one size.
+ *
+ * @param obj_size Size of each object, up to 16 KiB.
+ * @param align Alignment of each object, a power of two up to a page (4 KiB). Anything below a ptr is raised to it.
+ * @param flags SYN_OBJPOOL_HANDLES to allow compact handles to objects and catch double frees.
+ * @return The pool, or NULL if the size or alignment is not supported, or there is not enough memory.
+ */
+[[nodiscard, gnu::visibility("default")]]
+extern syn_objpool_t *syn_objpool_create(size_t obj_size, size_t align, syn_objpool_flags_t flags);
+
+/** @brief Unmaps a pool and every object in it. */
+[[gnu::visibility("default")]]
+extern void syn_objpool_destroy(syn_objpool_t *pool);
+
+/**
+ * @brief Takes an object from the pool, freed objects are handed out again first.
+ * @return The object, or NULL if no chunk can be mapped.
+ * @note Objects are not zeroed, a reused one keeps its old contents but for the first word.
+ */
+[[nodiscard, gnu::visibility("default")]]
+extern void *syn_objpool_alloc(syn_objpool_t *pool);
+
+/**
+ * @brief Gives an object back to its pool.
+ * @note Unless safety is SYN_SAFETY_FAST, objects from elsewhere are reported and ignored.
+ */
+[[gnu::visibility("default")]]
+extern void syn_objpool_free(syn_objpool_t *pool, void *obj);
+
+/** @brief Reports how many objects are live against how many the pool can hold without mapping more. */
+[[nodiscard, gnu::visibility("default")]]
+extern syn_objpool_stats_t syn_objpool_stats(const syn_objpool_t *pool);
+
+/**
+ * @brief Makes sure at least size bytes of a growbuf are usable, see syn_growbuf_create().
+ *
+ * @details Pages are committed in place, the buffer never moves, so this may be called while
+ * it is frozen or pinned and every ptr into it stays valid. At least double the committed
+ * bytes are committed each time, so growing a little at a time costs few syscalls.
+ * @param block_ptr The growbuf's payload, from syn_freeze() or syn_growbuf_create().
+ * @param size How many bytes from the start of the payload must be usable.
+ * @return 0 on success, 1 if size is past the buffer's maximum or ptr is not a growbuf.
+ */
+[[gnu::visibility("default")]]
+extern int syn_growbuf_reserve(void *block_ptr, size_t size);
+
 #ifndef SYN_USE_RAW
 #ifdef SYN_ALLOC_DISABLE_SAFETY
 
@@ -104,6 +422,20 @@ extern int syn_check_integrity(struct Arena_Handle *user_hdl);
 [[nodiscard, gnu::visibility("default")]]
 extern syn_handle_t syn_alloc(size_t size);
 
+/**
+ * @brief Allocates a new block of memory whose address is aligned to align.
+ *
+ * @param size How many bytes the user requests.
+ * @param align Alignment of the block, a power of two up to a page (4 KiB).
+ * @return arena handle to the user, invalid if align is not supported.
+ *
+ * @note The header is placed directly in front of the aligned block, and the leading gap
+ * is given back to the pool's free list instead of being wasted.
+ * @note syn_realloc() keeps the alignment when it has to move the block.
+ */
+[[nodiscard, gnu::visibility("default")]]
+extern syn_handle_t syn_alloc_aligned(size_t size, size_t align);
+
 /**
  * @brief Allocates a new block of memory, guaranteed to be zeroed.
  *
@@ -113,8 +445,25 @@ extern syn_handle_t syn_alloc(size_t size);
 [[nodiscard, gnu::visibility("default")]]
 extern syn_handle_t syn_calloc(size_t size);
 
+/**
+ * @brief Allocates a growable buffer whose payload never moves.
+ *
+ * @details The buffer reserves max_bytes of address space up front and commits pages with
+ * syn_growbuf_reserve() as it grows, so growth never copies and never invalidates a ptr.
+ * It starts with a page committed, zeroed. syn_realloc() grows it in place as well, and fails
+ * past max_bytes instead of moving it. syn_free() releases it like any other block.
+ *
+ * @param max_bytes How large the buffer may ever grow, up to 2 GiB.
+ * @return arena handle to the user, invalid if the reservation fails or a scope mark is pushed.
+ * @warning Writing past the bytes reserved so far faults.
+ */
+[[nodiscard, gnu::visibility("default")]]
+extern syn_handle_t syn_growbuf_create(size_t max_bytes);
+
 /**
  * @brief Marks an allocated block as free, then performs defragmentation.
+ * @note Freeing a frozen block does nothing. Freeing a pinned block invalidates the handle
+ * passed in at once, but the block itself is only freed when its last pin is released.
  * @warning If the arena_thread is NULL, or if corruption is detected, the library will terminate.
  */
 
@@ -126,7 +475,8 @@ extern void syn_free(syn_handle_t *user_handle);
  * @brief Reallocates a user's block.
  * @param size The new size for the allocation.
  * @returns a 0 if reallocation succeeds, 1 for failure.
- * @note If the handle is frozen and reallocation is attempted, nothing will happen.
+ * @note If the handle is frozen or pinned and reallocation is attempted, nothing will happen.
+ * @note Inside a scope, a block made before the scope can not move, see syn_scope_push().
  * @warning If the arena_thread is NULL, or if corruption is detected, the library will terminate.
  */
 [[nodiscard, gnu::visibility("default")]]
@@ -155,25 +505,340 @@ extern void *syn_freeze(syn_handle_t *);
 [[nodiscard, gnu::visibility("default")]]
 extern syn_handle_t syn_thaw(void *block_ptr);
 
+/**
+ * @brief Pins an allocation for reading, without invalidating any copy of its handle.
+ *
+ * @details Unlike syn_freeze(), pinning leaves the handle's generation alone, so any number of
+ * holders of the same handle can pin it at once. Each pin is counted in the block's header and
+ * the block will not be moved, reallocated or frozen until every pin is released again. A
+ * syn_free() meanwhile is deferred, the last syn_unpin() frees the block.
+ * @return void ptr to the block of user memory, NULL if the handle is invalid.
+ * @warning If the arena_thread is NULL, the library will terminate.
+ */
+[[nodiscard, gnu::visibility("default")]]
+extern void *syn_pin(syn_handle_t *user_handle);
+
+/**
+ * @brief Releases one pin taken by syn_pin(), the last one completes a syn_free() made meanwhile.
+ * @note The ptr returned by syn_pin() must not be used after the last pin is released.
+ */
+[[gnu::visibility("default")]]
+extern void syn_unpin(syn_handle_t *user_handle);
+
+/**
+ * @brief Marks a block as sensitive, so it is scrubbed before it can ever be reused.
+ * @details The mark follows the block through syn_realloc(), see syn_scrub_quarantine().
+ * A pool that ever held one has its pages dropped when the arena is reset or destroyed.
+ * @return 0 on success, 1 if the handle is invalid.
+ */
+[[gnu::visibility("default")]]
+extern int syn_mark_sensitive(syn_handle_t *user_handle);
+
+/** @brief syn_alloc(), but from an explicit arena. */
+[[nodiscard, gnu::visibility("default")]]
+extern syn_handle_t syn_alloc_in(syn_arena_t *arena, size_t size);
+
+/** @brief syn_calloc(), but from an explicit arena. */
+[[nodiscard, gnu::visibility("default")]]
+extern syn_handle_t syn_calloc_in(syn_arena_t *arena, size_t size);
+
+/**
+ * @brief syn_free(), but for a handle from an explicit arena.
+ * @note Handles are checked against the arena, a handle from another arena is rejected.
+ */
+[[gnu::visibility("default")]]
+extern void syn_free_in(syn_arena_t *arena, syn_handle_t *user_handle);
+
+/** @brief syn_realloc(), but for a handle from an explicit arena. */
+[[nodiscard, gnu::visibility("default")]]
+extern int syn_realloc_in(syn_arena_t *arena, syn_handle_t *user_handle, size_t size);
+
+/** @brief syn_freeze(), but for a handle from an explicit arena. */
+[[nodiscard, gnu::visibility("default")]]
+extern void *syn_freeze_in(syn_arena_t *arena, syn_handle_t *user_handle);
+
+/** @brief syn_thaw(), but for a block from an explicit arena. */
+[[nodiscard, gnu::visibility("default")]]
+extern syn_handle_t syn_thaw_in(syn_arena_t *arena, void *block_ptr);
+
+/** @brief syn_pin(), but for a handle from an explicit arena. */
+[[nodiscard, gnu::visibility("default")]]
+extern void *syn_pin_in(syn_arena_t *arena, syn_handle_t *user_handle);
+
+/** @brief syn_unpin(), but for a handle from an explicit arena. */
+[[gnu::visibility("default")]]
+extern void syn_unpin_in(syn_arena_t *arena, syn_handle_t *user_handle);
+
+/** @brief syn_alloc(), but returns a compact handle. */
+[[nodiscard, gnu::visibility("default")]]
+extern syn_ref_t syn_ref_alloc(size_t size);
+
+/** @brief syn_calloc(), but returns a compact handle. */
+[[nodiscard, gnu::visibility("default")]]
+extern syn_ref_t syn_ref_calloc(size_t size);
+
+/** @brief syn_free(), but for a compact handle. */
+[[gnu::visibility("default")]]
+extern void syn_ref_free(syn_ref_t ref);
+
+/**
+ * @brief syn_realloc(), but for a compact handle.
+ * @return The new compact handle, the old one is stale afterwards.
+ * SYN_REF_INVALID if it fails, in which case the old one stays valid.
+ */
+[[nodiscard, gnu::visibility("default")]]
+extern syn_ref_t syn_ref_realloc(syn_ref_t ref, size_t size);
+
+/** @brief syn_freeze(), but for a compact handle. The ref is stale until it is thawed again. */
+[[nodiscard, gnu::visibility("default")]]
+extern void *syn_ref_freeze(syn_ref_t ref);
+
+/** @brief syn_thaw(), but returns a compact handle. */
+[[nodiscard, gnu::visibility("default")]]
+extern syn_ref_t syn_ref_thaw(void *block_ptr);
+
+/** @brief syn_pin(), but for a compact handle. The ref stays valid while pinned. */
+[[nodiscard, gnu::visibility("default")]]
+extern void *syn_ref_pin(syn_ref_t ref);
+
+/** @brief syn_unpin(), but for a compact handle. */
+[[gnu::visibility("default")]]
+extern void syn_ref_unpin(syn_ref_t ref);
+
+/** @brief Packs a live handle into a compact handle, SYN_REF_INVALID if the handle is stale. */
+[[nodiscard, gnu::visibility("default")]]
+extern syn_ref_t syn_ref_from_handle(const syn_handle_t *user_handle);
+
+/** @brief Expands a compact handle back into a full handle, invalid if the ref is stale. */
+[[nodiscard, gnu::visibility("default")]]
+extern syn_handle_t syn_handle_from_ref(syn_ref_t ref);
+
+/** @brief syn_ref_from_handle(), but for a handle from an explicit arena. */
+[[nodiscard, gnu::visibility("default")]]
+extern syn_ref_t syn_ref_from_handle_in(syn_arena_t *arena, const syn_handle_t *user_handle);
+
+/** @brief syn_handle_from_ref(), but for a compact handle from an explicit arena. */
+[[nodiscard, gnu::visibility("default")]]
+extern syn_handle_t syn_handle_from_ref_in(syn_arena_t *arena, syn_ref_t ref);
+
+/**
+ * @brief Opens a file-backed arena, creating the file if it is empty or missing.
+ *
+ * @details The whole arena lives in one MAP_SHARED mapping of the file, so its blocks and
+ * handle tables are still there after the process exits and the file is opened again.
+ * Only compact handles survive a restart: keep one as the root, and reach the rest from it.
+ * @details The arena is one fixed pool, allocations fail once the file is full.
+ * Closing it with syn_arena_destroy() writes it back and keeps every block.
+ *
+ * @param path File to open or create.
+ * @param size Size of a new file, at least 1 MiB. Ignored when the file already exists.
+ * @return The arena, or NULL if the file can not be mapped or was not closed cleanly.
+ */
+[[nodiscard, gnu::visibility("default")]]
+extern syn_arena_t *syn_arena_open(const char *path, size_t size);
+
+/** @brief Returns the root compact handle of a file-backed arena, SYN_REF_INVALID if none was set. */
+[[nodiscard, gnu::visibility("default")]]
+extern syn_ref_t syn_arena_root(const syn_arena_t *arena);
+
+/** @brief Stores the root compact handle of a file-backed arena in its file. */
+[[gnu::visibility("default")]]
+extern void syn_arena_set_root(syn_arena_t *arena, syn_ref_t ref);
+
+/**
+ * @brief Writes a point-in-time copy of an arena to a file, pipe or socket.
+ *
+ * @details Every pool is written up to its bump offset, followed by the handle tables, so the
+ * snapshot is about as large as what is in use. Sensitive blocks waiting in the quarantine are
+ * scrubbed first. The arena itself is left as it was.
+ *
+ * @param arena The arena to save, NULL for the calling thread's arena.
+ * @param fd Descriptor to write to, from its current position.
+ * @return 0 on success, 1 if there is no arena or a write failed.
+ */
+[[gnu::visibility("default")]]
+extern int syn_arena_snapshot(syn_arena_t *arena, int fd);
+
+/**
+ * @brief Rebuilds a snapshot as a new explicit arena.
+ *
+ * @details Each pool is mapped back at its old address when that is free, which it usually is
+ * in a new process, and otherwise wherever it fits with its ptrs fixed up.
+ * Compact handles saved before the snapshot always resolve against the new arena.
+ * Full handles stay valid as long as every pool landed at its old address, blocks that were
+ * guarded or in a slab are allocated again from the pools and only keep their compact handle.
+ *
+ * @param fd Descriptor to read from, from its current position.
+ * @return The arena, or NULL if the snapshot is truncated, corrupt or does not fit in memory.
+ */
+[[nodiscard, gnu::visibility("default")]]
+extern syn_arena_t *syn_arena_restore(int fd);
+
+/**
+ * @brief Creates an arena in anonymous shared memory that other processes can map, for zero-copy IPC.
+ *
+ * @details The arena is laid out like a file-backed one, in a memfd instead of a file. The
+ * creating process owns it and is the only one that allocates and frees. Pass syn_arena_fd()
+ * to another process, over a unix socket or by fork(), and compact handles to it afterwards.
+ * Closing it with syn_arena_destroy() only drops the owner's mapping, views stay readable.
+ *
+ * @param size Size of the arena, at least 1 MiB. It never grows.
+ * @return The arena, or NULL if the memfd can not be made or mapped.
+ */
+[[nodiscard, gnu::visibility("default")]]
+extern syn_arena_t *syn_arena_share(size_t size);
+
+/** @brief Returns the descriptor behind a shared or file-backed arena, -1 for any other arena. */
+[[nodiscard, gnu::visibility("default")]]
+extern int syn_arena_fd(const syn_arena_t *arena);
+
+/**
+ * @brief Maps a shared arena read-only, from a descriptor received from its owner.
+ * @note The descriptor can be closed afterwards, the view keeps the memory alive.
+ * @return The view, or NULL if the descriptor is not a sync_alloc arena.
+ */
+[[nodiscard, gnu::visibility("default")]]
+extern syn_shared_t *syn_shared_attach(int fd);
+
+/**
+ * @brief Resolves a compact handle from the owner to its payload in this process's view.
+ *
+ * @details Every offset is checked against the view, so a stale or forged ref can not reach
+ * outside of it. Nothing is copied, the ptr is straight into the shared memory.
+ * @warning The owner must write the block before it sends the ref, and must not free it
+ * until the reader is done with it, the view can not hold a pin.
+ * @return The payload, or NULL if the ref is stale or not from this arena.
+ */
+[[nodiscard, gnu::visibility("default")]]
+extern const void *syn_shared_freeze(const syn_shared_t *shared, syn_ref_t ref);
+
+/** @brief Unmaps a view made by syn_shared_attach(). */
+[[gnu::visibility("default")]]
+extern void syn_shared_detach(syn_shared_t *shared);
+
+/**
+ * @brief Packs a live object of a pool made with SYN_OBJPOOL_HANDLES into a compact handle.
+ * @return The ref, or SYN_REF_INVALID if the object is not live or the pool keeps no generations.
+ */
+[[nodiscard, gnu::visibility("default")]]
+extern syn_ref_t syn_objpool_ref(const syn_objpool_t *pool, const void *obj);
+
+/** @brief Resolves a compact handle from syn_objpool_ref(), NULL once the object was freed. */
+[[nodiscard, gnu::visibility("default")]]
+extern void *syn_objpool_deref(const syn_objpool_t *pool, syn_ref_t ref);
+
 #else
 
+/**
+ * @brief Allocates a new block of memory, returning a raw ptr instead of a handle.
+ *
+ * @param size How many bytes the user requests.
+ * @return ptr to the block, aligned to ALIGNMENT, or NULL if the allocation failed.
+ *
+ * @note The block's header sits directly in front of the returned ptr,
+ * so freeing only needs the ptr itself.
+ */
 [[nodiscard, gnu::visibility("default")]]
 extern void *syn_alloc(usize size);
 
+/**
+ * @brief Allocates a new block of memory whose address is aligned to align.
+ *
+ * @param size How many bytes the user requests.
+ * @param align Alignment of the block, a power of two up to a page (4 KiB).
+ * @return ptr to the block, or NULL if the allocation failed or align is not supported.
+ *
+ * @note The header is placed directly in front of the aligned block, so syn_free() works as usual,
+ * and the leading gap is given back to the pool's free list instead of being wasted.
+ * @note syn_realloc() only keeps ALIGNMENT for blocks it has to move.
+ */
+[[nodiscard, gnu::visibility("default")]]
+extern void *syn_alloc_aligned(usize size, usize align);
+
+/**
+ * @brief Allocates a new block of memory, guaranteed to be zeroed.
+ *
+ * @param size How many bytes to allocate to the heap.
+ * @return ptr to the block, or NULL if the allocation failed.
+ */
 [[nodiscard, gnu::visibility("default")]]
 extern void *syn_calloc(usize size);
 
+/**
+ * @brief Allocates a growable buffer whose address never changes, returning a raw ptr.
+ *
+ * @details The buffer reserves max_bytes of address space up front and commits pages with
+ * syn_growbuf_reserve() as it grows, so growth never copies. syn_realloc() returns the same
+ * ptr for as long as the reservation lasts and NULL past it, the buffer is never moved.
+ * syn_free() releases it.
+ *
+ * @param max_bytes How large the buffer may ever grow, up to 2 GiB.
+ * @return ptr to the buffer, or NULL if the reservation fails or a scope mark is pushed.
+ * @warning Writing past the bytes reserved so far faults.
+ */
+[[nodiscard, gnu::visibility("default")]]
+extern void *syn_growbuf_create(usize max_bytes);
+
+/**
+ * @brief Frees a raw block.
+ * @note Any thread may free any raw block. Blocks owned by another thread are queued
+ * and returned to the owning arena on that thread's next allocation. The arena of a thread
+ * that exits without syn_destroy() is kept, and adopted by the next thread that needs one.
+ * @warning Freeing a block whose owning thread already called syn_destroy() is undefined behavior.
+ */
 [[gnu::visibility("default")]]
-extern void syn_free(void *);
+extern void syn_free(void *block_ptr);
 
+/**
+ * @brief Reallocates a raw block, with realloc() semantics.
+ * @param block_ptr The block to resize. If NULL, this behaves like syn_alloc().
+ * @param size The new size for the allocation. If zero, the block is freed and NULL is returned.
+ * @return ptr to the resized block, which may have moved, or NULL on failure.
+ * The original block is left untouched on failure.
+ * @note If the block is frozen, nothing will happen and NULL is returned.
+ * @note Inside a scope, a block made before the scope can not move, see syn_scope_push().
+ */
+[[nodiscard, gnu::visibility("default")]]
+extern void *syn_realloc(void *block_ptr, usize size);
+
+/**
+ * @brief Freezes a raw block so it will not be relocated or freed.
+ * @return The same ptr, or NULL if the block is invalid.
+ */
+[[nodiscard, gnu::visibility("default")]]
+extern void *syn_freeze(void *block_ptr);
+
+/** @brief Thaws a raw block frozen by syn_freeze(). */
 [[gnu::visibility("default")]]
-extern int syn_realloc(void *, usize size);
+extern void syn_thaw(void *block_ptr);
 
+/**
+ * @brief Marks a raw block as sensitive, so it is scrubbed before it can ever be reused.
+ * @details The mark follows the block through syn_realloc(), see syn_scrub_quarantine().
+ * A pool that ever held one has its pages dropped when the arena is reset or destroyed.
+ * @return 0 on success, 1 if the ptr is invalid.
+ */
+[[gnu::visibility("default")]]
+extern int syn_mark_sensitive(void *block_ptr);
+
+/** @brief syn_alloc(), but from an explicit arena. */
+[[nodiscard, gnu::visibility("default")]]
+extern void *syn_alloc_in(syn_arena_t *arena, usize size);
+
+/** @brief syn_calloc(), but from an explicit arena. */
 [[nodiscard, gnu::visibility("default")]]
-extern void *syn_freeze(void *);
+extern void *syn_calloc_in(syn_arena_t *arena, usize size);
 
+/**
+ * @brief syn_free(), but for a block from an explicit arena.
+ * @note A block that belongs to another arena is queued to that arena instead.
+ */
 [[gnu::visibility("default")]]
-extern void syn_thaw(void *);
+extern void syn_free_in(syn_arena_t *arena, void *block_ptr);
+
+/** @brief syn_realloc(), but for a block from an explicit arena. */
+[[nodiscard, gnu::visibility("default")]]
+extern void *syn_realloc_in(syn_arena_t *arena, void *block_ptr, usize size);
 
 #endif
 
@@ -0,0 +1,158 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+// ReSharper disable CppUnusedIncludeDirective
+
+#include "sync_alloc.h"
+#include "alloc_utils.h"
+#include "defs.h"
+#include "globals.h"
+#include "structs.h"
+#include "types.h"
+#include <errno.h>
+#include <stdint.h>
+
+/* malloc-compatible entry points over the raw API, meant to be LD_PRELOAD'ed into	*
+ * binaries that were never written around handles, so they can be A/B tested		*
+ * against glibc. Nothing in here holds state, it only translates malloc semantics.	*/
+
+#ifndef SYN_USE_RAW
+	static_assert(0, "the preload shim has to be built with SYN_USE_RAW!\n");
+#endif
+
+
+static inline int shim_memalign(void **out, const usize align, const usize size)
+{
+	if (align == 0 || (align & (align - 1)) != 0) {
+		return EINVAL;
+	}
+	if (align > MAX_ALLOC_ALIGN) {
+		return ENOMEM;
+	}
+
+	void *block_ptr = syn_alloc_aligned((size == 0) ? 1 : size, align);
+	if (block_ptr == nullptr) {
+		return ENOMEM;
+	}
+	*out = block_ptr;
+	return 0;
+}
+
+
+[[gnu::visibility("default")]]
+void *malloc(const usize size)
+{
+	void *block_ptr = syn_alloc((size == 0) ? 1 : size);
+	if (block_ptr == nullptr) {
+		errno = ENOMEM;
+	}
+	return block_ptr;
+}
+
+
+[[gnu::visibility("default")]]
+void free(void *ptr)
+{
+	if (ptr == nullptr) {
+		return;
+	}
+	syn_free(ptr);
+}
+
+
+[[gnu::visibility("default")]]
+void *calloc(const usize count, const usize size)
+{
+	usize bytes = 0;
+	if (__builtin_mul_overflow(count, size, &bytes)) {
+		errno = ENOMEM;
+		return nullptr;
+	}
+
+	void *block_ptr = syn_calloc((bytes == 0) ? 1 : bytes);
+	if (block_ptr == nullptr) {
+		errno = ENOMEM;
+	}
+	return block_ptr;
+}
+
+
+[[gnu::visibility("default")]]
+void *realloc(void *ptr, const usize size)
+{
+	if (ptr == nullptr) {
+		return malloc(size);
+	}
+
+	void *block_ptr = syn_realloc(ptr, size);
+	if (block_ptr == nullptr && size != 0) {
+		errno = ENOMEM;
+	}
+	return block_ptr;
+}
+
+
+[[gnu::visibility("default")]]
+void *reallocarray(void *ptr, const usize count, const usize size)
+{
+	usize bytes = 0;
+	if (__builtin_mul_overflow(count, size, &bytes)) {
+		errno = ENOMEM;
+		return nullptr;
+	}
+	return realloc(ptr, bytes);
+}
+
+
+[[gnu::visibility("default")]]
+int posix_memalign(void **out, const usize align, const usize size)
+{
+	if (align < sizeof(void *)) {
+		return EINVAL;
+	}
+	return shim_memalign(out, align, size);
+}
+
+
+[[gnu::visibility("default")]]
+void *aligned_alloc(const usize align, const usize size)
+{
+	void *block_ptr = nullptr;
+	const int ret = shim_memalign(&block_ptr, align, size);
+	if (ret != 0) {
+		errno = ret;
+		return nullptr;
+	}
+	return block_ptr;
+}
+
+
+[[gnu::visibility("default")]]
+void *memalign(const usize align, const usize size)
+{
+	return aligned_alloc(align, size);
+}
+
+
+[[gnu::visibility("default")]]
+usize malloc_usable_size(void *ptr)
+{
+	if (ptr == nullptr) {
+		return 0;
+	}
+	return return_header(ptr)->allocation_size;
+}
+
+
+[[gnu::visibility("default")]]
+void *valloc(const usize size)
+{
+	return aligned_alloc(MAX_ALLOC_ALIGN, size);
+}
+
+
+[[gnu::visibility("default")]]
+void *pvalloc(const usize size)
+{
+	return aligned_alloc(MAX_ALLOC_ALIGN, ALIGN_PTR(size, MAX_ALLOC_ALIGN));
+}
@@ -4,12 +4,16 @@
 
 #include "alloc_init.h"
 #include "alloc_utils.h"
+#include "config.h"
 #include "deadzone.h"
 #include "debug.h"
 #include "defs.h"
 #include "globals.h"
-#include "handle.h"
+#include "pressure.h"
+#include "region_cache.h"
+#include "slab.h"
 #include "structs.h"
+#include "trace.h"
 #include "types.h"
 #include <signal.h>
 #include <stdint.h>
@@ -18,6 +22,10 @@
 #include <sys/mman.h>
 #include <unistd.h>
 
+#ifndef SYN_USE_RAW
+#include "handle.h"
+#endif
+
 _Thread_local arena_t *arena_thread = nullptr;
 
 
@@ -29,18 +37,59 @@ int syn_unmap_page(void *restrict mem, const usize bytes)
 
 void *syn_map_page(const usize bytes)
 {
-	return mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	void *mem = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	return (mem == MAP_FAILED) ? nullptr : mem;
 }
 
 
-int arena_init()
+int arena_init(const usize first_pool_size)
 {
-	void *raw_pool = syn_map_page(MAX_FIRST_POOL_SIZE);
+	config_load();
 
-	if (raw_pool == MAP_FAILED) {
-		goto alloc_failure;
+	usize map_size = (first_pool_size == 0) ? alloc_config.first_pool_size : first_pool_size;
+	if (map_size > MAX_POOL_SIZE) {
+		map_size = MAX_POOL_SIZE;
 	}
+	map_size = ALIGN_PTR(map_size, 4 * KIBIBYTE);
+
+	usize dirty_bytes;
+	void *raw_pool = nullptr;
+	bool relieved = false;
+
+remap:
+	const pressure_status_t pressure = pressure_check(map_size);
+	if (pressure != PRESSURE_OVER) {
+		raw_pool = region_cache_map(map_size, &dirty_bytes);
+	}
+	if (raw_pool == nullptr) {
+		if (relieved) {
+			goto alloc_failure;
+		}
+		// There is no arena yet, so the application is all that can make room.
+		pressure_relieve((pressure == PRESSURE_OVER) ? SYN_PRESSURE_LIMIT : SYN_PRESSURE_OOM, map_size, map_size);
+		relieved = true;
+		goto remap;
+	}
+
+	arena_setup(raw_pool, map_size, dirty_bytes);
+	#ifndef SYN_USE_RAW
+	arena_thread->first_hdl_tbl = new_handle_table();
+	#endif
+	SYN_TRACE(arena_init, map_size, arena_thread);
+	return 0;
+
+alloc_failure:
+	#ifdef ALLOC_DEBUG
+	sync_alloc_log.to_console(
+		log_stderr,
+		"OOM, when you buy more ram, send some to your local protogen too!\n");
+	#endif
+	return 1;
+}
+
 
+void arena_setup(void *raw_pool, const usize map_size, const usize dirty_bytes)
+{
 	arena_thread = raw_pool;
 
 	memory_pool_t *first_pool = (memory_pool_t *)((char *)raw_pool + STRUCT_SIZE_ARENA);
@@ -49,37 +98,55 @@ int arena_init()
 		(uintptr_t)raw_pool;
 
 	first_pool->heap_base = raw_pool;
+	first_pool->arena = arena_thread;
 	first_pool->mem = (void *)((char *)raw_pool + relative_cache_align);
 
 	create_pool_deadzone(first_pool);
 	const uintptr_t reserved_bytes = (uintptr_t)first_pool->mem - (uintptr_t)raw_pool;
 
 	first_pool->offset = 0;
-	first_pool->size = MAX_FIRST_POOL_SIZE - reserved_bytes;
+	first_pool->size = map_size - reserved_bytes;
+	first_pool->free_count = 0;
+	first_pool->pool_id = 0;
+	first_pool->untouched = (dirty_bytes > reserved_bytes) ? (u32)(dirty_bytes - reserved_bytes) : 0;
+	first_pool->first_free = nullptr;
 	first_pool->next_pool = nullptr;
-
-	arena_thread->total_arena_bytes = (usize)MAX_FIRST_POOL_SIZE;
+	first_pool->held_sensitive = false;
+
+	arena_thread->total_arena_bytes = map_size;
+	arena_thread->scope_pool = nullptr;
+	arena_thread->scope_offset = 0;
+	arena_thread->scope_depth = 0;
+	arena_thread->quarantine = nullptr;
+	arena_thread->quarantine_bytes = 0;
+	arena_thread->persist = nullptr;
+	arena_thread->growbufs = nullptr;
+	arena_thread->limit_bytes = alloc_config.arena_limit;
+	arena_thread->slab_meta = slab_default_layout();
+	for (u32 i = 0; i < SLAB_CLASS_COUNT; i++) {
+		arena_thread->slab_partial[i] = nullptr;
+	}
+	arena_thread->slabs = nullptr;
+	#ifndef SYN_USE_RAW
 	arena_thread->table_count = 0;
-	arena_thread->first_hdl_tbl = new_handle_table();
+	arena_thread->hdl_high_water = 0;
+	arena_thread->table_slab = nullptr;
+	arena_thread->first_hdl_tbl = nullptr;
+	arena_thread->tombstones = nullptr;
+	#else
+	arena_thread->remote_free = nullptr;
+	arena_thread->next_orphan = nullptr;
+	#endif
 	arena_thread->first_mempool = first_pool;
 	arena_thread->pool_count = 1;
-
-	return 0;
-
-alloc_failure:
-	#ifdef ALLOC_DEBUG
-	sync_alloc_log.to_console(
-		log_stderr,
-		"OOM, when you buy more ram, send some to your local protogen too!\n");
-	#endif
-	return 1;
 }
 
 
 memory_pool_t *pool_init(const u32 size)
 {
 	const usize padded_size = ADD_ALIGNMENT_PADDING(size);
-	void *raw_pool = syn_map_page(padded_size);
+	usize dirty_bytes;
+	void *raw_pool = region_cache_map(padded_size, &dirty_bytes);
 
 	if (!raw_pool) {
 		return nullptr;
@@ -91,6 +158,7 @@ memory_pool_t *pool_init(const u32 size)
 	memory_pool_t *new_pool = raw_pool;
 
 	new_pool->heap_base = raw_pool;
+	new_pool->arena = arena_thread;
 	new_pool->mem = (void *)((char *)raw_pool + relative_cache_align);
 
 	create_pool_deadzone(new_pool);
@@ -98,9 +166,13 @@ memory_pool_t *pool_init(const u32 size)
 
 	new_pool->size = padded_size - reserved_bytes;
 	new_pool->free_count = 0;
+	new_pool->pool_id = arena_thread->pool_count;
 	new_pool->offset = 0;
+	new_pool->untouched = (dirty_bytes > reserved_bytes) ? (u32)(dirty_bytes - reserved_bytes) : 0;
 	new_pool->first_free = nullptr;
 	new_pool->next_pool = nullptr;
+	new_pool->held_sensitive = false;
+	SYN_TRACE(pool_create, padded_size, new_pool, new_pool->pool_id);
 
 	memory_pool_t *pool[arena_thread->pool_count];
 	const int pool_arr_len = return_pool_array(pool);
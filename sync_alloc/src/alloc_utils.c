@@ -4,26 +4,83 @@
 // ReSharper disable CppUnusedIncludeDirective
 
 #include "alloc_init.h"
+#include "config.h"
 #include "alloc_utils.h"
 #include "deadzone.h"
 #include "debug.h"
 #include "defs.h"
 #include "free_node.h"
 #include "globals.h"
-#include "handle.h"
+#include "growbuf.h"
+#include "guard_page.h"
+#include "slab.h"
 #include "structs.h"
 #include "types.h"
 #include <signal.h>
 #include <stdint.h>
 
+#ifndef SYN_USE_RAW
+#include "handle.h"
+#endif
+
 // Not implemented
 // void
 // defragment_pool(Memory_Pool *pool);
 
 #ifdef SYN_USE_RAW
 
-inline int bad_alloc_check(const void *, const int do_checksum)
+inline int bad_alloc_check(const void *block_ptr, const int do_checksum)
 {
+	// arena_thread is allowed to be NULL here, raw blocks can be freed by any thread.
+	if (block_ptr == nullptr) {
+		return -1;
+	}
+
+	// Slab blocks are validated before their header is looked up, it is found through the slab.
+	const bool in_slab = slab_owns(block_ptr);
+	if (in_slab && slab_check(block_ptr) != 0) {
+		sync_alloc_log.to_console(log_stderr, "ptr %p was not allocated by sync_alloc!\n", block_ptr);
+		return 1;
+	}
+
+	pool_header_t *head = return_header((void *)block_ptr);
+	// Guarded blocks are validated before their header is touched, a freed slot would fault.
+	const bool guarded = guard_owns(block_ptr);
+	if (guarded && (guard_check(head) != 0 || guard_block(head) != block_ptr)) {
+		sync_alloc_log.to_console(log_stderr,
+		                          "guarded ptr %p is not live, double free or use after free!\n",
+		                          block_ptr);
+		return 1;
+	}
+	// Another thread already queued it for its owner, see syn_free().
+	if (__atomic_load_n(&head->magic, __ATOMIC_RELAXED) == RAW_REMOTE_MAGIC) {
+		sync_alloc_log.to_console(log_stderr, "double free of %p detected!\n", block_ptr);
+		return 1;
+	}
+	if (do_checksum && head->magic != RAW_HEADER_MAGIC) {
+		sync_alloc_log.to_console(log_stderr, "ptr %p was not allocated by sync_alloc!\n", block_ptr);
+		return 1;
+	}
+	if (!(head->bitflags & F_ALLOCATED)) {
+		sync_alloc_log.to_console(log_stderr, "double free of %p detected!\n", block_ptr);
+		return 1;
+	}
+	#ifndef SYN_ALLOC_DISABLE_SAFETY
+	if (guarded || in_slab || (head->bitflags & F_GROWBUF) || alloc_config.safety == SYN_SAFETY_FAST) {
+		goto skip_deadzone_check;
+	}
+	if (corrupt_header_check(head)) {
+		syn_panic("allocator structure <Pool_Header> corruption detected!\n");
+	}
+	if (corrupt_pool_check(return_pool(head))) {
+		syn_panic("allocator structure <Memory_Pool> corruption detected!\n");
+	}
+skip_deadzone_check:
+	#endif
+	if (head->bitflags & F_FROZEN) {
+		return 2;
+	}
+	return 0;
 }
 
 #else
@@ -36,7 +93,29 @@ inline int bad_alloc_check(const syn_handle_t *restrict hdl, const int do_checks
 	if (arena_thread == nullptr) {
 		syn_panic("core arena context was lost!\n");
 	}
+	// Guarded blocks are validated before their header is touched, a freed slot would fault.
+	const bool guarded = guard_owns(hdl->header);
+	if (guarded && guard_check(hdl->header) != 0) {
+		sync_alloc_log.to_console(log_stderr,
+		                          "guarded handle is not live, double free or use after free!\n");
+		return 1;
+	}
+	// The memory of a stale handle may have been rewound by a scope pop, so nothing past its index is read.
+	if (do_checksum && !handle_generation_checksum(hdl)) {
+		sync_alloc_log.to_console(log_stderr, "stale handle detected!\n");
+		return 1;
+	}
+	if (guarded) {
+		goto skip_pool_check;
+	}
+	// Out-of-line headers and growbufs have no deadzone or pool around them.
+	if (slab_owns(hdl->header) || (hdl->header->bitflags & F_GROWBUF)) {
+		goto skip_pool_check;
+	}
 	#ifndef SYN_ALLOC_DISABLE_SAFETY
+	if (alloc_config.safety == SYN_SAFETY_FAST) {
+		goto skip_pool_check;
+	}
 	if (hdl->header->bitflags & F_SENTINEL) {
 		goto skip_header_check;
 	}
@@ -48,15 +127,18 @@ skip_header_check:
 		syn_panic("allocator structure <Memory_Pool> corruption detected!\n");
 	}
 	#endif
-	if (do_checksum && !handle_generation_checksum(hdl)) {
-		sync_alloc_log.to_console(log_stderr, "stale handle detected!\n");
+skip_pool_check:
+	if (return_arena(hdl->header) != arena_thread) {
+		sync_alloc_log.to_console(log_stderr, "handle belongs to a different arena!\n");
 		return 1;
 	}
-	if (hdl->header->bitflags & F_FROZEN) {
+	// Pinned blocks must not move either, they are only shared instead of locked.
+	if (hdl->header->bitflags & F_FROZEN || return_pin_count(hdl->header) != 0) {
 		return 2;
 	}
 	return 0;
 }
+#endif
 
 
 [[gnu::hot, gnu::pure]]
@@ -66,12 +148,30 @@ memory_pool_t *return_pool(const pool_header_t *restrict header)
 		((head_deadzone_t *)((char *)header + (header->chunk_size - DEADZONE_SIZE)));
 	return (memory_pool_t *)head_dz->pool_ptr;
 }
-#endif
+
+
+[[gnu::hot, gnu::pure]]
+arena_t *return_arena(const pool_header_t *restrict header)
+{
+	if (header->bitflags & F_GUARDED) {
+		return guard_owner(header);
+	}
+	if (header->bitflags & F_GROWBUF) {
+		return growbuf_owner(header);
+	}
+	return (header->bitflags & F_SLAB_BLOCK) ? slab_owner(header) : return_pool(header)->arena;
+}
 
 
 [[gnu::hot, gnu::pure]]
 pool_header_t *return_header(void *block_ptr)
 {
+	if (slab_owns(block_ptr)) {
+		return slab_header(block_ptr);
+	}
+	if (guard_owns(block_ptr)) {
+		return guard_header(block_ptr);
+	}
 	#if ALIGNMENT == 16
 	return (pool_header_t *)block_ptr - 1;
 	#else
@@ -164,7 +264,41 @@ void pool_destructor()
 			                          arena_thread);
 		}
 		#endif
-		arena_thread->total_arena_bytes -= pool_arr[i]->size;
-		syn_unmap_page(pool_arr[i]->heap_base, pool_arr[i]->size);
+		// The first pool holds the arena itself, so nothing may touch arena_thread once it is retired.
+		arena_thread->total_arena_bytes -= pool_mapped_bytes(pool_arr[i]);
+		pool_unmap(pool_arr[i]);
+	}
+}
+
+
+#ifndef SYN_USE_RAW
+/// Emptied first pages of a mapping, see tombstone_keep().
+typedef struct Tombstone {
+	struct Tombstone *next_tombstone;
+	usize map_size;
+} tombstone_t;
+
+
+void tombstone_keep(arena_t *arena, void *base, const usize kept_bytes)
+{
+	madvise(base, kept_bytes, MADV_DONTNEED);
+
+	tombstone_t *tombstone = base;
+	tombstone->next_tombstone = arena->tombstones;
+	tombstone->map_size = kept_bytes;
+	arena->tombstones = tombstone;
+}
+
+
+void tombstone_release_arena(arena_t *arena)
+{
+	tombstone_t *tombstone = arena->tombstones;
+	arena->tombstones = nullptr;
+
+	while (tombstone != nullptr) {
+		tombstone_t *next_tombstone = tombstone->next_tombstone;
+		munmap(tombstone, tombstone->map_size);
+		tombstone = next_tombstone;
 	}
 }
+#endif
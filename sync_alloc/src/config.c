@@ -0,0 +1,301 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#include "config.h"
+#include "debug.h"
+#include "defs.h"
+#include "globals.h"
+#include "guard_page.h"
+#include "pressure.h"
+#include "slab.h"
+#include "types.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum Config_State : u32 {
+	CONFIG_UNREAD,
+	CONFIG_LOADING,
+	CONFIG_READY,
+};
+
+// Zeroed until loaded, only a free from a thread without an arena can read it that early.
+syn_config_t alloc_config = {};
+
+static _Atomic u32 config_state = CONFIG_UNREAD;
+
+constexpr u32 CONFIG_MAX_NOTES = 8;
+
+/* Bad SYN_ALLOC_CONF pairs found while loading. They are only logged once the state is	*
+ * READY, logging can allocate, and an allocation then would wait on the load it is in.	*/
+typedef struct Config_Notes {
+	const char *pair[CONFIG_MAX_NOTES];	/**< The bad pairs, they point into the environment.	*/
+	int pair_len[CONFIG_MAX_NOTES];		/**< Length of each bad pair.				*/
+	u32 count;				/**< How many bad pairs there were in total.		*/
+} config_notes_t;
+
+
+syn_config_t config_default()
+{
+	const syn_config_t config = {
+		.first_pool_size = MAX_FIRST_POOL_SIZE,
+		.pool_growth = 2,
+		.slab_max_size = MAX_ALLOC_SLAB_SIZE,
+		.meta_layout = SYN_META_INLINE,
+		.safety = SYN_SAFETY_CHECKED,
+		.sample_rate = GUARD_SAMPLE_RATE,
+		.quarantine_budget = QUARANTINE_BUDGET,
+		.cache_budget = REGION_CACHE_BUDGET,
+		.arena_limit = 0,
+		.process_limit = 0,
+	};
+	return config;
+}
+
+
+static int config_validate(const syn_config_t *config)
+{
+	if (config->first_pool_size == 0 || config->first_pool_size > MAX_POOL_SIZE) {
+		return 1;
+	}
+	if (config->pool_growth < 2 || config->pool_growth > 8) {
+		return 1;
+	}
+	if (config->slab_max_size < MINIMUM_BLOCK_ALLOC || config->slab_max_size > MAX_ALLOC_SLAB_SIZE) {
+		return 1;
+	}
+	if (config->meta_layout > SYN_META_OUT_OF_LINE || config->safety > SYN_SAFETY_FAST) {
+		return 1;
+	}
+	return 0;
+}
+
+
+static inline bool config_key_is(const char *key, const usize key_len, const char *name)
+{
+	return strlen(name) == key_len && memcmp(key, name, key_len) == 0;
+}
+
+
+/// Parses a decimal count with an optional K, M or G suffix, 1 if it is not one.
+static int config_parse_size(const char *str, const usize len, usize *out)
+{
+	usize value = 0;
+	usize i = 0;
+
+	for (; i < len && str[i] >= '0' && str[i] <= '9'; i++) {
+		if (__builtin_mul_overflow(value, 10, &value) || __builtin_add_overflow(value, (usize)(str[i] - '0'), &value)) {
+			return 1;
+		}
+	}
+	if (i == 0) {
+		return 1;
+	}
+
+	usize scale = 1;
+	if (i + 1 == len) {
+		switch (str[i]) {
+		case 'k':
+		case 'K': scale = KIBIBYTE; break;
+		case 'm':
+		case 'M': scale = MEBIBYTE; break;
+		case 'g':
+		case 'G': scale = GIBIBYTE; break;
+		default: return 1;
+		}
+	} else if (i != len) {
+		return 1;
+	}
+	return __builtin_mul_overflow(value, scale, out) ? 1 : 0;
+}
+
+
+static int config_parse_pair(syn_config_t *config, const char *key, const usize key_len, const char *val, const usize val_len)
+{
+	usize size = 0;
+
+	if (config_key_is(key, key_len, "meta_layout")) {
+		if (config_key_is(val, val_len, "inline")) {
+			config->meta_layout = SYN_META_INLINE;
+		} else if (config_key_is(val, val_len, "out_of_line")) {
+			config->meta_layout = SYN_META_OUT_OF_LINE;
+		} else {
+			return 1;
+		}
+		return 0;
+	}
+	if (config_key_is(key, key_len, "safety")) {
+		if (config_key_is(val, val_len, "checked")) {
+			config->safety = SYN_SAFETY_CHECKED;
+		} else if (config_key_is(val, val_len, "fast")) {
+			config->safety = SYN_SAFETY_FAST;
+		} else {
+			return 1;
+		}
+		return 0;
+	}
+
+	if (config_parse_size(val, val_len, &size) != 0) {
+		return 1;
+	}
+	if (config_key_is(key, key_len, "first_pool_size")) {
+		config->first_pool_size = size;
+	} else if (config_key_is(key, key_len, "pool_growth")) {
+		config->pool_growth = (size > UINT32_MAX) ? 0 : (u32)size;
+	} else if (config_key_is(key, key_len, "slab_max_size")) {
+		config->slab_max_size = size;
+	} else if (config_key_is(key, key_len, "sample_rate")) {
+		config->sample_rate = (size > UINT32_MAX) ? UINT32_MAX : (u32)size;
+	} else if (config_key_is(key, key_len, "quarantine_budget")) {
+		config->quarantine_budget = size;
+	} else if (config_key_is(key, key_len, "cache_budget")) {
+		config->cache_budget = size;
+	} else if (config_key_is(key, key_len, "arena_limit")) {
+		config->arena_limit = size;
+	} else if (config_key_is(key, key_len, "process_limit")) {
+		config->process_limit = size;
+	} else {
+		return 1;
+	}
+	return 0;
+}
+
+
+/**
+ * Applies SYN_ALLOC_CONF on top of a configuration, key by key.
+ * A bad pair is noted and skipped, so one typo does not throw the rest away.
+ * It runs inside the first malloc when preloaded, so nothing in here may allocate.
+ */
+static void config_parse_env(syn_config_t *config, config_notes_t *notes)
+{
+	const char *env = getenv("SYN_ALLOC_CONF");
+	if (env == nullptr) {
+		return;
+	}
+
+	while (*env != '\0') {
+		const char *pair_end = strchr(env, ',');
+		const usize pair_len = (pair_end != nullptr) ? (usize)(pair_end - env) : strlen(env);
+		const char *split = memchr(env, '=', pair_len);
+
+		if (pair_len != 0) {
+			syn_config_t candidate = *config;
+			const bool parsed = split != nullptr &&
+			                    config_parse_pair(&candidate,
+			                                      env,
+			                                      (usize)(split - env),
+			                                      split + 1,
+			                                      pair_len - (usize)(split - env) - 1) == 0;
+
+			if (parsed && config_validate(&candidate) == 0) {
+				*config = candidate;
+			} else if (notes->count++ < CONFIG_MAX_NOTES) {
+				notes->pair[notes->count - 1] = env;
+				notes->pair_len[notes->count - 1] = (int)pair_len;
+			}
+		}
+		env += pair_len;
+		if (*env == ',') {
+			env++;
+		}
+	}
+}
+
+
+static void config_report(const config_notes_t *notes)
+{
+	for (u32 i = 0; i < notes->count && i < CONFIG_MAX_NOTES; i++) {
+		sync_alloc_log.to_console(log_stderr,
+		                          "SYN_ALLOC_CONF: ignoring bad setting \"%.*s\"!\n",
+		                          notes->pair_len[i],
+		                          notes->pair[i]);
+	}
+	if (notes->count > CONFIG_MAX_NOTES) {
+		sync_alloc_log.to_console(log_stderr,
+		                          "SYN_ALLOC_CONF: ignoring %u more bad settings!\n",
+		                          notes->count - CONFIG_MAX_NOTES);
+	}
+}
+
+
+static void config_store(const syn_config_t *config)
+{
+	alloc_config = *config;
+	guard_set_sample_rate(config->sample_rate);
+	pressure_set_process_limit(config->process_limit);
+	slab_set_default_layout(config->meta_layout == SYN_META_OUT_OF_LINE);
+}
+
+
+void config_load()
+{
+	if (atomic_load_explicit(&config_state, memory_order_acquire) == CONFIG_READY) {
+		return;
+	}
+
+	u32 state = CONFIG_UNREAD;
+	if (!atomic_compare_exchange_strong_explicit(&config_state,
+	                                             &state,
+	                                             CONFIG_LOADING,
+	                                             memory_order_acquire,
+	                                             memory_order_acquire)) {
+		// Another thread is reading it, every setting has to be in before the first arena.
+		while (atomic_load_explicit(&config_state, memory_order_acquire) != CONFIG_READY) {
+			__builtin_ia32_pause();
+		}
+		return;
+	}
+
+	config_notes_t notes = {};
+	syn_config_t config = config_default();
+	config_parse_env(&config, &notes);
+	config_store(&config);
+
+	atomic_store_explicit(&config_state, CONFIG_READY, memory_order_release);
+	config_report(&notes);
+}
+
+
+void config_override_begin()
+{
+	config_load();
+}
+
+
+syn_config_t syn_default_config()
+{
+	return config_default();
+}
+
+
+int syn_configure(const syn_config_t *config)
+{
+	if (config == nullptr || config_validate(config) != 0) {
+		sync_alloc_log.to_console(log_stderr, "syn_configure() called with an invalid config!\n");
+		return 1;
+	}
+
+	// A load in progress on another thread has to finish first, or it would overwrite this one.
+	u32 state = atomic_load_explicit(&config_state, memory_order_acquire);
+	while (state == CONFIG_LOADING ||
+	       !atomic_compare_exchange_weak_explicit(&config_state,
+	                                              &state,
+	                                              CONFIG_LOADING,
+	                                              memory_order_acquire,
+	                                              memory_order_acquire)) {
+		if (state == CONFIG_LOADING) {
+			__builtin_ia32_pause();
+			state = atomic_load_explicit(&config_state, memory_order_acquire);
+		}
+	}
+
+	config_notes_t notes = {};
+	syn_config_t merged = *config;
+	config_parse_env(&merged, &notes);
+	config_store(&merged);
+
+	atomic_store_explicit(&config_state, CONFIG_READY, memory_order_release);
+	config_report(&notes);
+	return 0;
+}
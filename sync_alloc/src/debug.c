@@ -5,7 +5,6 @@
 
 #include "debug.h"
 #include "globals.h"
-#include "handle.h"
 #include "structs.h"
 #include "types.h"
 #include <stdarg.h>
@@ -13,7 +12,11 @@
 #include <stdio.h>
 #include <string.h>
 
-extern _Thread_local arena_t *restrict arena_thread;
+#ifndef SYN_USE_RAW
+#include "handle.h"
+#endif
+
+extern _Thread_local arena_t *arena_thread;
 
 
 inline void log_stdout(const char *string, va_list arg_list)
@@ -69,8 +72,6 @@ void debug_print_memory_usage()
 	const pool_header_t *header = arena_thread->first_mempool->offset != 0
 	                                      ? (pool_header_t *)arena_thread->first_mempool->mem
 	                                      : nullptr;
-	const handle_table_t *handle_table = arena_thread->first_hdl_tbl;
-
 	u64 pool_count = 0;
 	u64 free_headers = 0;
 	u64 total_pool_mem = arena_thread->total_arena_bytes;
@@ -85,18 +86,20 @@ void debug_print_memory_usage()
 	sync_alloc_log.to_console(log_stdout, "Total amount of pools: %lu\n", pool_count);
 	sync_alloc_log.to_console(log_stdout, "Pool memory (B): %lu\n", total_pool_mem);
 
+	sync_alloc_log.to_console(log_stdout, "Total count of free headers: %lu\n", free_headers);
+
+	#ifndef SYN_USE_RAW
+	const handle_table_t *handle_table = arena_thread->first_hdl_tbl;
 	u64 handle_count = 0;
 	u32 table_count = 0;
 
-	if (handle_table != nullptr) {
-		do {
-			const u32 curr_hdl_count = stdc_count_ones(handle_table->entries_bitmap);
-			if (curr_hdl_count != 0) {
-				handle_count += (u64)curr_hdl_count;
-			}
-			handle_table = handle_table->next_table;
-			table_count++;
-		} while (handle_table->next_table != nullptr);
+	while (handle_table != nullptr) {
+		const u32 curr_hdl_count = stdc_count_ones(handle_table->entries_bitmap);
+		if (curr_hdl_count != 0) {
+			handle_count += (u64)curr_hdl_count;
+		}
+		handle_table = handle_table->next_table;
+		table_count++;
 	}
 
 	if (table_count != arena_thread->table_count) {
@@ -107,7 +110,7 @@ void debug_print_memory_usage()
 		                          table_count);
 	}
 
-	const u64 handle_bytes = handle_count * STRUCT_SIZE_HANDLE;
+	const u64 handle_bytes = handle_count * STRUCT_SIZE_HANDLE_ENTRY;
 	const u64 reserved_mem = handle_bytes + (pool_count * STRUCT_SIZE_POOL) + STRUCT_SIZE_ARENA;
 
 	//sync_alloc_log.to_console(log_stdout, "Struct memory of: headers: %lu\n", header_bytes);
@@ -122,8 +125,8 @@ void debug_print_memory_usage()
 	sync_alloc_log.to_console(log_stdout,
 	                          "Total memory used: %lu\n",
 	                          total_pool_mem + reserved_mem);
-	sync_alloc_log.to_console(log_stdout, "Total count of free headers: %lu\n", free_headers);
 	sync_alloc_log.to_console(log_stdout, "Total count of handle tables: %u\n", table_count);
+	#endif
 }
 
 // clang-format off
@@ -12,17 +12,6 @@
 //static constexpr u32 MAX_ADDED_CHUNK_SIZE = (ALIGNMENT + (DEADZONE_PADDING * 2));
 
 
-static inline pool_free_node_t *index_free_list_end(pool_free_node_t *first_node,
-                                                    const u32 max_index)
-{
-	pool_free_node_t *node = first_node;
-	for (int i = 0; i < max_index - 1; i++) {
-		node = node->next_node;
-	}
-	return node;
-}
-
-
 static bool node_has_equal_size(const pool_free_node_t *node_current, const u32 allocation_size)
 {
 	const u32 pad_chunk_size =
@@ -40,66 +29,32 @@ static bool node_has_equal_size(const pool_free_node_t *node_current, const u32
 static pool_free_node_t *
 index_free_list_size(pool_free_node_t **first_node, const u32 max_index, const u32 allocation_size)
 {
-	// holy moly if statements
-	pool_free_node_t *node_current = *first_node;
-	pool_free_node_t *node_next = nullptr;
-	pool_free_node_t *node_prev = nullptr;
-
-	if (node_has_equal_size(node_current, allocation_size)) {
-		if (node_current->next_node) {
-			node_next = node_current->next_node;
-		}
-		goto found;
-	}
-
-	for (int idx = 0; idx < max_index - 1; idx++) {
-		if (node_current->next_node) {
-			node_next = node_current->next_node;
-		}
+	// Walking the link fields instead of the nodes means unlinking never has to
+	// special-case the first node of the list.
+	pool_free_node_t **link = first_node;
 
+	for (u32 idx = 0; idx < max_index && *link != nullptr; idx++) {
+		pool_free_node_t *node_current = *link;
 		if (node_has_equal_size(node_current, allocation_size)) {
-			goto found;
+			// TODO block splitting
+			*link = node_current->next_node;
+			node_current->next_node = nullptr;
+			return node_current;
 		}
-
-		node_prev = node_current;
-		node_current = node_current->next_node;
-	}
-	if (!node_has_equal_size(node_current, allocation_size)) {
-		return nullptr;
+		link = &node_current->next_node;
 	}
-found:
-	// TODO block splitting
-	if (node_next == node_current) {
-		node_next = nullptr;
-	}
-
-	if (node_next && node_prev) {
-		node_prev->next_node = node_next;
-	} else if (node_next) {
-		*first_node = node_next;
-	} else if (node_prev) {
-		node_prev->next_node = nullptr;
-	} else {
-		*first_node = nullptr;
-	}
-
-	return node_current;
+	return nullptr;
 }
 
 
 int free_node_add(pool_free_node_t *free_node)
 {
 	memory_pool_t *pool = return_pool((pool_header_t *)free_node);
-	if (pool->first_free == nullptr) {
-		pool->first_free = free_node;
-		goto done;
-	}
-	// for now we just add new frees to the end. Might not be temporary.
-
-	pool_free_node_t *node = index_free_list_end(pool->first_free, pool->free_count);
 
-	node->next_node = free_node;
-done:
+	/* New frees are pushed to the front, the most recently freed block is the most	*
+	 * likely to still be in cache, and appending meant walking the entire list.	*/
+	free_node->next_node = pool->first_free;
+	pool->first_free = free_node;
 	pool->free_count++;
 	return 0;
 }
@@ -0,0 +1,128 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#include "growbuf.h"
+#include "alloc_utils.h"
+#include "defs.h"
+#include "globals.h"
+#include "structs.h"
+#include "types.h"
+#include <stdint.h>
+#include <sys/mman.h>
+
+
+/// Makes the reservation readable and writable from old_end up to new_end, both page aligned.
+static int growbuf_protect(growbuf_t *buf, const usize old_end, const usize new_end)
+{
+	return mprotect((char *)buf + old_end, new_end - old_end, PROT_READ | PROT_WRITE);
+}
+
+
+pool_header_t *growbuf_alloc(const usize max_bytes)
+{
+	if (max_bytes == 0 || max_bytes > GROWBUF_MAX_SIZE) {
+		return nullptr;
+	}
+	const usize map_size = ALIGN_PTR(GROWBUF_PAYLOAD_OFFSET + max_bytes, 4 * KIBIBYTE);
+
+	growbuf_t *buf = mmap(nullptr, map_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (buf == MAP_FAILED) {
+		return nullptr;
+	}
+	// The first page holds the struct and the header, so it is always committed.
+	if (growbuf_protect(buf, 0, 4 * KIBIBYTE) != 0) {
+		munmap(buf, map_size);
+		return nullptr;
+	}
+
+	buf->arena = arena_thread;
+	buf->prev_buf = nullptr;
+	buf->next_buf = arena_thread->growbufs;
+	buf->map_size = map_size;
+	if (buf->next_buf != nullptr) {
+		buf->next_buf->prev_buf = buf;
+	}
+	arena_thread->growbufs = buf;
+
+	pool_header_t *head = (pool_header_t *)((char *)buf + GROWBUF_PAYLOAD_OFFSET - STRUCT_SIZE_HEADER);
+	head->allocation_size = (4 * KIBIBYTE) - GROWBUF_PAYLOAD_OFFSET;
+	head->chunk_size = STRUCT_SIZE_HEADER + head->allocation_size;
+	#ifndef SYN_USE_RAW
+	head->handle_matrix_index = 0;
+	#else
+	head->magic = RAW_HEADER_MAGIC;
+	#endif
+	// Pages come in zeroed the first time they are committed.
+	head->bitflags = (F_ALLOCATED | F_GROWBUF | F_ZEROED);
+	return head;
+}
+
+
+int growbuf_commit(pool_header_t *head, const usize size)
+{
+	if (size <= head->allocation_size) {
+		return 0;
+	}
+	growbuf_t *buf = growbuf_of(head);
+	if (size > buf->map_size - GROWBUF_PAYLOAD_OFFSET) {
+		return 1;
+	}
+
+	const usize wanted = (size > (usize)head->allocation_size * 2) ? size : (usize)head->allocation_size * 2;
+	const usize old_end = GROWBUF_PAYLOAD_OFFSET + head->allocation_size;
+	usize new_end = ALIGN_PTR(GROWBUF_PAYLOAD_OFFSET + wanted, 4 * KIBIBYTE);
+	if (new_end > buf->map_size) {
+		new_end = buf->map_size;
+	}
+	if (growbuf_protect(buf, old_end, new_end) != 0) {
+		return 1;
+	}
+
+	head->allocation_size = (u32)(new_end - GROWBUF_PAYLOAD_OFFSET);
+	head->chunk_size = STRUCT_SIZE_HEADER + head->allocation_size;
+	return 0;
+}
+
+
+void growbuf_free(pool_header_t *head)
+{
+	growbuf_t *buf = growbuf_of(head);
+
+	if (buf->prev_buf != nullptr) {
+		buf->prev_buf->next_buf = buf->next_buf;
+	} else {
+		buf->arena->growbufs = buf->next_buf;
+	}
+	if (buf->next_buf != nullptr) {
+		buf->next_buf->prev_buf = buf->prev_buf;
+	}
+	// Unmapping drops the pages, so sensitive buffers need no quarantine either.
+	#ifndef SYN_USE_RAW
+	if (buf->map_size > 4 * KIBIBYTE) {
+		munmap((char *)buf + (4 * KIBIBYTE), buf->map_size - (4 * KIBIBYTE));
+	}
+	tombstone_keep(buf->arena, buf, 4 * KIBIBYTE);
+	#else
+	munmap(buf, buf->map_size);
+	#endif
+}
+
+
+arena_t *growbuf_owner(const pool_header_t *head)
+{
+	return growbuf_of(head)->arena;
+}
+
+
+void growbuf_release_arena(arena_t *arena)
+{
+	growbuf_t *buf = arena->growbufs;
+	arena->growbufs = nullptr;
+
+	while (buf != nullptr) {
+		growbuf_t *next_buf = buf->next_buf;
+		munmap(buf, buf->map_size);
+		buf = next_buf;
+	}
+}
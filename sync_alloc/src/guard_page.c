@@ -0,0 +1,249 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#include "guard_page.h"
+#include "alloc_utils.h"
+#include "defs.h"
+#include "globals.h"
+#include "structs.h"
+#include "types.h"
+#include <stdatomic.h>
+#include <stdbit.h>
+#include <stdint.h>
+#include <sys/mman.h>
+
+typedef struct Guard_Slot {
+	pool_header_t *header;	/**< Header of the block in the slot, NULL when free.	*/
+	arena_t *arena;		/**< Arena that allocated the block.			*/
+} guard_slot_t;
+
+/* While sampling is off, threads only look at the rate again after this many allocations. */
+static constexpr u32 GUARD_DISABLED_RECHECK = 65536;
+
+_Atomic(uintptr_t) guard_region = 0;
+_Thread_local u32 guard_countdown = 0;
+
+static _Thread_local u64 guard_seed = 0;
+static _Atomic u32 guard_rate = GUARD_SAMPLE_RATE;
+static _Atomic u64 guard_used = 0;
+static _Atomic u32 guard_cursor = 0;
+
+/* Slot metadata lives outside the region, so a freed slot can be validated without faulting.	*
+ * It is published by the release on guard_used and read after an acquire of it.		*/
+static guard_slot_t guard_slots[GUARD_SLOT_COUNT];
+
+
+static inline u32 guard_slot_index(const void *ptr)
+{
+	const uintptr_t region = atomic_load_explicit(&guard_region, memory_order_relaxed);
+	return (u32)(((uintptr_t)ptr - region) / GUARD_PAGE_SIZE / 2);
+}
+
+
+static inline void *guard_slot_page(const uintptr_t region, const u32 slot)
+{
+	return (void *)(region + ((usize)GUARD_PAGE_SIZE * ((slot * 2) + 1)));
+}
+
+
+[[gnu::cold]]
+static uintptr_t guard_region_init()
+{
+	void *mem = mmap(nullptr,
+	                 GUARD_REGION_SIZE,
+	                 PROT_NONE,
+	                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+	                 -1,
+	                 0);
+	if (mem == MAP_FAILED) {
+		return 0;
+	}
+
+	uintptr_t region = 0;
+	if (!atomic_compare_exchange_strong_explicit(&guard_region,
+	                                             &region,
+	                                             (uintptr_t)mem,
+	                                             memory_order_acq_rel,
+	                                             memory_order_acquire)) {
+		// Another thread mapped the region first.
+		munmap(mem, GUARD_REGION_SIZE);
+		return region;
+	}
+	return (uintptr_t)mem;
+}
+
+
+/// Picks the distance to the next sample uniformly from [1, 2 * rate], so sampled
+/// allocations do not line up with a fixed allocation pattern.
+static u32 guard_next_countdown(const u32 rate)
+{
+	u64 seed = guard_seed;
+	if (seed == 0) {
+		seed = ((uintptr_t)&guard_seed ^ __builtin_ia32_rdtsc()) | 1;
+	}
+	seed ^= seed << 13;
+	seed ^= seed >> 7;
+	seed ^= seed << 17;
+	guard_seed = seed;
+
+	return (u32)(seed % ((u64)rate * 2)) + 1;
+}
+
+
+bool guard_sample_slow()
+{
+	const u32 rate = atomic_load_explicit(&guard_rate, memory_order_relaxed);
+	if (rate == 0) {
+		guard_countdown = GUARD_DISABLED_RECHECK;
+		return false;
+	}
+
+	// A zero countdown means this thread has not armed it yet, so the first call never samples.
+	const bool armed = (guard_countdown != 0);
+	guard_countdown = guard_next_countdown(rate);
+	return armed;
+}
+
+
+static u32 guard_claim_slot()
+{
+	const u32 start = atomic_fetch_add_explicit(&guard_cursor, 1, memory_order_relaxed) %
+	                  GUARD_SLOT_COUNT;
+	u64 used = atomic_load_explicit(&guard_used, memory_order_relaxed);
+
+	for (;;) {
+		const u64 free_slots = ~used;
+		if (free_slots == 0) {
+			return UINT32_MAX;
+		}
+		// Rotate so the search starts at the cursor, the longest-resting slots come first.
+		const u64 rotated =
+			(free_slots >> start) | (free_slots << ((GUARD_SLOT_COUNT - start) % GUARD_SLOT_COUNT));
+		const u32 slot = (start + stdc_trailing_zeros_ull(rotated)) % GUARD_SLOT_COUNT;
+
+		if (atomic_compare_exchange_weak_explicit(&guard_used,
+		                                          &used,
+		                                          used | (1ULL << slot),
+		                                          memory_order_acquire,
+		                                          memory_order_relaxed)) {
+			return slot;
+		}
+	}
+}
+
+
+static inline void guard_release_slot(const u32 slot)
+{
+	atomic_fetch_and_explicit(&guard_used, ~(1ULL << slot), memory_order_release);
+}
+
+
+pool_header_t *guard_alloc(const u32 size, const u32 align)
+{
+	if ((u64)size + STRUCT_SIZE_HEADER > GUARD_PAGE_SIZE) {
+		return nullptr;
+	}
+	uintptr_t region = atomic_load_explicit(&guard_region, memory_order_acquire);
+	if (region == 0 && (region = guard_region_init()) == 0) {
+		return nullptr;
+	}
+
+	const u32 slot = guard_claim_slot();
+	if (slot == UINT32_MAX) {
+		return nullptr;
+	}
+	void *slot_page = guard_slot_page(region, slot);
+
+	// Right-align the payload, so the first byte past it is the trailing guard page.
+	const uintptr_t slot_end = (uintptr_t)slot_page + GUARD_PAGE_SIZE;
+	const uintptr_t payload = (slot_end - size) & ~((uintptr_t)align - 1);
+	if (payload < (uintptr_t)slot_page + STRUCT_SIZE_HEADER) {
+		guard_release_slot(slot);
+		return nullptr;
+	}
+	if (mprotect(slot_page, GUARD_PAGE_SIZE, PROT_READ | PROT_WRITE) != 0) {
+		guard_release_slot(slot);
+		return nullptr;
+	}
+
+	pool_header_t *head = slot_page;
+	head->allocation_size = size;
+	head->chunk_size = STRUCT_SIZE_HEADER + (u32)(slot_end - payload);
+	#ifndef SYN_USE_RAW
+	head->handle_matrix_index = 0;
+	#else
+	head->magic = RAW_HEADER_MAGIC;
+	#endif
+	// The page was dropped when the slot was last freed, so it always comes back zeroed.
+	head->bitflags = (F_ALLOCATED | F_GUARDED | F_ZEROED);
+
+	guard_slots[slot].header = head;
+	guard_slots[slot].arena = arena_thread;
+	return head;
+}
+
+
+void guard_free(pool_header_t *head)
+{
+	const uintptr_t region = atomic_load_explicit(&guard_region, memory_order_relaxed);
+	const u32 slot = guard_slot_index(head);
+	void *slot_page = guard_slot_page(region, slot);
+
+	guard_slots[slot].header = nullptr;
+	guard_slots[slot].arena = nullptr;
+
+	/* Protecting the page makes every later access fault, and dropping it	*
+	 * scrubs the contents, so sensitive blocks need no quarantine here.	*/
+	mprotect(slot_page, GUARD_PAGE_SIZE, PROT_NONE);
+	madvise(slot_page, GUARD_PAGE_SIZE, MADV_DONTNEED);
+	guard_release_slot(slot);
+}
+
+
+int guard_check(const pool_header_t *head)
+{
+	const uintptr_t region = atomic_load_explicit(&guard_region, memory_order_relaxed);
+	const uintptr_t page = ((uintptr_t)head - region) / GUARD_PAGE_SIZE;
+
+	// Even pages are the guards themselves.
+	if ((page % 2) == 0) {
+		return 1;
+	}
+	const u32 slot = (u32)(page / 2);
+	const u64 used = atomic_load_explicit(&guard_used, memory_order_acquire);
+
+	if (!(used & (1ULL << slot)) || guard_slots[slot].header != head) {
+		return 1;
+	}
+	return 0;
+}
+
+
+arena_t *guard_owner(const pool_header_t *head)
+{
+	return guard_slots[guard_slot_index(head)].arena;
+}
+
+
+void guard_release_arena(const arena_t *arena)
+{
+	if (atomic_load_explicit(&guard_region, memory_order_relaxed) == 0) {
+		return;
+	}
+	const u64 used = atomic_load_explicit(&guard_used, memory_order_acquire);
+
+	for (u32 slot = 0; slot < GUARD_SLOT_COUNT; slot++) {
+		if ((used & (1ULL << slot)) && guard_slots[slot].arena == arena) {
+			guard_free(guard_slots[slot].header);
+		}
+	}
+}
+
+
+void guard_set_sample_rate(const u32 rate)
+{
+	atomic_store_explicit(&guard_rate, rate, memory_order_relaxed);
+	// The calling thread re-arms at once, the others pick the rate up when their countdown runs out.
+	guard_countdown = (rate == 0) ? GUARD_DISABLED_RECHECK : guard_next_countdown(rate);
+}
@@ -7,44 +7,97 @@
 #include "debug.h"
 #include "defs.h"
 #include "globals.h"
-#include "handle.h"
+#include "persist.h"
 #include "structs.h"
+#include "trace.h"
 #include "types.h"
 #include <stdbit.h>
 
+// Raw mode has no handles, so none of this is built for it.
+#ifndef SYN_USE_RAW
+#include "handle.h"
+
 
 inline bool handle_generation_checksum(const syn_handle_t *restrict hdl)
 {
-	return ((return_handle(hdl->header->handle_matrix_index))->generation == hdl->generation);
+	const handle_entry_t *entry = return_live_entry(hdl->header->handle_matrix_index);
+	return entry != nullptr && entry->header == hdl->header && entry->generation == hdl->generation;
 }
 
 
 inline void update_table_generation(const u32 encoded_matrix_index)
 {
-	(return_handle(encoded_matrix_index))->generation++;
+	(return_entry(encoded_matrix_index))->generation++;
 }
 
 
 void table_destructor()
 {
-	handle_table_t *table_arr[arena_thread->table_count];
-	const int table_arr_len = return_table_array(table_arr);
+	table_slab_t *slab = arena_thread->table_slab;
 
-	if (table_arr_len == -1) {
-		return;
+	// A file-backed arena's zone is part of the file, it is only emptied.
+	if (arena_thread->persist != nullptr) {
+		slab = nullptr;
 	}
-
-	for (int i = 0; i < table_arr_len; i++) {
+	while (slab != nullptr) {
+		table_slab_t *prev_slab = slab->prev_slab;
 		#ifdef ALLOC_DEBUG
-		sync_alloc_log.to_console(log_stdout, "destroying table at: %p\n", table_arr[i]);
+		sync_alloc_log.to_console(log_stdout, "destroying table slab at: %p\n", slab);
 		#endif
-		syn_unmap_page(table_arr[i], STRUCT_SIZE_HANDLE_MATRIX);
+		region_cache_unmap(slab, slab->slab_size, slab->offset);
+		slab = prev_slab;
 	}
+	arena_thread->table_slab = nullptr;
 	arena_thread->table_count = 0;
+	arena_thread->hdl_high_water = 0;
 	arena_thread->first_hdl_tbl = nullptr;
 }
 
 
+/// Clears the masked entries of a table and bumps their generations, so copies of their handles go stale.
+static void table_drop_entries(handle_table_t *table, const u64 drop_mask)
+{
+	u64 dropped = table->entries_bitmap & drop_mask;
+	while (dropped != 0) {
+		const u32 col = stdc_trailing_zeros_ull(dropped);
+		const u32 generation = table->handle_entries[col].generation;
+		table->handle_entries[col].generation = (generation + 1 >= UINT32_MAX) ? 1 : generation + 1;
+		dropped &= dropped - 1;
+	}
+	table->entries_bitmap &= ~drop_mask;
+}
+
+
+void table_rewind(const u32 watermark)
+{
+	if (watermark >= arena_thread->hdl_high_water || arena_thread->first_hdl_tbl == nullptr) {
+		return;
+	}
+
+	u32 row = watermark / MAX_TABLE_HNDL_COLS;
+	const u32 col = watermark % MAX_TABLE_HNDL_COLS;
+
+	handle_table_t *table = arena_thread->first_hdl_tbl;
+	for (u32 i = 0; i < row && table != nullptr; i++) {
+		table = table->next_table;
+	}
+
+	// Entries below the watermark in its own table are kept, every table after it is only scope entries.
+	if (table != nullptr) {
+		table_drop_entries(table, ~((1ULL << col) - 1));
+		table = table->next_table;
+		row++;
+	}
+	while (table != nullptr && row * MAX_TABLE_HNDL_COLS < arena_thread->hdl_high_water) {
+		table_drop_entries(table, ~0ULL);
+		table = table->next_table;
+		row++;
+	}
+
+	arena_thread->hdl_high_water = watermark;
+}
+
+
 inline int return_table_array(handle_table_t **arr)
 {
 	if (arena_thread->table_count == 0 || arena_thread->first_hdl_tbl == nullptr) {
@@ -54,7 +107,7 @@ inline int return_table_array(handle_table_t **arr)
 	handle_table_t *tbl = arena_thread->first_hdl_tbl;
 
 	int idx = 0;
-	while (idx < arena_thread->pool_count && tbl != nullptr) {
+	while (idx < arena_thread->table_count && tbl != nullptr) {
 		arr[idx++] = tbl;
 		tbl = tbl->next_table;
 	}
@@ -63,7 +116,7 @@ inline int return_table_array(handle_table_t **arr)
 }
 
 
-inline syn_handle_t *return_handle(const u32 encoded_matrix_index)
+inline handle_entry_t *return_entry(const u32 encoded_matrix_index)
 {
 	const u32 row = encoded_matrix_index / MAX_TABLE_HNDL_COLS;
 	const u32 col = encoded_matrix_index % MAX_TABLE_HNDL_COLS;
@@ -78,9 +131,72 @@ inline syn_handle_t *return_handle(const u32 encoded_matrix_index)
 }
 
 
+handle_entry_t *return_live_entry(const u32 encoded_matrix_index)
+{
+	if (encoded_matrix_index >= arena_thread->hdl_high_water) {
+		return nullptr;
+	}
+	const u32 row = encoded_matrix_index / MAX_TABLE_HNDL_COLS;
+	const u32 col = encoded_matrix_index % MAX_TABLE_HNDL_COLS;
+
+	handle_table_t *table = arena_thread->first_hdl_tbl;
+	for (u32 i = 0; i < row && table != nullptr; i++) {
+		table = table->next_table;
+	}
+
+	if (table == nullptr || !(table->entries_bitmap & (1ULL << col))) {
+		return nullptr;
+	}
+	return &table->handle_entries[col];
+}
+
+
+/// Bumps a table out of the newest slab, mapping a slab twice its size once it is full.
+static handle_table_t *carve_table()
+{
+	table_slab_t *slab = arena_thread->table_slab;
+
+	if (slab == nullptr && arena_thread->persist != nullptr) {
+		slab = persist_table_zone(arena_thread->persist);
+		slab->prev_slab = nullptr;
+		slab->slab_size = (u32)arena_thread->persist->table_zone_size;
+		slab->offset = TABLE_SLAB_HEADER;
+		arena_thread->table_slab = slab;
+	}
+	if (slab == nullptr || slab->offset + TABLE_SLAB_STRIDE > slab->slab_size) {
+		// The table zone of a file-backed arena can not grow past the file.
+		if (arena_thread->persist != nullptr) {
+			return nullptr;
+		}
+		u32 slab_size = TABLE_SLAB_MIN_SIZE;
+		if (slab != nullptr && slab->slab_size < TABLE_SLAB_MAX_SIZE) {
+			slab_size = slab->slab_size * 2;
+		} else if (slab != nullptr) {
+			slab_size = TABLE_SLAB_MAX_SIZE;
+		}
+
+		// Tables never trust old entries, a cached slab is as good as a fresh one.
+		usize dirty_bytes;
+		table_slab_t *new_slab = region_cache_map(slab_size, &dirty_bytes);
+		if (!new_slab) {
+			return nullptr;
+		}
+		new_slab->prev_slab = slab;
+		new_slab->slab_size = slab_size;
+		new_slab->offset = TABLE_SLAB_HEADER;
+		arena_thread->table_slab = slab = new_slab;
+	}
+
+	handle_table_t *table = (handle_table_t *)((char *)slab + slab->offset);
+	slab->offset += TABLE_SLAB_STRIDE;
+
+	return table;
+}
+
+
 handle_table_t *new_handle_table()
 {
-	handle_table_t *new_tbl = syn_map_page(STRUCT_SIZE_HANDLE_MATRIX);
+	handle_table_t *new_tbl = carve_table();
 	if (!new_tbl) {
 		return nullptr;
 	}
@@ -100,6 +216,7 @@ handle_table_t *new_handle_table()
 	new_tbl->entries_bitmap = 0;
 	new_tbl->table_id = ++arena_thread->table_count;
 	new_tbl->next_table = nullptr;
+	SYN_TRACE(table_create, new_tbl->table_id, new_tbl, arena_thread);
 
 	return new_tbl;
 }
@@ -135,19 +252,41 @@ reloop:
 }
 
 
+/// Inside a scope, handles are bumped from the high water mark so popping can drop them by range.
+static handle_table_t *find_high_water_table()
+{
+	const u32 row = arena_thread->hdl_high_water / MAX_TABLE_HNDL_COLS;
+
+	while (row >= arena_thread->table_count) {
+		if (new_handle_table() == nullptr) {
+			return nullptr;
+		}
+	}
+
+	handle_table_t *table = arena_thread->first_hdl_tbl;
+	for (u32 i = 0; i < row; i++) {
+		table = table->next_table;
+	}
+	return table;
+}
+
+
 syn_handle_t create_handle_and_entry(pool_header_t *head)
 {
 	if (!arena_thread->table_count && !new_handle_table()) {
 		return invalid_block();
 	}
 
-	handle_table_t *table = find_non_empty_table();
+	const bool in_scope = (arena_thread->scope_depth != 0);
+	handle_table_t *table = in_scope ? find_high_water_table() : find_non_empty_table();
 
 	if (table == nullptr) {
 		return invalid_block();
 	}
 
-	i32 free_handle_column = stdc_first_trailing_zero_ull(table->entries_bitmap);
+	i32 free_handle_column = in_scope
+	                                 ? (i32)(arena_thread->hdl_high_water % MAX_TABLE_HNDL_COLS) + 1
+	                                 : (i32)stdc_first_trailing_zero_ull(table->entries_bitmap);
 
 	if (free_handle_column == 0) {
 		return invalid_block();
@@ -156,19 +295,27 @@ syn_handle_t create_handle_and_entry(pool_header_t *head)
 	free_handle_column--;
 	table->entries_bitmap |= (1ULL << free_handle_column);
 
+	/* Carry on from the entry's last generation instead of restarting at 1,	*
+	 * so stale copies of whatever handle last used this entry stay stale.		*/
+	const u32 last_generation = table->handle_entries[free_handle_column].generation;
+
 	syn_handle_t new_hdl = {
-		new_hdl.addr = (void *)BLOCK_ALIGN_PTR(head, ALIGNMENT),
+		new_hdl.addr = return_block(head),
 		new_hdl.header = head,
-		new_hdl.generation = 1,
+		new_hdl.generation = (last_generation + 1 >= UINT32_MAX) ? 1 : last_generation + 1,
 	};
 
-	#ifndef SYN_USE_RAW
 	head->handle_matrix_index =
 		((table->table_id - 1) * MAX_TABLE_HNDL_COLS) + free_handle_column;
-	#endif
 
+	if (head->handle_matrix_index >= arena_thread->hdl_high_water) {
+		arena_thread->hdl_high_water = head->handle_matrix_index + 1;
+	}
 
-	table->handle_entries[free_handle_column] = new_hdl;
+	table->handle_entries[free_handle_column].header = head;
+	table->handle_entries[free_handle_column].generation = new_hdl.generation;
 
 	return new_hdl;
 }
+
+#endif
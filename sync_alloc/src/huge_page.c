@@ -2,4 +2,139 @@
 // Created by SyncShard on 11/15/25.
 //
 
-#include "huge_page.h"
\ No newline at end of file
+// mremap() is a GNU extension.
+#define _GNU_SOURCE
+
+#include "huge_page.h"
+#include "alloc_init.h"
+#include "alloc_utils.h"
+#include "deadzone.h"
+#include "defs.h"
+#include "globals.h"
+#include "internal_alloc.h"
+#include "pressure.h"
+#include "region_cache.h"
+#include "structs.h"
+#include "types.h"
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+
+
+#ifndef SYN_USE_RAW
+/**
+ * Resizes a pool's mapping, in place when it shrinks. To grow, everything but the pages up to the end of
+ * the block's header is moved into a fresh reservation. Those are copied instead and left behind as a
+ * tombstone, see tombstone_keep().
+ */
+static void *huge_move_mapping(const memory_pool_t *pool, const pool_header_t *head, const usize old_map, const usize new_map)
+{
+	char *old_base = pool->heap_base;
+	if (new_map <= old_map) {
+		return mremap(old_base, old_map, new_map, 0);
+	}
+	const usize kept_bytes = ALIGN_PTR((uintptr_t)head - (uintptr_t)old_base + STRUCT_SIZE_HEADER, 4 * KIBIBYTE);
+	if (kept_bytes >= old_map) {
+		return MAP_FAILED;
+	}
+	char *mem = mmap(nullptr, new_map, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (mem == MAP_FAILED) {
+		return MAP_FAILED;
+	}
+	if (mremap(old_base + kept_bytes, old_map - kept_bytes, old_map - kept_bytes, MREMAP_MAYMOVE | MREMAP_FIXED,
+	           mem + kept_bytes) == MAP_FAILED) {
+		munmap(mem, new_map);
+		return MAP_FAILED;
+	}
+	memcpy(mem, old_base, kept_bytes);
+	tombstone_keep(arena_thread, old_base, kept_bytes);
+	return mem;
+}
+#endif
+
+
+/// True if the block is the only one a pool ever carved, and the pool may move.
+static bool huge_owns_mapping(const pool_header_t *head, const memory_pool_t *pool)
+{
+	if (pool->pool_id == 0 || (void *)pool != pool->heap_base) {
+		return false;
+	}
+	return (void *)head == pool->mem && pool->free_count == 0 && pool->offset == head->chunk_size;
+}
+
+
+pool_header_t *huge_remap(pool_header_t *head, const usize size)
+{
+	if (size < HUGE_REMAP_MIN_SIZE || size >= MAX_POOL_SIZE) {
+		return nullptr;
+	}
+	if (head->bitflags & (F_GUARDED | F_SLAB_BLOCK | F_GROWBUF)) {
+		return nullptr;
+	}
+	if (arena_thread->scope_depth != 0 || arena_thread->persist != nullptr) {
+		return nullptr;
+	}
+
+	memory_pool_t *pool = return_pool(head);
+	if (!huge_owns_mapping(head, pool)) {
+		return nullptr;
+	}
+	memory_pool_t *prev_pool = arena_thread->first_mempool;
+	while (prev_pool != nullptr && prev_pool->next_pool != pool) {
+		prev_pool = prev_pool->next_pool;
+	}
+	if (prev_pool == nullptr) {
+		return nullptr;
+	}
+
+	// Same chunk layout as a block carved at offset 0, with room for the sentinel after it.
+	const usize reserved_bytes = (uintptr_t)pool->mem - (uintptr_t)pool->heap_base;
+	const u32 padded_size = ADD_ALIGNMENT_PADDING((u32)size);
+	const u32 chunk_size = ADD_ALIGNMENT_PADDING(padded_size + STRUCT_SIZE_HEADER + DEADZONE_PADDING);
+	const usize old_map = pool_mapped_bytes(pool);
+	const usize new_map = ALIGN_PTR(reserved_bytes + chunk_size + STRUCT_SIZE_HEADER, 4 * KIBIBYTE);
+	if (new_map > MAX_POOL_SIZE) {
+		return nullptr;
+	}
+	// Past a limit, the copying path gets to run pressure relief.
+	if (new_map > old_map && pressure_check(new_map - old_map) == PRESSURE_OVER) {
+		return nullptr;
+	}
+
+	#ifndef SYN_USE_RAW
+	void *mem = huge_move_mapping(pool, head, old_map, new_map);
+	#else
+	// Raw pointers are dead after a realloc, so the old range can go with the move.
+	void *mem = mremap(pool->heap_base, old_map, new_map, MREMAP_MAYMOVE);
+	#endif
+	if (mem == MAP_FAILED) {
+		return nullptr;
+	}
+
+	memory_pool_t *new_pool = mem;
+	new_pool->heap_base = mem;
+	new_pool->mem = (char *)mem + reserved_bytes;
+	new_pool->size = (u32)(new_map - reserved_bytes);
+	create_pool_deadzone(new_pool);
+	prev_pool->next_pool = new_pool;
+	arena_thread->total_arena_bytes = arena_thread->total_arena_bytes - old_map + new_map;
+	region_cache_account(old_map, new_map);
+
+	pool_header_t *new_head = new_pool->mem;
+	new_head->allocation_size = padded_size;
+	new_head->chunk_size = chunk_size;
+	new_head->bitflags &= ~(F_SENTINEL | F_ZEROED);
+	create_head_deadzone(new_head, new_pool);
+	pool_rewind(new_pool, chunk_size);
+
+	// Pages past the old mapping come in zeroed, everything up to the sentinel has been written.
+	const u32 written = (chunk_size + STRUCT_SIZE_HEADER < new_pool->size) ? chunk_size + STRUCT_SIZE_HEADER
+	                                                                     : new_pool->size;
+	if (new_pool->untouched > new_pool->size) {
+		new_pool->untouched = new_pool->size;
+	}
+	if (new_pool->untouched < written) {
+		new_pool->untouched = written;
+	}
+	return new_head;
+}
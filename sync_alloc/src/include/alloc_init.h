@@ -25,10 +25,21 @@ extern void *syn_map_page(usize bytes);
 
 
 /// @brief Creates a new arena in thread-local storage. Each thread must create its own arena.
+/// @param first_pool_size Bytes to map for the first pool, 0 for the configured first_pool_size.
+/// Rounded up to a whole page.
 /// @return 0 on success, -1 on failure.
 ///
+/// @note Explicit arenas are made the same way, with arena_thread swapped out around the call.
 /// @warning The arena ptr in TLS will be a nullptr if there is not enough memory.
-extern int arena_init();
+extern int arena_init(usize first_pool_size);
+
+/// @brief Lays an arena and its first pool out in memory that is already mapped, and makes it arena_thread.
+/// @param raw_pool The mapping, the arena struct is placed at its start.
+/// @param map_size Size of the mapping.
+/// @param dirty_bytes How many leading bytes of the mapping may hold old data.
+///
+/// @note No handle table is made, the first allocation makes one if the caller does not.
+extern void arena_setup(void *raw_pool, usize map_size, usize dirty_bytes);
 
 /// @brief Creates a new memory pool.
 ///	@param size How many bytes to give to the new pool.
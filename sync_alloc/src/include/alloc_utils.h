@@ -5,9 +5,16 @@
 #ifndef ARENA_ALLOCATOR_ALLOC_UTILS_H
 #define ARENA_ALLOCATOR_ALLOC_UTILS_H
 
+#include "defs.h"
+#include "globals.h"
+#include "guard_page.h"
+#include "region_cache.h"
+#include "slab.h"
 #include "structs.h"
 #include "sync_alloc.h"
+#include <stdbit.h>
 #include <stdint.h>
+#include <sys/mman.h>
 
 extern _Thread_local arena_t *arena_thread;
 
@@ -19,7 +26,15 @@ static inline void *invalid_block()
 	return nullptr;
 }
 
-extern int bad_alloc_check(const void *, const int do_checksum);
+/**
+ * Validates a raw block ptr before the allocator touches its header.
+ *
+ * @param block_ptr The user's block ptr.
+ * @param do_checksum Also verify the header's magic constant.
+ * @return 0 if the block is valid, -1 for a NULL ptr, 1 if the ptr is not a live
+ * sync_alloc block, 2 if the block is frozen.
+ */
+extern int bad_alloc_check(const void *block_ptr, int do_checksum);
 #else
 static inline syn_handle_t invalid_block()
 {
@@ -34,13 +49,70 @@ static inline syn_handle_t invalid_block()
 
 extern int bad_alloc_check(const syn_handle_t *restrict hdl, int do_checksum);
 
+#endif
+
 [[gnu::pure]]
 extern memory_pool_t *return_pool(const pool_header_t *restrict header);
 
-#endif
+/// @brief Returns the arena that owns a block, guarded and slab blocks have no pool to ask.
+[[gnu::pure]]
+extern arena_t *return_arena(const pool_header_t *restrict header);
+
+/// @brief Returns how many bytes were mapped for a pool, including the reserved structs.
+[[maybe_unused, gnu::pure]]
+static inline usize pool_mapped_bytes(const memory_pool_t *pool)
+{
+	return (usize)pool->size + ((uintptr_t)pool->mem - (uintptr_t)pool->heap_base);
+}
+
+/**
+ * @brief Retires a pool's mapping into the region cache, the pool struct lives in it and is gone afterwards.
+ * @note Everything past the reserved structs and pool->untouched is still zeroed, which is all the cache needs to know.
+ * A pool that ever held a sensitive block drops its pages first, so the next owner maps in fresh zeroes.
+ */
+static inline void pool_unmap(const memory_pool_t *pool)
+{
+	const usize reserved_bytes = (uintptr_t)pool->mem - (uintptr_t)pool->heap_base;
+	const usize mapped_bytes = pool_mapped_bytes(pool);
+	if (pool->held_sensitive) {
+		void *heap_base = pool->heap_base;
+		madvise(heap_base, mapped_bytes, MADV_DONTNEED);
+		region_cache_unmap(heap_base, mapped_bytes, 0);
+		return;
+	}
+	region_cache_unmap(pool->heap_base, mapped_bytes, reserved_bytes + pool->untouched);
+}
 
 extern pool_header_t *return_header(void *block_ptr);
 
+/// @brief Returns how many pins a block holds, they are counted above the flag bits of its bitflags.
+[[gnu::pure]]
+static inline u32 return_pin_count(const pool_header_t *header)
+{
+	return header->bitflags >> PIN_COUNT_SHIFT;
+}
+
+/// @brief Returns the payload of a block, the inverse of return_header().
+[[gnu::hot]]
+static inline void *return_block(const pool_header_t *header)
+{
+	if (header->bitflags & (F_SLAB_BLOCK | F_GUARDED)) {
+		return (header->bitflags & F_SLAB_BLOCK) ? slab_block(header) : guard_block(header);
+	}
+	return (void *)BLOCK_ALIGN_PTR(header, ALIGNMENT);
+}
+
+/// @brief Returns the alignment a block has to keep when it moves, ALIGNMENT unless it was allocated over-aligned.
+[[gnu::pure]]
+static inline u32 return_block_align(const pool_header_t *header)
+{
+	if (!(header->bitflags & F_OVER_ALIGNED)) {
+		return ALIGNMENT;
+	}
+	// The payload sits on at least the boundary it was asked for, so its lowest set bit is enough.
+	return 1U << stdc_trailing_zeros_ull((uintptr_t)return_block(header) | MAX_ALLOC_ALIGN);
+}
+
 
 /**
  * Instead of walking the linked list of pools, this fills a VLA ptr array.
@@ -76,4 +148,21 @@ extern void update_sentinel_and_free_flags(pool_header_t *head);
 
 extern void pool_destructor();
 
+#ifndef SYN_USE_RAW
+/**
+ * Empties the first pages of a mapping that is going away, and keeps them mapped as a tombstone.
+ *
+ * @details A freed growbuf or a pool moved by huge_remap() would otherwise leave copies of its
+ * handles pointing at unmapped memory. The emptied header reads handle index 0, so those copies
+ * fail the generation check as stale instead of faulting. The caller unmaps the rest.
+ * @param arena The arena the mapping belonged to.
+ * @param base Start of the mapping, page aligned.
+ * @param kept_bytes Bytes up to the end of the last header in it, rounded up to a page.
+ */
+extern void tombstone_keep(arena_t *arena, void *base, usize kept_bytes);
+
+/// Unmaps every tombstone of an arena, for when it is reset or destroyed and every handle is dropped.
+extern void tombstone_release_arena(arena_t *arena);
+#endif
+
 #endif //ARENA_ALLOCATOR_ALLOC_UTILS_H
\ No newline at end of file
@@ -0,0 +1,34 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#ifndef ARENA_ALLOCATOR_CONFIG_H
+#define ARENA_ALLOCATOR_CONFIG_H
+
+#include "sync_alloc.h"
+#include "types.h"
+
+/**
+ * 	Process-wide runtime configuration.
+ *
+ *	@details Filled once, either by the first arena_init() from the compiled-in defaults and
+ *	SYN_ALLOC_CONF, or by syn_configure(). The hot paths read it as a plain struct, so it is
+ *	only meant to change before other threads allocate. The sampling rate and the layout also
+ *	live in their own atomics, so the setters for those stay safe at any time.
+ */
+extern syn_config_t alloc_config;
+
+/// Loads the configuration if nothing has yet, every later call is a single load.
+extern void config_load();
+
+/**
+ * 	Called by a setter before it overrides a single field of alloc_config.
+ *
+ *	@details Loads the configuration first, so the one read later by the first arena does not
+ *	undo the override.
+ */
+extern void config_override_begin();
+
+extern syn_config_t config_default();
+
+#endif //ARENA_ALLOCATOR_CONFIG_H
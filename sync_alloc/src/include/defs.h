@@ -53,11 +53,11 @@
 // ALIGNMENT is now frozen at 16. Some functions will now break without it being at 16.
 #define	ALIGNMENT 16
 
-#define SYN_ALLOC_HANDLE 1
-
-// raw ptr only is a wip, it is NOT done and will NOT work.
-#ifndef SYN_ALLOC_HANDLE
-	#define SYN_USE_RAW 1
+/* Handles are the default. Build with -DSYN_USE_RAW to get plain void ptrs instead,	*
+ * which is what the malloc-compatible preload shim uses. The define has to match	*
+ * between the library and anything including sync_alloc.h.				*/
+#ifndef SYN_USE_RAW
+	#define SYN_ALLOC_HANDLE 1
 #endif
 
 #define PADDING 8
@@ -77,10 +77,10 @@ static_assert(((ALIGNMENT & (ALIGNMENT - 1)) == 0 &&
 	(((x) + (ALIGNMENT - 1)) & (typeof(x))~(ALIGNMENT - 1))
 
 #define BLOCK_ALIGN_PTR(head, align) \
-	((((uintptr_t)(head) + STRUCT_SIZE_HEADER) + ((align) - 1)) & ~((align) - 1))
+	((((uintptr_t)(head) + STRUCT_SIZE_HEADER) + ((align) - 1)) & ~((uintptr_t)(align) - 1))
 
 #define ALIGN_PTR(ptr, align) \
-	((((uintptr_t)(ptr)) + ((align) - 1)) & ~((align) - 1))
+	((((uintptr_t)(ptr)) + ((align) - 1)) & ~((uintptr_t)(align) - 1))
 
 #define IS_ALIGNED(ptr, align) \
 	(((char *)(ptr) & ((align) - 1)) == 0)
@@ -18,7 +18,20 @@ constexpr u32 MAX_ALLOC_POOL_SIZE = KIBIBYTE * 128;
 constexpr u32 MAX_FIRST_POOL_SIZE = KIBIBYTE * 128;
 constexpr u32 MAX_POOL_SIZE = GIBIBYTE * 2;
 constexpr u32 MAX_TABLE_HNDL_COLS = 64;
+constexpr u32 TABLE_SLAB_MIN_SIZE = KIBIBYTE * 16;
+constexpr u32 TABLE_SLAB_MAX_SIZE = MEBIBYTE;
 constexpr u32 MAX_ALLOC_SLAB_SIZE = 256;
+constexpr u32 SLAB_CHUNK_SIZE = KIBIBYTE * 64;
+constexpr u32 SLAB_REGION_SIZE = GIBIBYTE;
+constexpr u32 SLAB_CHUNK_COUNT = SLAB_REGION_SIZE / SLAB_CHUNK_SIZE;
+constexpr u32 MAX_ALLOC_ALIGN = KIBIBYTE * 4;
+constexpr u32 QUARANTINE_BUDGET = KIBIBYTE * 256;
+constexpr u32 REGION_CACHE_BUDGET = MEBIBYTE * 64;
+constexpr u32 REGION_CACHE_BUCKETS = 20;
+constexpr u32 GUARD_PAGE_SIZE = KIBIBYTE * 4;
+constexpr u32 GUARD_SLOT_COUNT = 64;
+constexpr u32 GUARD_SAMPLE_RATE = 4096;
+constexpr u32 GUARD_REGION_SIZE = GUARD_PAGE_SIZE * ((GUARD_SLOT_COUNT * 2) + 1);
 constexpr u32 STRUCT_SIZE_ARENA = sizeof(arena_t);
 constexpr u32 STRUCT_SIZE_POOL = sizeof(memory_pool_t);
 constexpr u32 STRUCT_SIZE_HEADER = sizeof(pool_header_t);
@@ -27,10 +40,29 @@ constexpr u32 DEADZONE_SIZE = sizeof(pool_deadzone_t);
 constexpr u32 RESERVED_FIRST_POOL_SIZE =
 	((STRUCT_SIZE_ARENA + STRUCT_SIZE_POOL) + (ALIGNMENT - 1)) & ~(ALIGNMENT - 1);
 constexpr u32 DEADZONE_PADDING = sizeof(u64);
+constexpr u32 MIN_FREE_CHUNK =
+	ADD_ALIGNMENT_PADDING(ADD_ALIGNMENT_PADDING(MINIMUM_BLOCK_ALLOC) + STRUCT_SIZE_HEADER + DEADZONE_PADDING);
 constexpr u32 HEAD_DEADZONE = 0xDEADDEADU;
 constexpr u64 POOL_DEADZONE = 0xDEADDEADDEADDEADULL;
+constexpr u32 RAW_HEADER_MAGIC = 0x5A1C0DE5U;
+constexpr u32 RAW_REMOTE_MAGIC = 0x5A1CF4EEU;
+constexpr u64 PERSIST_MAGIC = 0x53594E4152454E41ULL;
+constexpr u32 PERSIST_VERSION = 1;
+constexpr u32 PERSIST_HEADER_SIZE = KIBIBYTE * 4;
+constexpr u32 PERSIST_MIN_SIZE = MEBIBYTE;
+constexpr u64 SNAPSHOT_MAGIC = 0x53594E534E415053ULL;
+constexpr u32 SNAPSHOT_VERSION = 1;
+constexpr u32 OBJPOOL_CHUNK_SIZE = KIBIBYTE * 256;
+constexpr u32 OBJPOOL_MAX_OBJ_SIZE = KIBIBYTE * 16;
+constexpr u32 HUGE_REMAP_MIN_SIZE = KIBIBYTE * 128;
+constexpr u32 GROWBUF_MAX_SIZE = GIBIBYTE * 2;
+constexpr u32 PRESSURE_NEAR_DIVISOR = 8;
+constexpr u32 PIN_COUNT_SHIFT = 17;
+constexpr u32 PIN_COUNT_MAX = 0x7FFFU;
 
 static_assert(sizeof(pool_deadzone_t) == sizeof(head_deadzone_t),
               "error: deadzone sizes do not match!\n");
+static_assert(SLAB_CLASS_COUNT == ((MAX_ALLOC_SLAB_SIZE - MINIMUM_BLOCK_ALLOC) / ALIGNMENT) + 1,
+              "error: slab size classes do not match the slab size range!\n");
 
 #endif //ARENA_ALLOCATOR_GLOBALS_H
@@ -0,0 +1,71 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#ifndef ARENA_ALLOCATOR_GROWBUF_H
+#define ARENA_ALLOCATOR_GROWBUF_H
+
+#include "globals.h"
+#include "structs.h"
+#include "types.h"
+
+// clang-format off
+
+/**
+ * 	Growable buffer that never moves.
+ *
+ *	@details A growbuf reserves its whole maximum size as PROT_NONE address space up front,
+ *	and only makes pages readable and writable as it is grown, so the payload keeps its
+ *	address for its whole life and growing it never copies. The mapping starts with this
+ *	struct, then the block's header, then the payload at GROWBUF_PAYLOAD_OFFSET.
+ *	@details The header is an ordinary pool_header_t marked F_GROWBUF, its allocation_size
+ *	is how much of the payload is committed, so the block is freed like any other one.
+ *	Every growbuf of an arena is linked into its list, so a reset or destroy releases them.
+ *
+ *	@note Writing past the committed bytes faults on the PROT_NONE pages behind them.
+ */
+typedef struct Grow_Buf {
+	struct Arena *arena;		/**< Arena that allocated the buffer.			*/
+	struct Grow_Buf *prev_buf;	/**< Previous growbuf of the arena.			*/
+	struct Grow_Buf *next_buf;	/**< Next growbuf of the arena.				*/
+	usize map_size;			/**< Size of the whole reservation, payload included.	*/
+} growbuf_t;
+
+// clang-format on
+
+static constexpr u32 GROWBUF_PAYLOAD_OFFSET = 64;
+static_assert(sizeof(growbuf_t) + STRUCT_SIZE_HEADER <= GROWBUF_PAYLOAD_OFFSET,
+              "error: growbuf_t and its header do not fit in front of the payload!\n");
+
+/// Returns the growbuf a header marked F_GROWBUF belongs to.
+static inline growbuf_t *growbuf_of(const pool_header_t *head)
+{
+	return (growbuf_t *)((char *)head + STRUCT_SIZE_HEADER - GROWBUF_PAYLOAD_OFFSET);
+}
+
+/**
+ * Reserves a growbuf for the calling thread's arena and commits its first bytes.
+ *
+ * @param max_bytes How large the payload may ever grow, at most GROWBUF_MAX_SIZE.
+ * @return The block's header, or NULL if the reservation fails.
+ */
+extern pool_header_t *growbuf_alloc(usize max_bytes);
+
+/**
+ * Commits pages until at least size bytes of the payload are usable.
+ * Commits at least double what it had, so a buffer grown a little at a time costs few syscalls.
+ *
+ * @return 0 on success, 1 if size is past the buffer's maximum or the pages can not be committed.
+ */
+extern int growbuf_commit(pool_header_t *head, usize size);
+
+/// Unlinks a growbuf from its arena and unmaps it, but for the tombstone of its first page in handle mode.
+extern void growbuf_free(pool_header_t *head);
+
+/// Returns the arena that allocated a growbuf.
+extern arena_t *growbuf_owner(const pool_header_t *head);
+
+/// Unmaps every growbuf an arena holds, for when the arena is reset or destroyed.
+extern void growbuf_release_arena(arena_t *arena);
+
+#endif //ARENA_ALLOCATOR_GROWBUF_H
@@ -0,0 +1,94 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#ifndef ARENA_ALLOCATOR_GUARD_PAGE_H
+#define ARENA_ALLOCATOR_GUARD_PAGE_H
+
+#include "globals.h"
+#include "structs.h"
+#include "types.h"
+#include <stdatomic.h>
+#include <stdint.h>
+
+/**
+ * 	Sampled guard-page slots, in the style of GWP-ASan.
+ *
+ *	@details About one in GUARD_SAMPLE_RATE allocations is served from its own page in a
+ *	process-wide region instead of a pool. Every slot page sits between two PROT_NONE pages,
+ *	and the payload is right-aligned against the next one, so an overflow faults on the first
+ *	byte past the block instead of waiting for the next deadzone check. The header is kept
+ *	out of line at the start of the page, so the payload needs no more alignment than its size.
+ *	@details A freed slot goes back to PROT_NONE, so a use-after-free faults as well. Slots are
+ *	handed out from a rotating cursor, so a freed slot rests as long as possible before reuse.
+ *
+ *	@note The region is shared by every thread and arena, slots are claimed from an atomic bitmap.
+ */
+
+extern _Atomic(uintptr_t) guard_region;
+extern _Thread_local u32 guard_countdown;
+
+/// Re-arms the sampling countdown, true if this allocation is the sampled one.
+extern bool guard_sample_slow();
+
+/// Counts down to the next sampled allocation, so the hot path is a single decrement.
+[[gnu::hot]]
+static inline bool guard_should_sample()
+{
+	if (guard_countdown > 1) {
+		guard_countdown--;
+		return false;
+	}
+	return guard_sample_slow();
+}
+
+/// True if the ptr lies anywhere in the guarded region, guard pages included.
+[[gnu::hot]]
+static inline bool guard_owns(const void *ptr)
+{
+	const uintptr_t region = atomic_load_explicit(&guard_region, memory_order_relaxed);
+	return region != 0 && ((uintptr_t)ptr - region) < GUARD_REGION_SIZE;
+}
+
+/// Returns the header of a guarded block, at the start of its slot page.
+[[gnu::hot]]
+static inline pool_header_t *guard_header(const void *block_ptr)
+{
+	return (pool_header_t *)((uintptr_t)block_ptr & ~((uintptr_t)GUARD_PAGE_SIZE - 1));
+}
+
+/// Returns the payload of a guarded block, chunk_size spans the header and everything up to the guard page.
+[[gnu::hot]]
+static inline void *guard_block(const pool_header_t *head)
+{
+	return (char *)head + GUARD_PAGE_SIZE + STRUCT_SIZE_HEADER - head->chunk_size;
+}
+
+/**
+ * Claims a slot and places a block right-aligned against its trailing guard page.
+ *
+ * @param size User-requested size, unpadded, so the first byte past it faults.
+ * @param align Payload alignment.
+ * @return The block's header, or NULL if the block does not fit a page or every slot is taken.
+ */
+extern pool_header_t *guard_alloc(u32 size, u32 align);
+
+/// Drops the slot's page and protects it again, so any later access faults.
+extern void guard_free(pool_header_t *head);
+
+/**
+ * Validates a header inside the guarded region without dereferencing it.
+ * @return 0 if it is the header of a live slot, 1 otherwise.
+ */
+extern int guard_check(const pool_header_t *head);
+
+/// Returns the arena that allocated a guarded block.
+extern arena_t *guard_owner(const pool_header_t *head);
+
+/// Frees every slot still held by an arena, for when the arena is reset or destroyed.
+extern void guard_release_arena(const arena_t *arena);
+
+/// Sets the sampling rate for every thread, 0 turns sampling off. The calling thread re-arms at once.
+extern void guard_set_sample_rate(u32 rate);
+
+#endif //ARENA_ALLOCATOR_GUARD_PAGE_H
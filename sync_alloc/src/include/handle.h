@@ -5,18 +5,22 @@
 #ifndef ARENA_ALLOCATOR_HANDLE_H
 #define ARENA_ALLOCATOR_HANDLE_H
 
+#include "alloc_utils.h"
 #include "defs.h"
 #include "globals.h"
 #include "structs.h"
 #include "sync_alloc.h"
 #include "types.h"
+#include <stdint.h>
 
 // clang-format off
 
 /**
  * @brief Handle generation checksum.
+ * @details Only the header's index is read, the entry must be live, point at the same header
+ * and carry the same generation, so a stale handle is caught before its block is trusted.
  * @param hdl The handle to verify
- * @return Returns true if they do not match, false if they don't.
+ * @return Returns true if the handle is live, false if it is stale or from another arena.
  */
 extern bool handle_generation_checksum(const syn_handle_t *restrict hdl);
 
@@ -25,9 +29,42 @@ extern void update_table_generation(u32 encoded_matrix_index);
 
 extern void table_destructor();
 
+/**
+ * Frees every handle entry at or above a flattened matrix index.
+ * Only used by scopes, which guarantee that every entry above the watermark was made inside them.
+ */
+extern void table_rewind(u32 watermark);
+
 extern int return_table_array(handle_table_t **arr);
 
-extern syn_handle_t *return_handle(u32 encoded_matrix_index);
+/**
+ * 	One handle table slot.
+ *
+ *	@details Only what can not be derived is stored, the block address always follows
+ *	from the header, so a full syn_handle_t is rebuilt with handle_from_entry().
+ */
+typedef struct Handle_Entry {
+	pool_header_t *header;	/**< Header of the entry's block.			*/
+	u32 generation;		/**< Generation every live handle to it must carry.	*/
+} handle_entry_t;
+
+extern handle_entry_t *return_entry(u32 encoded_matrix_index);
+
+/**
+ * Looks up an entry by flattened matrix index, for compact handles that only carry the index.
+ * @return The entry, or NULL if the index is out of range or the entry is not allocated.
+ */
+extern handle_entry_t *return_live_entry(u32 encoded_matrix_index);
+
+static inline syn_handle_t handle_from_entry(const handle_entry_t *entry)
+{
+	const syn_handle_t hdl = {
+		.addr = return_block(entry->header),
+		.header = entry->header,
+		.generation = entry->generation,
+	};
+	return hdl;
+}
 
 /**
  * 	Table of user allocations.
@@ -48,9 +85,23 @@ typedef struct Handle_Table {
 	struct Handle_Table *next_table;	/**< Pointer to the next table.				*/
 	bit64 entries_bitmap;			/**< Bitmap of used and free handles			*/
 	u32 table_id;				/**< The index of the current table.			*/
-	syn_handle_t handle_entries[];		/**< array of entries via FAM. index via entries bit.	*/
+	handle_entry_t handle_entries[];	/**< array of entries via FAM. index via entries bit.	*/
 } handle_table_t;
 
+/**
+ * 	Mapping that handle tables are carved from.
+ *
+ *	@details Tables are bumped out of a slab one after another and are never given back on
+ *	their own, a slab is only unmapped as a whole by table_destructor(). Each new slab is twice
+ *	the size of the last, up to TABLE_SLAB_MAX_SIZE, so the mmap count grows logarithmically
+ *	with the table count until the cap and linearly in 1 MiB steps after it.
+ */
+typedef struct Table_Slab {
+	struct Table_Slab *prev_slab;	/**< The slab mapped before this one.			*/
+	u32 slab_size;			/**< Mapped size of the slab, header included.		*/
+	u32 offset;			/**< Offset of the next table to carve.			*/
+} table_slab_t;
+
 // clang-format on
 
 /// @brief Creates a new handle table. Does not increment table_count by itself, do that before calling.
@@ -64,9 +115,12 @@ extern handle_table_t *new_handle_table();
 /// @return a _hopefully_ valid Arena Handle. handle->addr will be NULL if it fails.
 extern syn_handle_t create_handle_and_entry(pool_header_t *head);
 
-static constexpr u32 STRUCT_SIZE_HANDLE = sizeof(syn_handle_t);
+static constexpr u32 STRUCT_SIZE_HANDLE_ENTRY = sizeof(handle_entry_t);
 static constexpr u32 STRUCT_SIZE_HANDLE_TABLE = sizeof(handle_table_t);
 static constexpr u32 STRUCT_SIZE_HANDLE_MATRIX =
-	(STRUCT_SIZE_HANDLE * MAX_TABLE_HNDL_COLS) + STRUCT_SIZE_HANDLE_TABLE;
+	(STRUCT_SIZE_HANDLE_ENTRY * MAX_TABLE_HNDL_COLS) + STRUCT_SIZE_HANDLE_TABLE;
+/// Tables are carved on cache line boundaries so the bitmap of one never shares a line with the entries of another.
+static constexpr u32 TABLE_SLAB_STRIDE = (STRUCT_SIZE_HANDLE_MATRIX + 63) & ~63U;
+static constexpr u32 TABLE_SLAB_HEADER = (sizeof(table_slab_t) + 63) & ~63U;
 
 #endif //ARENA_ALLOCATOR_HANDLE_H
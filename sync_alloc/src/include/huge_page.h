@@ -5,4 +5,25 @@
 #ifndef ARENA_ALLOCATOR_HUGE_PAGE_H
 #define ARENA_ALLOCATOR_HUGE_PAGE_H
 
-#endif //ARENA_ALLOCATOR_HUGE_PAGE_H
\ No newline at end of file
+#include "structs.h"
+#include "types.h"
+
+/**
+ * Resizes a block that is alone in a pool of its own by resizing the pool's mapping with mremap().
+ *
+ * @details The kernel moves the page-table entries instead of the bytes, so growing a block of
+ * any size costs about the same. The pool keeps its place in the pool list, only its struct,
+ * deadzones and sentinel are rewritten wherever the mapping lands.
+ * @details In handle mode, the pages up to the end of the block's header are copied instead, and the
+ * old ones stay mapped but emptied, so stale handles still fail cleanly, see tombstone_keep().
+ * @details The first pool holds the arena, and a pool under a scope mark or in a file-backed
+ * arena can not move, so their blocks are left to the copying path.
+ *
+ * @param head Header of a block owned by arena_thread.
+ * @param size New user-requested size, at least HUGE_REMAP_MIN_SIZE.
+ * @return The block's header after the move, or NULL if the block does not own its mapping
+ * or the mapping can not be resized, in which case nothing was changed.
+ */
+extern pool_header_t *huge_remap(pool_header_t *head, usize size);
+
+#endif //ARENA_ALLOCATOR_HUGE_PAGE_H
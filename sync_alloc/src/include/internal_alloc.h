@@ -22,4 +22,26 @@
  */
 extern pool_header_t *find_or_create_new_header(u32 requested_size);
 
+/**
+ * Carves a block whose payload is aligned to more than ALIGNMENT, from the bump frontier.
+ * The header is placed directly in front of the aligned payload, so return_header() still works,
+ * and the leading gap becomes a free chunk of its own.
+ *
+ * @param requested_size User-requested size, aligned by ALIGNMENT.
+ * @param align Payload alignment, a power of two no larger than MAX_ALLOC_ALIGN.
+ * @return ptr to the new block's header, or NULL if no pool has room for it.
+ */
+extern pool_header_t *find_or_create_aligned_header(u32 requested_size, u32 align);
+
+/**
+ * Rewinds a pool's bump offset, dropping every block at or above it.
+ * A fresh sentinel header is written at the new offset.
+ *
+ * @param pool The pool to rewind.
+ * @param offset The offset to rewind to, must be a header boundary.
+ *
+ * @warning The free list is not touched, the caller has to make sure no free node lies above offset.
+ */
+extern void pool_rewind(memory_pool_t *pool, u32 offset);
+
 #endif //ARENA_ALLOCATOR_INTERNAL_ALLOC_H
\ No newline at end of file
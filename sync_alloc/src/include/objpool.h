@@ -0,0 +1,77 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#ifndef ARENA_ALLOCATOR_OBJPOOL_H
+#define ARENA_ALLOCATOR_OBJPOOL_H
+
+#include "globals.h"
+#include "types.h"
+#include <stdint.h>
+
+// clang-format off
+
+/**
+ * 	Chunk of a fixed-size object pool.
+ *
+ *	@details Every chunk is OBJPOOL_CHUNK_SIZE bytes and aligned to it, so the chunk of an
+ *	object is found by masking. After this struct comes room for the pool struct, which only
+ *	the first chunk uses, then one generation per object if the pool keeps them, then the
+ *	objects back to back at the pool's stride. Every chunk has the same layout, so an object's
+ *	index follows from its offset alone.
+ */
+typedef struct Obj_Chunk {
+	struct Obj_Pool *pool;		/**< Pool that owns the chunk.				*/
+	struct Obj_Chunk *next_chunk;	/**< Chunk mapped after this one.			*/
+	u32 chunk_id;			/**< Index of the chunk in the pool's chunk table.	*/
+} __attribute__((aligned(64))) obj_chunk_t;
+
+/**
+ * 	Fixed-size object pool.
+ *
+ *	@details Objects are bumped out of the newest chunk and freed onto an intrusive stack,
+ *	the first word of a freed object links to the next one, so neither costs a header, a
+ *	deadzone or a size search. A new chunk is only mapped once the stack is empty and the
+ *	newest chunk is used up. The pool lives in its first chunk, the way an arena lives in its
+ *	first pool.
+ *	@details With generations, each object has a u32 that is odd while the object is live.
+ *	They back compact handles and catch double frees, at the cost of one store per call.
+ *
+ *	@note A pool is not thread-safe, like an arena it is used by one thread at a time.
+ */
+typedef struct Obj_Pool {
+	void *free_top;			/**< Top of the stack of freed objects.			*/
+	char *bump_ptr;			/**< Next object of the newest chunk never handed out.	*/
+	char *bump_end;			/**< End of the newest chunk's objects.			*/
+	obj_chunk_t *first_chunk;	/**< The chunk the pool lives in.			*/
+	obj_chunk_t *newest_chunk;	/**< Chunk bump_ptr points into.			*/
+	obj_chunk_t **chunk_table;	/**< Chunks by id, for resolving compact handles.	*/
+	usize live;			/**< Objects handed out and not yet freed.		*/
+	u32 obj_size;			/**< Object size the pool was created with.		*/
+	u32 stride;			/**< Distance between two objects.			*/
+	u32 objects_offset;		/**< Offset of the first object from its chunk.		*/
+	u32 chunk_objs;			/**< How many objects fit in a chunk.			*/
+	u32 chunk_count;		/**< How many chunks are mapped.			*/
+	u32 table_capacity;		/**< How many chunk ptrs the chunk table holds.		*/
+	bool generations;		/**< Whether each object keeps a generation.		*/
+} __attribute__((aligned(64))) obj_pool_t;
+
+// clang-format on
+
+static constexpr u32 OBJPOOL_GENERATIONS_OFFSET = sizeof(obj_chunk_t) + sizeof(obj_pool_t);
+
+/// Returns the chunk an object lies in.
+[[gnu::hot]]
+static inline obj_chunk_t *objpool_chunk_of(const void *obj)
+{
+	return (obj_chunk_t *)((uintptr_t)obj & ~((uintptr_t)OBJPOOL_CHUNK_SIZE - 1));
+}
+
+/// Returns the generation array of a chunk, only valid if its pool keeps generations.
+[[gnu::hot]]
+static inline u32 *objpool_generations(const obj_chunk_t *chunk)
+{
+	return (u32 *)((char *)chunk + OBJPOOL_GENERATIONS_OFFSET);
+}
+
+#endif //ARENA_ALLOCATOR_OBJPOOL_H
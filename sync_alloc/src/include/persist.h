@@ -0,0 +1,113 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#ifndef ARENA_ALLOCATOR_PERSIST_H
+#define ARENA_ALLOCATOR_PERSIST_H
+
+#include "globals.h"
+#include "structs.h"
+#include "sync_alloc.h"
+#include "types.h"
+#include <stdint.h>
+
+#ifndef SYN_USE_RAW
+#include "handle.h"
+#endif
+
+// clang-format off
+
+/**
+ * 	Header at the start of a file-backed arena.
+ *
+ *	@details The file is laid out as this header, padded to PERSIST_HEADER_SIZE, then the
+ *	handle-table zone, then the arena struct and its one pool, so the whole arena is a single
+ *	MAP_SHARED mapping. Handle tables are carved from the zone the same way they are carved
+ *	from a table slab, the zone simply never grows.
+ *	@details Every ptr inside the file is absolute. The file is mapped back at base when that
+ *	address is free, and otherwise every ptr is moved by the difference once, while opening.
+ *	Handles do not survive a restart, but compact handles do, they only hold a table index.
+ *
+ *	@details Shared arenas use the same layout in a memfd. Other processes map it read-only
+ *	wherever it fits and translate the owner's ptrs by base, so the layout is position
+ *	independent for them without the owner paying for offsets on every access.
+ *
+ *	@note clean is cleared while the arena is open, a file that was not closed is refused.
+ */
+typedef struct Persist_Header {
+	u64 magic;			/**< PERSIST_MAGIC, tells an arena file from anything else.	*/
+	u32 version;			/**< PERSIST_VERSION of the layout.				*/
+	u32 clean;			/**< Set when the file was closed and is consistent.		*/
+	uintptr_t base;			/**< Address the file was mapped at the last time.		*/
+	usize map_size;			/**< Size of the file, and of its mapping.			*/
+	usize table_zone_size;		/**< Bytes reserved for handle tables after this header.	*/
+	u64 root;			/**< Compact handle the user keeps their way in under.		*/
+	int fd;				/**< Descriptor of the open file, only valid while mapped.	*/
+} __attribute__((aligned(64))) persist_header_t;
+
+#ifndef SYN_USE_RAW
+/**
+ * 	Header of an arena snapshot.
+ *
+ *	@details A snapshot is a stream written front to back, so it works on pipes as well: this
+ *	header, one snapshot_pool_t per pool, each pool's used range in pool order, one
+ *	snapshot_table_t per handle table, then one snapshot_block_t and its payload per live block
+ *	that lives outside the pools.
+ *	@details A pool's used range is everything from its mapping up to the bump offset and the
+ *	sentinel after it, the structs at its start included, so restoring it is a read and a fixup.
+ */
+typedef struct Snapshot_Header {
+	u64 magic;			/**< SNAPSHOT_MAGIC, tells a snapshot from anything else.	*/
+	u32 version;			/**< SNAPSHOT_VERSION of the layout.				*/
+	u32 pool_count;			/**< How many pool records follow.				*/
+	u32 table_count;		/**< How many handle table records follow the pools.		*/
+	u32 hdl_high_water;		/**< One past the highest handle index used.			*/
+	u32 block_count;		/**< How many out-of-pool block records close the stream.	*/
+	u32 slab_meta;			/**< Whether the arena used the out-of-line layout.		*/
+} snapshot_header_t;
+
+/// Where a pool was, and how much of it is in the snapshot.
+typedef struct Snapshot_Pool {
+	uintptr_t base;			/**< heap_base of the pool when it was saved.			*/
+	usize map_size;			/**< Mapped size of the pool, structs included.			*/
+	usize used_bytes;		/**< Bytes from base that follow in the stream.			*/
+	u32 pool_offset;		/**< Offset of the pool struct from base.			*/
+} snapshot_pool_t;
+
+/// One handle table, its entries still hold the headers' old addresses.
+typedef struct Snapshot_Table {
+	bit64 entries_bitmap;
+	handle_entry_t handle_entries[MAX_TABLE_HNDL_COLS];
+} snapshot_table_t;
+
+/// A guarded or slab block, it is allocated again from the pools when restored.
+typedef struct Snapshot_Block {
+	u32 matrix_index;		/**< Handle entry the block belongs to.				*/
+	u32 allocation_size;		/**< Payload bytes that follow the record.			*/
+	u32 align;			/**< Alignment the payload had, at least ALIGNMENT.		*/
+	bit32 bitflags;			/**< Flags the user set on the block, pins included.		*/
+} snapshot_block_t;
+
+/// Block flags that are the user's state and survive a snapshot, the rest follow from where the block lands.
+static constexpr bit32 SNAPSHOT_KEPT_FLAGS =
+	F_FROZEN | F_SENSITIVE | F_FREE_PENDING | F_OVER_ALIGNED | ((bit32)PIN_COUNT_MAX << PIN_COUNT_SHIFT);
+#endif
+
+// clang-format on
+
+/// Returns the table zone of a file-backed arena, it doubles as its table slab.
+static inline void *persist_table_zone(const persist_header_t *persist)
+{
+	return (char *)persist + PERSIST_HEADER_SIZE;
+}
+
+/**
+ * Moves every ptr inside a file-backed arena by delta, after it was mapped somewhere else.
+ * Only the arena's own structures are touched, payloads are the user's.
+ */
+extern void persist_relocate(arena_t *arena, intptr_t delta);
+
+/// Writes the file back, marks it clean and unmaps it. The arena is gone afterwards.
+extern void persist_close(arena_t *arena);
+
+#endif //ARENA_ALLOCATOR_PERSIST_H
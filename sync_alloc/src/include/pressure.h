@@ -0,0 +1,50 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#ifndef ARENA_ALLOCATOR_PRESSURE_H
+#define ARENA_ALLOCATOR_PRESSURE_H
+
+#include "sync_alloc.h"
+#include "types.h"
+
+/**
+ * 	Soft memory limits and the pressure callback.
+ *
+ *	@details An arena's limit is held against its total_arena_bytes, the process-wide limit
+ *	against every region the region cache handed out and did not get back. Both are only
+ *	checked when a pool is about to be mapped, so the allocation fast paths never look at them.
+ *	@details Relief is layered: the allocator first makes the arena's own parked memory reusable,
+ *	then pressure_relieve() trims the region cache and calls the application, and only then
+ *	is the allocation retried or failed.
+ */
+
+typedef enum Pressure_Status : u32 {
+	PRESSURE_NONE,	/**< The new mapping stays clear of every limit.		*/
+	PRESSURE_NEAR,	/**< It fits, but takes the arena or process near a limit.	*/
+	PRESSURE_OVER,	/**< It would go past a limit.					*/
+} pressure_status_t;
+
+extern void pressure_set_process_limit(usize limit_bytes);
+
+/**
+ * Checks a new mapping of arena_thread against its limit and the process-wide one.
+ *
+ * @param map_bytes How many more bytes the arena would map, arena_thread may be NULL.
+ * @return The worse of the two statuses.
+ */
+[[nodiscard]]
+extern pressure_status_t pressure_check(usize map_bytes);
+
+/**
+ * Unmaps cached regions and calls the pressure callback, if one is set and not running already.
+ *
+ * @details The cache only counts against the process, so it is emptied when the system refused
+ * a mapping or the process limit is near. For an arena's limit, at most map_bytes of it are unmapped.
+ * @param reason Passed on to the callback.
+ * @param request_bytes Passed on to the callback.
+ * @param map_bytes Bytes the arena still has to map, 0 if the pool is already mapped.
+ */
+extern void pressure_relieve(syn_pressure_t reason, usize request_bytes, usize map_bytes);
+
+#endif //ARENA_ALLOCATOR_PRESSURE_H
@@ -0,0 +1,65 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#ifndef ARENA_ALLOCATOR_REGION_CACHE_H
+#define ARENA_ALLOCATOR_REGION_CACHE_H
+
+#include "types.h"
+
+/**
+ * 	Process-wide cache of retired mappings.
+ *
+ *	@details Pools and handle-table slabs are handed here instead of being unmapped, and new
+ *	ones are taken from here before calling mmap, so a thread that is created and destroyed
+ *	over and over maps its memory once. Regions are kept in power-of-two buckets, each behind
+ *	its own spinlock, and a region is only reused for a mapping of the same page-rounded size.
+ *	@details The cache holds at most the configured cache_budget, REGION_CACHE_BUDGET by default,
+ *	anything past that is unmapped.
+ *	A cached region is not scrubbed, so whoever takes it is told how much of it is dirty.
+ *	@details The cache also counts the bytes of every region it handed out and did not get back,
+ *	which is what the process-wide soft limit is held against.
+ */
+
+/**
+ * Takes a cached region of the given size, or maps a new one.
+ *
+ * @param bytes How many bytes to map, rounded up to a whole page.
+ * @param dirty_bytes Set to how many leading bytes may hold old data, the rest is zeroed.
+ * 0 for a fresh mapping.
+ * @return The region, or NULL if there is not enough system memory.
+ */
+[[nodiscard]]
+extern void *region_cache_map(usize bytes, usize *dirty_bytes);
+
+/**
+ * Retires a region into the cache, or unmaps it once the cache is full.
+ *
+ * @param mem The region, as returned by region_cache_map().
+ * @param bytes The size it was mapped with.
+ * @param dirty_bytes How many leading bytes were ever written.
+ */
+extern void region_cache_unmap(void *mem, usize bytes, usize dirty_bytes);
+
+/**
+ * Counts a live region that changed size, or was mapped, without going through the cache.
+ * Every region that is retired through region_cache_unmap() has to be counted one way or the other.
+ *
+ * @param old_bytes The size it was counted with, 0 if it never was.
+ * @param new_bytes The size it has now.
+ */
+extern void region_cache_account(usize old_bytes, usize new_bytes);
+
+/// Returns how many bytes of regions are handed out and not retired, process-wide.
+[[nodiscard]]
+extern usize region_cache_live_bytes();
+
+/**
+ * Unmaps cached regions, for when the process is short on memory.
+ *
+ * @param want_bytes Stops once this many bytes are unmapped, SIZE_MAX empties the cache.
+ * @return How many bytes were unmapped.
+ */
+extern usize region_cache_trim(usize want_bytes);
+
+#endif //ARENA_ALLOCATOR_REGION_CACHE_H
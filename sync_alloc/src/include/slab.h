@@ -5,4 +5,107 @@
 #ifndef ARENA_ALLOCATOR_SLAB_H
 #define ARENA_ALLOCATOR_SLAB_H
 
-#endif //ARENA_ALLOCATOR_SLAB_H
\ No newline at end of file
+#include "globals.h"
+#include "structs.h"
+#include "types.h"
+#include <stdatomic.h>
+#include <stdint.h>
+
+// clang-format off
+
+/**
+ * 	Small-block slab with out-of-line metadata.
+ *
+ *	@details Arenas created with the out-of-line layout serve every block of up to
+ *	MAX_ALLOC_SLAB_SIZE bytes from a slab of one size class instead of a pool. A slab is one
+ *	SLAB_CHUNK_SIZE chunk of a process-wide region: this struct, then one pool_header_t per
+ *	block in a dense side array, then the payloads back to back with nothing between them.
+ *	@details The header of block i is meta[i], so a block costs 16 bytes of metadata instead of
+ *	a header and a deadzone around its payload, and a walk over the slab only reads the side array.
+ *	The chunk is found from any ptr inside it by masking, so no lookup table is needed.
+ *
+ *	@details free_map:  0 == ALLOCATED or never used, 1 == FREE.
+ *
+ *	@note Blocks below bump have been handed out before, blocks at or above it are still zero
+ *	from the region, so calloc can skip them.
+ */
+typedef struct Slab {
+	struct Slab *next_partial;	/**< Next slab of the size class with a free block.	*/
+	struct Slab *next_owned;	/**< Next older slab of the same arena.			*/
+	arena_t *arena;			/**< Arena that owns the slab.				*/
+	u32 block_size;			/**< Payload stride, the size class itself.		*/
+	u32 block_count;		/**< How many blocks fit in the slab.			*/
+	u32 bump;			/**< Blocks below this have been handed out before.	*/
+	u32 free_count;			/**< Freed blocks below bump, ready for reuse.		*/
+	u32 payload_offset;		/**< Offset of the first payload from the slab.		*/
+	bool partial;			/**< Whether the slab is on its class's partial list.	*/
+	bit64 free_map[SLAB_MAP_WORDS];	/**< Bitmap of freed blocks.				*/
+	pool_header_t meta[];		/**< Out-of-line headers, one per block.		*/
+} slab_t;
+
+// clang-format on
+
+extern _Atomic(uintptr_t) slab_region;
+
+/// True if the ptr lies anywhere in the slab region, headers and payloads alike.
+[[gnu::hot]]
+static inline bool slab_owns(const void *ptr)
+{
+	const uintptr_t region = atomic_load_explicit(&slab_region, memory_order_relaxed);
+	return region != 0 && ((uintptr_t)ptr - region) < SLAB_REGION_SIZE;
+}
+
+/// Returns the slab a ptr or out-of-line header lies in.
+[[gnu::hot]]
+static inline slab_t *slab_of(const void *ptr)
+{
+	const uintptr_t region = atomic_load_explicit(&slab_region, memory_order_relaxed);
+	return (slab_t *)(region + (((uintptr_t)ptr - region) & ~((uintptr_t)SLAB_CHUNK_SIZE - 1)));
+}
+
+/// Returns the out-of-line header of a slab block's payload.
+[[gnu::hot]]
+static inline pool_header_t *slab_header(const void *block_ptr)
+{
+	slab_t *slab = slab_of(block_ptr);
+	const uintptr_t payload = (uintptr_t)slab + slab->payload_offset;
+	return &slab->meta[((uintptr_t)block_ptr - payload) / slab->block_size];
+}
+
+/// Returns the payload of the block an out-of-line header describes.
+[[gnu::hot]]
+static inline void *slab_block(const pool_header_t *head)
+{
+	slab_t *slab = slab_of(head);
+	return (char *)slab + slab->payload_offset + ((usize)(head - slab->meta) * slab->block_size);
+}
+
+/**
+ * Hands out a block from the arena's newest slab with room in the size class.
+ *
+ * @param size User-requested size, aligned by ALIGNMENT, between MINIMUM_BLOCK_ALLOC and MAX_ALLOC_SLAB_SIZE.
+ * @return The block's out-of-line header, or NULL if no slab can be claimed.
+ */
+extern pool_header_t *slab_alloc(u32 size);
+
+/// Marks a slab block free, the slab goes back on its class's partial list if it was full.
+extern void slab_free(pool_header_t *head);
+
+/**
+ * Validates a ptr inside the slab region before its header is looked up.
+ * @return 0 if it is the payload of a block that was handed out, 1 otherwise.
+ */
+extern int slab_check(const void *block_ptr);
+
+/// Returns the arena that owns a slab block.
+extern arena_t *slab_owner(const pool_header_t *head);
+
+/// Gives every slab an arena holds back to the region, for when the arena is reset or destroyed.
+extern void slab_release_arena(arena_t *arena);
+
+/// Whether arenas created from now on use the out-of-line layout.
+extern bool slab_default_layout();
+
+extern void slab_set_default_layout(bool out_of_line);
+
+#endif //ARENA_ALLOCATOR_SLAB_H
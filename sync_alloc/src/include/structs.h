@@ -39,12 +39,16 @@ enum Header_Flags : u32 {
 	F_SENTINEL    = (1 << 4),	/**< SENTINEL: Marks the very last header in the pool.					*/
 	F_PREV_FREE   = (1 << 5),	/**< PREV_FREE and NEXT_FREE flags are entirely just to help coalesce free blocks.	*/
 	F_NEXT_FREE   = (1 << 6),	/**< PREV_FREE and NEXT_FREE flags are entirely just to help coalesce free blocks.	*/
-	F_ZEROED      = (1 << 7),	/**< ZEROED: for future calloc like impl.						*/
+	F_ZEROED      = (1 << 7),	/**< ZEROED: block was carved from never-touched pool memory, calloc skips the memset.	*/
 	F_SENSITIVE   = (1 << 8),	/**< SENSITIVE: for heap memory that needs to be zeroed out before reuse.		*/
-	F_RECENT_FREE = (1 << 9),	/**< RECENT_FREE: for later hardening, might not use.					*/
+	F_RECENT_FREE = (1 << 9),	/**< RECENT_FREE: freed sensitive block waiting in the quarantine to be scrubbed.	*/
 	F_RAW         = (1 << 10),	/**< RAW_TYPE: No handle is associated with this header, only a raw void ptr.		*/
 	F_HUGE_PAGE   = (1 << 11),	/**< HUGE_PAGE: Determines if this block is in the huge page pool or not.		*/
 	F_SLAB_BLOCK  = (1 << 12),	/**< SLAB_BLOCK: Determines if this flag marks a slab or not.				*/
+	F_OVER_ALIGNED = (1 << 13),	/**< OVER_ALIGNED: allocated past ALIGNMENT, a moving realloc keeps the alignment.	*/
+	F_GUARDED     = (1 << 14),	/**< GUARDED: sampled block in a guard-paged slot, it has no pool or deadzone.		*/
+	F_FREE_PENDING = (1 << 15),	/**< FREE_PENDING: freed while pinned, the last syn_unpin() frees it.			*/
+	F_GROWBUF     = (1 << 16),	/**< GROWBUF: block at the front of its own reservation, it has no pool or deadzone.	*/
 };
 
 
@@ -65,7 +69,8 @@ typedef struct Head_Deadzone {
  *
  *	@details
  *	Each header can handle a maximum of a 128KiB page, and ideally a minimum of 128 bytes.
- *	Any less than 128 bytes for an allocation and the slab (WIP) should be used.
+ *	Any less than 256 bytes for an allocation and the slab can be used, see slab_t, its
+ *	headers are the same struct but live in a side array instead of in front of the payload.
  *	Any more than 128KiB and dedicated pools shall be used.
  *	@details
  *	The next header is obtained by doing @code PD_HEAD_SIZE + head->size @endcode
@@ -87,6 +92,9 @@ typedef struct Head_Deadzone {
  *	To clear a flag:		@code bitflags &= ~FLAG; @endcode
  *	@details
  *	To clear multiple flags:	@code bitflags &= ~(FLAG1 | FLAG2); @endcode
+ *	@details
+ *	The flags only use the low 17 bits of bitflags, the rest is the block's pin count,
+ *	see PIN_COUNT_SHIFT. A pinned block may be read through but never moved.
  *
  * 	@note
  * 	The pool header could easily be reduced down to 8 bytes, however, this
@@ -139,13 +147,24 @@ typedef struct Pool_Header_Ext {
 typedef struct Memory_Pool {
 	void *mem;			/**< Pointer to the heap region.			*/
 	void *heap_base;		/**< Base of the heap, used for freeing.		*/
+	struct Arena *arena;		/**< The arena that owns this pool.			*/
 	struct Memory_Pool *next_pool;	/**< Pointer to the next pool.				*/
 	pool_free_node_t *first_free;	/**< Pointer to the first freed header.			*/
 	u32 size;			/**< Maximum allocated size for this pool in bytes.	*/
 	u32 offset;			/**< How much space has been used so far in bytes.	*/
 	u32 free_count;			/**< How many freed headers there are in this pool.	*/
+	u32 pool_id;			/**< Index of this pool in the arena's pool list.	*/
+	u32 untouched;			/**< Offset past the highest byte ever written, the	*
+					 *   rest is still zero from mmap.			*/
+	bool held_sensitive;		/**< A sensitive block lived here, so the pages are	*
+					 *   dropped before the region is cached.		*/
 } __attribute__((aligned(64))) memory_pool_t;
 
+/* One slab list per ALIGNMENT step from MINIMUM_BLOCK_ALLOC to MAX_ALLOC_SLAB_SIZE, and	*
+ * enough free bitmap words for the most blocks of the smallest class a slab can hold.	*/
+constexpr u32 SLAB_CLASS_COUNT = 13;
+constexpr u32 SLAB_MAP_WORDS = 16;
+
 // im too lazy to update this comment
 /**
  * 	Super-struct-ure for the entire arena.
@@ -172,19 +191,67 @@ typedef struct Memory_Pool {
  *
  * 	@details
  * 	Each arena also manages a singly-linked-list of handle tables, and each table is capable
- * 	of storing and logging 64 handles each for 64 total allocations per table in its own mmap'd region.
+ * 	of storing and logging 64 handles each for 64 total allocations per table. Tables are carved
+ * 	from shared slabs mapped in doubling sizes, so growing the table list rarely costs an mmap.
  * 	Every subsequent new handle table when the previous is full will still have the same size,
  * 	allocation and logging capacity.
+ *
+ * 	@details
+ * 	In raw mode there are no handle tables. A raw block freed by a thread that does not own
+ * 	it is pushed onto remote_free instead, linked through the first word of the dead payload.
+ * 	Off-thread only the header's magic is swapped, which claims the block against a double
+ * 	free. The owning thread folds those back into its free lists on its next allocation.
+ * 	When a thread exits its arena is parked, not destroyed, and the next thread that needs
+ * 	an arena adopts it together with every block still in it.
+ *
+ * 	@details
+ * 	While a scope mark is pushed, allocations only bump from the newest pool and handles only
+ * 	come from above hdl_high_water, so everything made since the outermost mark lies above
+ * 	scope_pool/scope_offset. Blocks above that frontier are never put on a free list, popping
+ * 	the mark reclaims them by rewinding the offset and unmapping the pools after it.
+ *
+ * 	@details
+ * 	With slab_meta set, small blocks come from slabs with out-of-line headers instead of the
+ * 	pools, see slab_t. slab_partial holds the slabs of each size class that still have room.
+ *
+ * 	@details
+ * 	A file-backed or shared arena lives entirely inside one mapping, see persist_header_t. It
+ * 	has a single pool that never grows, and its handle tables come from a zone of the mapping.
+ * 	Fields after pool_count only mean something to the process that has the arena and are reset
+ * 	when it is mapped, they sit in the alignment padding so the file layout does not change.
+ *
+ * 	@details
+ * 	With limit_bytes set, a new pool that would take total_arena_bytes past it is refused
+ * 	until pressure relief and the pressure callback have had their turn, see pressure.h.
  */
 typedef struct Arena {
 	memory_pool_t *first_mempool;	/**< Pointer to the first memory pool.		*/
 	memory_pool_t *first_hp_pool;	/**< Pointer to the first huge page pool.	*/
 	usize total_arena_bytes;	/**< The total size of all pools together.	*/
+	memory_pool_t *scope_pool;	/**< Pool of the outermost scope mark, if any.	*/
+	u32 scope_offset;		/**< Offset of the outermost scope mark.	*/
+	u32 scope_depth;		/**< How many scope marks are pushed.		*/
+	void *quarantine;		/**< Freed sensitive blocks, not yet scrubbed.	*/
+	usize quarantine_bytes;		/**< Payload bytes waiting in the quarantine.	*/
+	struct Slab *slab_partial[SLAB_CLASS_COUNT];	/**< Slabs with room, per size class.	*/
+	struct Slab *slabs;		/**< Newest slab of the arena, full ones included.	*/
+	bool slab_meta;			/**< Small blocks keep their headers out of line.	*/
+	struct Persist_Header *persist;	/**< File header of a file-backed arena, or NULL.	*/
 	#ifndef SYN_USE_RAW
 	handle_table_t *first_hdl_tbl;	/**< Pointer to LL of tables, matrix.		*/
+	struct Table_Slab *table_slab;	/**< Newest slab tables are carved from.	*/
 	u32 table_count;		/**< How many tables there are.			*/
+	u32 hdl_high_water;		/**< One past the highest handle index used.	*/
+	#else
+	_Atomic(void *) remote_free;	/**< Raw blocks freed by other threads.		*/
+	struct Arena *next_orphan;	/**< Next parked arena of an exited thread.	*/
 	#endif
 	u32 pool_count;			/**< How many memory pools there are.		*/
+	struct Grow_Buf *growbufs;	/**< Newest growbuf of the arena, or NULL.		*/
+	usize limit_bytes;		/**< Soft limit on total_arena_bytes, 0 for none.	*/
+	#ifndef SYN_USE_RAW
+	void *tombstones;		/**< Emptied first pages of moved pools and freed growbufs.	*/
+	#endif
 } __attribute__((aligned(64))) arena_t;
 
 typedef struct Debug_VTable {
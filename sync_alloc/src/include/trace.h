@@ -0,0 +1,79 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#ifndef ARENA_ALLOCATOR_TRACE_H
+#define ARENA_ALLOCATOR_TRACE_H
+
+#include "alloc_utils.h"
+#include "structs.h"
+#include "types.h"
+#include <stdint.h>
+
+/* USDT probes of the sync_alloc provider, for bpftrace and perf, e.g.			*
+ *	bpftrace -e 'usdt:./libsync_alloc.so:sync_alloc:alloc { @sizes = hist(arg0); }'	*
+ * Every probe has a semaphore the tracer raises while it is attached, and its arguments	*
+ * are only computed then, so a detached probe costs a load and a branch not taken and	*
+ * they stay in release builds. Block probes pass (size, pool, handle index), the	*
+ * pool is NULL for blocks outside the pools and the index is UINT32_MAX in raw mode.	*
+ * Without <sys/sdt.h>, or with SYN_ALLOC_DISABLE_TRACE, every probe compiles away.	*
+ *											*
+ *	alloc		(requested size, pool, handle index)				*
+ *	free		(allocation size, pool, handle index)				*
+ *	realloc		(requested size, pool, handle index, old allocation size)	*
+ *	freeze, thaw	(allocation size, pool, handle index)				*
+ *	freelist_miss	(chunk size, pool, free count), free nodes exist but none fit	*
+ *	pool_create	(pool size, pool, pool id)					*
+ *	table_create	(table id, table, arena)						*
+ *	arena_init	(first pool size, arena)					*
+ *	arena_destroy	(total arena bytes, arena, pool count)				*/
+
+#if !defined(SYN_ALLOC_DISABLE_TRACE) && __has_include(<sys/sdt.h>)
+#define SYN_TRACE_SDT 1
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+#define SYN_TRACE_PROBES(X)                                                                                      \
+	X(alloc) X(free) X(realloc) X(freeze) X(thaw) X(freelist_miss) X(pool_create) X(table_create) X(arena_init) \
+	X(arena_destroy)
+
+// The names sys/sdt.h expects, defined in trace.c and counted up by the tracer while it is attached.
+#define SYN_TRACE_SEMAPHORE(name) extern unsigned short sync_alloc_##name##_semaphore;
+SYN_TRACE_PROBES(SYN_TRACE_SEMAPHORE)
+#undef SYN_TRACE_SEMAPHORE
+
+#define SYN_TRACE_ENABLED(name) __builtin_expect(__atomic_load_n(&sync_alloc_##name##_semaphore, __ATOMIC_RELAXED) != 0, 0)
+#define SYN_TRACE(name, ...)                                                                                       \
+	do {                                                                                                       \
+		if (SYN_TRACE_ENABLED(name)) {                                                                     \
+			STAP_PROBEV(sync_alloc, name, __VA_ARGS__);                                                \
+		}                                                                                                  \
+	} while (0)
+#else
+#define SYN_TRACE_ENABLED(name) false
+#define SYN_TRACE(name, ...) ((void)0)
+#endif
+
+
+/// Pool of a block for probe arguments, NULL for blocks that live outside the pools.
+static inline const memory_pool_t *trace_pool(const pool_header_t *head)
+{
+	if (head->bitflags & (F_GUARDED | F_SLAB_BLOCK | F_GROWBUF)) {
+		return nullptr;
+	}
+	return return_pool(head);
+}
+
+
+/// Handle index of a block for probe arguments, raw blocks have none.
+static inline u32 trace_handle_index(const pool_header_t *head)
+{
+	#ifndef SYN_USE_RAW
+	return head->handle_matrix_index;
+	#else
+	(void)head;
+	return UINT32_MAX;
+	#endif
+}
+
+#endif //ARENA_ALLOCATOR_TRACE_H
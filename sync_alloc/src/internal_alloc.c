@@ -9,6 +9,7 @@
 #include "globals.h"
 #include "internal_alloc.h"
 #include "structs.h"
+#include "trace.h"
 #include "types.h"
 #include <stdint.h>
 
@@ -41,6 +42,15 @@ static constexpr u32 JUMPTABLE_LAST_INDEX =
 	(sizeof(header_jumptable) / sizeof(header_jumptable[0])) - 1;
 
 
+/// Raises the pool's never-written mark, nothing above it has been touched since mmap.
+static inline void pool_mark_touched(memory_pool_t *pool, const u32 end)
+{
+	if (end > pool->untouched) {
+		pool->untouched = end;
+	}
+}
+
+
 static inline void create_head_sentinel(const header_context_t *restrict ctx)
 {
 	pool_header_t *restrict sentinel_head =
@@ -48,8 +58,13 @@ static inline void create_head_sentinel(const header_context_t *restrict ctx)
 
 	sentinel_head->chunk_size = STRUCT_SIZE_HEADER;
 	sentinel_head->allocation_size = 0;
+	#ifndef SYN_USE_RAW
 	sentinel_head->handle_matrix_index = 0;
+	#else
+	sentinel_head->magic = 0;
+	#endif
 	sentinel_head->bitflags = (F_SENTINEL | F_FROZEN);
+	pool_mark_touched(ctx->pool, ctx->pool->offset + STRUCT_SIZE_HEADER);
 }
 
 
@@ -69,6 +84,8 @@ static pool_header_t *create_header(const header_context_t *restrict ctx, const
 
 skip_space_check:
 	pool_header_t *restrict head = (pool_header_t *)((char *)ctx->pool->mem + offset);
+	// A reused free chunk can be the last block of the pool, it has to stay its sentinel.
+	const u32 kept_flags = (ctx->jump_table_index == FREE_OFFSET) ? (head->bitflags & F_SENTINEL) : 0;
 
 	const uintptr_t relative_alignment_offset = ALIGN_PTR(head, ALIGNMENT) - (uintptr_t)head;
 	const u32 chunk_size =
@@ -77,19 +94,29 @@ skip_space_check:
 
 	head->allocation_size = ctx->num_bytes;
 	head->chunk_size = pad_chunk_size;
+	#ifndef SYN_USE_RAW
 	head->handle_matrix_index = 0;
+	#else
+	head->magic = RAW_HEADER_MAGIC;
+	#endif
 
 	/* This is to clear the bitflags in case the header is being	*
 	 * placed on a sentinel so it isn't inherited through casts.	*/
 
-	head->bitflags = (offset == 0) ? (F_ALLOCATED | F_FIRST_HEAD) : F_ALLOCATED;
+	head->bitflags = ((offset == 0) ? (F_ALLOCATED | F_FIRST_HEAD) : F_ALLOCATED) | kept_flags;
 
 	create_head_deadzone(head, ctx->pool);
 
 	if (offset == ctx->pool->offset) {
+		// Bump blocks past the never-written mark are still zero from mmap, calloc can skip them.
+		const uintptr_t payload_offset = BLOCK_ALIGN_PTR(head, ALIGNMENT) - (uintptr_t)ctx->pool->mem;
+		if (payload_offset >= ctx->pool->untouched) {
+			head->bitflags |= F_ZEROED;
+		}
 		ctx->pool->offset += pad_chunk_size;
 
 		if (ctx->pool->offset + STRUCT_SIZE_HEADER > ctx->pool->size) {
+			pool_mark_touched(ctx->pool, ctx->pool->offset);
 			head->bitflags |= F_SENTINEL;
 			// head becomes sentinel if there is not enough space
 			goto done;
@@ -143,6 +170,7 @@ static inline i32 free_list_header(const header_context_t *restrict ctx)
 
 	pool_free_node_t *new_node = free_node_remove(ctx->pool, ctx->num_bytes);
 	if (!new_node) {
+		SYN_TRACE(freelist_miss, ctx->num_bytes, ctx->pool, ctx->pool->free_count);
 		return 1;
 	}
 	*ctx->null_head = create_header(ctx, (intptr)new_node - (intptr)ctx->pool->mem);
@@ -155,9 +183,16 @@ static i32 find_new_header(header_context_t *restrict ctx)
 	memory_pool_t *pool_arr[arena_thread->pool_count];
 	const int pool_arr_len = return_pool_array(pool_arr) - 1;
 
-	for (int i = 0; i <= pool_arr_len; i++) {
+	/* With a scope mark pushed, only bump from the newest pool, so everything	*
+	 * allocated since the mark stays above it and can be rolled back at once.	*/
+	const bool in_scope = (arena_thread->scope_depth != 0);
+
+	for (int i = in_scope ? pool_arr_len : 0; i <= pool_arr_len; i++) {
 		ctx->pool = pool_arr[i];
 		for (int j = 0; j <= JUMPTABLE_LAST_INDEX; j++) {
+			if (in_scope && j == FREE_OFFSET) {
+				continue;
+			}
 			ctx->jump_table_index = j;
 			if (header_jumptable[j](ctx) == 0) {
 				return j + 1; // + 1 so it starts at 1 instead of 0
@@ -192,3 +227,116 @@ pool_header_t *find_or_create_new_header(const u32 requested_size)
 	update_sentinel_and_free_flags(new_head);
 	return new_head;
 }
+
+
+/**
+ * Turns the gap in front of an over-aligned block into a free chunk at the bump frontier.
+ * Inside a scope the chunk is above the mark, so it is left off the free list.
+ */
+static pool_header_t *create_gap_chunk(memory_pool_t *pool, const u32 gap)
+{
+	pool_header_t *gap_head = (pool_header_t *)((char *)pool->mem + pool->offset);
+
+	gap_head->allocation_size = gap - (STRUCT_SIZE_HEADER + DEADZONE_SIZE);
+	gap_head->chunk_size = gap;
+	#ifndef SYN_USE_RAW
+	gap_head->handle_matrix_index = 0;
+	#else
+	gap_head->magic = 0;
+	#endif
+	gap_head->bitflags = (pool->offset == 0) ? (F_FREE | F_FIRST_HEAD) : F_FREE;
+
+	create_head_deadzone(gap_head, pool);
+	pool->offset += gap;
+	pool_mark_touched(pool, pool->offset);
+
+	if (arena_thread->scope_depth == 0) {
+		pool_free_node_t *node = (pool_free_node_t *)gap_head;
+		node->next_node = nullptr;
+		free_node_add(node);
+	}
+	return gap_head;
+}
+
+
+static pool_header_t *aligned_offset_header(memory_pool_t *pool, const u32 num_bytes, const u32 align)
+{
+	/* The gap becomes a free chunk, and the free list only hands out exact sizes, so it has	*
+	 * to be at least the chunk of the smallest block or it could never be reused.		*/
+	constexpr u32 min_gap = MIN_FREE_CHUNK;
+
+	const uintptr_t frontier = (uintptr_t)pool->mem + pool->offset;
+	uintptr_t block_addr = ALIGN_PTR(frontier + STRUCT_SIZE_HEADER, align);
+
+	// A gap too small for that is skipped, the block moves on to the next boundary instead.
+	while ((block_addr - STRUCT_SIZE_HEADER) != frontier &&
+	       (block_addr - STRUCT_SIZE_HEADER) - frontier < min_gap) {
+		block_addr += align;
+	}
+	const u32 gap = (u32)((block_addr - STRUCT_SIZE_HEADER) - frontier);
+
+	const u64 needed_bytes = (u64)gap + num_bytes + STRUCT_SIZE_HEADER + (DEADZONE_PADDING * 2) +
+	                         STRUCT_SIZE_HEADER;
+	if ((u64)pool->size - pool->offset < needed_bytes) {
+		return nullptr;
+	}
+
+	pool_header_t *gap_head = (gap != 0) ? create_gap_chunk(pool, gap) : nullptr;
+
+	pool_header_t *head = nullptr;
+	const header_context_t ctx = {
+		.pool = pool,
+		.pool_array = nullptr,
+		.null_head = &head,
+		.num_bytes = num_bytes,
+		.jump_table_index = LINEAR_OFFSET,
+	};
+	head = create_header(&ctx, pool->offset);
+
+	if (gap_head != nullptr) {
+		update_sentinel_and_free_flags(gap_head);
+	}
+	return head;
+}
+
+
+pool_header_t *find_or_create_aligned_header(const u32 requested_size, const u32 align)
+{
+	if (arena_thread == nullptr ||
+	    arena_thread->first_mempool == nullptr ||
+	    requested_size == 0) {
+		return nullptr;
+	}
+
+	memory_pool_t *pool_arr[arena_thread->pool_count];
+	const int pool_arr_len = return_pool_array(pool_arr) - 1;
+	const bool in_scope = (arena_thread->scope_depth != 0);
+
+	// Over-aligned blocks are only bump allocated, free chunks are too unlikely to line up.
+	for (int i = in_scope ? pool_arr_len : 0; i <= pool_arr_len; i++) {
+		pool_header_t *new_head = aligned_offset_header(pool_arr[i], requested_size, align);
+		if (new_head != nullptr) {
+			update_sentinel_and_free_flags(new_head);
+			return new_head;
+		}
+	}
+	return nullptr;
+}
+
+
+void pool_rewind(memory_pool_t *pool, const u32 offset)
+{
+	pool->offset = offset;
+	if (offset == 0 || offset + STRUCT_SIZE_HEADER > pool->size) {
+		return;
+	}
+
+	const header_context_t ctx = {
+		.pool = pool,
+		.pool_array = nullptr,
+		.null_head = nullptr,
+		.num_bytes = 0,
+		.jump_table_index = 0,
+	};
+	create_head_sentinel(&ctx);
+}
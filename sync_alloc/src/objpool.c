@@ -0,0 +1,297 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#include "objpool.h"
+#include "alloc_init.h"
+#include "config.h"
+#include "debug.h"
+#include "defs.h"
+#include "globals.h"
+#include "sync_alloc.h"
+#include "types.h"
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+
+
+/// Maps a chunk aligned to its own size, by mapping twice that and trimming both ends.
+[[gnu::cold]]
+static obj_chunk_t *objpool_map_chunk()
+{
+	char *mem = mmap(nullptr, OBJPOOL_CHUNK_SIZE * 2, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (mem == MAP_FAILED) {
+		return nullptr;
+	}
+
+	char *chunk = (char *)ALIGN_PTR(mem, OBJPOOL_CHUNK_SIZE);
+	const usize lead_bytes = (usize)(chunk - mem);
+	if (lead_bytes != 0) {
+		munmap(mem, lead_bytes);
+	}
+	if (lead_bytes != OBJPOOL_CHUNK_SIZE) {
+		munmap(chunk + OBJPOOL_CHUNK_SIZE, OBJPOOL_CHUNK_SIZE - lead_bytes);
+	}
+	return (obj_chunk_t *)chunk;
+}
+
+
+/// Adds a chunk to the table and points the bump range at it.
+static void objpool_adopt_chunk(obj_pool_t *pool, obj_chunk_t *chunk)
+{
+	chunk->pool = pool;
+	chunk->next_chunk = nullptr;
+	chunk->chunk_id = pool->chunk_count;
+
+	if (pool->newest_chunk != nullptr) {
+		pool->newest_chunk->next_chunk = chunk;
+	}
+	pool->chunk_table[pool->chunk_count++] = chunk;
+	pool->newest_chunk = chunk;
+	pool->bump_ptr = (char *)chunk + pool->objects_offset;
+	pool->bump_end = pool->bump_ptr + ((usize)pool->chunk_objs * pool->stride);
+}
+
+
+[[gnu::cold]]
+static int objpool_grow(obj_pool_t *pool)
+{
+	// Compact handles carry a u32 object index.
+	if ((u64)(pool->chunk_count + 1) * pool->chunk_objs >= UINT32_MAX) {
+		return 1;
+	}
+
+	if (pool->chunk_count == pool->table_capacity) {
+		const usize table_bytes = (usize)pool->table_capacity * sizeof(obj_chunk_t *);
+		obj_chunk_t **new_table = syn_map_page(table_bytes * 2);
+		if (new_table == nullptr) {
+			return 1;
+		}
+		memcpy(new_table, pool->chunk_table, table_bytes);
+		syn_unmap_page(pool->chunk_table, table_bytes);
+		pool->chunk_table = new_table;
+		pool->table_capacity *= 2;
+	}
+
+	obj_chunk_t *chunk = objpool_map_chunk();
+	if (chunk == nullptr) {
+		return 1;
+	}
+	objpool_adopt_chunk(pool, chunk);
+	return 0;
+}
+
+
+static inline u32 objpool_index(const obj_pool_t *pool, const void *obj)
+{
+	const uintptr_t offset = (uintptr_t)obj - (uintptr_t)objpool_chunk_of(obj);
+	return (u32)((offset - pool->objects_offset) / pool->stride);
+}
+
+
+/**
+ * Validates an object before it is freed or turned into a compact handle.
+ * @return 0 if it is an object of this pool that was handed out before, 1 otherwise.
+ */
+static int objpool_check(const obj_pool_t *pool, const void *obj)
+{
+	const obj_chunk_t *chunk = objpool_chunk_of(obj);
+	if (chunk->pool != pool) {
+		return 1;
+	}
+
+	const uintptr_t offset = (uintptr_t)obj - (uintptr_t)chunk;
+	if (offset < pool->objects_offset) {
+		return 1;
+	}
+	const uintptr_t object_bytes = offset - pool->objects_offset;
+	const uintptr_t index = object_bytes / pool->stride;
+	if (index * pool->stride != object_bytes || index >= pool->chunk_objs) {
+		return 1;
+	}
+	return (chunk == pool->newest_chunk && (const char *)obj >= pool->bump_ptr) ? 1 : 0;
+}
+
+
+syn_objpool_t *syn_objpool_create(const size_t obj_size, size_t align, const syn_objpool_flags_t flags)
+{
+	if (align < sizeof(void *)) {
+		align = sizeof(void *);
+	}
+	if (obj_size == 0 || obj_size > OBJPOOL_MAX_OBJ_SIZE) {
+		return nullptr;
+	}
+	if ((align & (align - 1)) != 0 || align > MAX_ALLOC_ALIGN) {
+		return nullptr;
+	}
+	config_load();
+
+	// A freed object holds the link to the next one, so it has to fit a ptr.
+	const u32 stride = (u32)ALIGN_PTR((obj_size < sizeof(void *)) ? sizeof(void *) : obj_size, align);
+	const bool generations = (flags & SYN_OBJPOOL_HANDLES) != 0;
+	const u32 generation_size = generations ? sizeof(u32) : 0;
+
+	u32 chunk_objs = (OBJPOOL_CHUNK_SIZE - OBJPOOL_GENERATIONS_OFFSET) / (stride + generation_size);
+	u32 objects_offset = 0;
+	while (chunk_objs > 0) {
+		objects_offset = (u32)ALIGN_PTR(OBJPOOL_GENERATIONS_OFFSET + (chunk_objs * generation_size), align);
+		if (objects_offset + ((usize)chunk_objs * stride) <= OBJPOOL_CHUNK_SIZE) {
+			break;
+		}
+		chunk_objs--;
+	}
+	if (chunk_objs == 0) {
+		return nullptr;
+	}
+
+	obj_chunk_t *first_chunk = objpool_map_chunk();
+	if (first_chunk == nullptr) {
+		return nullptr;
+	}
+	obj_chunk_t **chunk_table = syn_map_page(4 * KIBIBYTE);
+	if (chunk_table == nullptr) {
+		munmap(first_chunk, OBJPOOL_CHUNK_SIZE);
+		return nullptr;
+	}
+
+	obj_pool_t *pool = (obj_pool_t *)((char *)first_chunk + sizeof(obj_chunk_t));
+	pool->free_top = nullptr;
+	pool->first_chunk = first_chunk;
+	pool->newest_chunk = nullptr;
+	pool->chunk_table = chunk_table;
+	pool->live = 0;
+	pool->obj_size = (u32)obj_size;
+	pool->stride = stride;
+	pool->objects_offset = objects_offset;
+	pool->chunk_objs = chunk_objs;
+	pool->chunk_count = 0;
+	pool->table_capacity = (4 * KIBIBYTE) / sizeof(obj_chunk_t *);
+	pool->generations = generations;
+
+	objpool_adopt_chunk(pool, first_chunk);
+	return pool;
+}
+
+
+void syn_objpool_destroy(syn_objpool_t *pool)
+{
+	if (pool == nullptr) {
+		return;
+	}
+
+	// The pool lives in its first chunk, so everything needed is read out before any unmap.
+	obj_chunk_t **chunk_table = pool->chunk_table;
+	const usize table_bytes = (usize)pool->table_capacity * sizeof(obj_chunk_t *);
+	obj_chunk_t *chunk = pool->first_chunk;
+
+	while (chunk != nullptr) {
+		obj_chunk_t *next_chunk = chunk->next_chunk;
+		munmap(chunk, OBJPOOL_CHUNK_SIZE);
+		chunk = next_chunk;
+	}
+	syn_unmap_page(chunk_table, table_bytes);
+}
+
+
+void *syn_objpool_alloc(syn_objpool_t *pool)
+{
+	if (pool == nullptr) {
+		return nullptr;
+	}
+	void *obj = pool->free_top;
+	if (obj != nullptr) {
+		pool->free_top = *(void **)obj;
+		goto obj_found;
+	}
+	if (pool->bump_ptr == pool->bump_end && objpool_grow(pool) != 0) {
+		return nullptr;
+	}
+	obj = pool->bump_ptr;
+	pool->bump_ptr += pool->stride;
+
+obj_found:
+	pool->live++;
+	if (pool->generations) {
+		objpool_generations(objpool_chunk_of(obj))[objpool_index(pool, obj)]++;
+	}
+	return obj;
+}
+
+
+void syn_objpool_free(syn_objpool_t *pool, void *obj)
+{
+	if (pool == nullptr || obj == nullptr) {
+		return;
+	}
+	if (alloc_config.safety != SYN_SAFETY_FAST && objpool_check(pool, obj) != 0) {
+		sync_alloc_log.to_console(log_stderr, "syn_objpool_free(): object is not from this pool!\n");
+		return;
+	}
+	if (pool->generations) {
+		u32 *generation = &objpool_generations(objpool_chunk_of(obj))[objpool_index(pool, obj)];
+		if (!(*generation & 1)) {
+			sync_alloc_log.to_console(log_stderr, "syn_objpool_free(): double free detected!\n");
+			return;
+		}
+		(*generation)++;
+	}
+
+	*(void **)obj = pool->free_top;
+	pool->free_top = obj;
+	pool->live--;
+}
+
+
+syn_objpool_stats_t syn_objpool_stats(const syn_objpool_t *pool)
+{
+	if (pool == nullptr) {
+		return (syn_objpool_stats_t){};
+	}
+	const syn_objpool_stats_t stats = {
+		.live = pool->live,
+		.capacity = (size_t)pool->chunk_count * pool->chunk_objs,
+		.chunk_count = pool->chunk_count,
+		.mapped_bytes = ((size_t)pool->chunk_count * OBJPOOL_CHUNK_SIZE) +
+		                ((size_t)pool->table_capacity * sizeof(obj_chunk_t *)),
+	};
+	return stats;
+}
+
+
+#ifndef SYN_USE_RAW
+
+syn_ref_t syn_objpool_ref(const syn_objpool_t *pool, const void *obj)
+{
+	if (pool == nullptr || obj == nullptr || !pool->generations || objpool_check(pool, obj) != 0) {
+		return SYN_REF_INVALID;
+	}
+	const obj_chunk_t *chunk = objpool_chunk_of(obj);
+	const u32 index = objpool_index(pool, obj);
+	const u32 generation = objpool_generations(chunk)[index];
+	if (!(generation & 1)) {
+		return SYN_REF_INVALID;
+	}
+	return ((syn_ref_t)generation << 32) | ((chunk->chunk_id * pool->chunk_objs) + index);
+}
+
+
+void *syn_objpool_deref(const syn_objpool_t *pool, const syn_ref_t ref)
+{
+	if (pool == nullptr || ref == SYN_REF_INVALID || !pool->generations) {
+		return nullptr;
+	}
+	const u32 chunk_id = (u32)ref / pool->chunk_objs;
+	const u32 index = (u32)ref % pool->chunk_objs;
+	if (chunk_id >= pool->chunk_count) {
+		return nullptr;
+	}
+
+	// Objects that were never handed out still have generation 0, which no ref carries.
+	const obj_chunk_t *chunk = pool->chunk_table[chunk_id];
+	if (objpool_generations(chunk)[index] != (u32)(ref >> 32)) {
+		return nullptr;
+	}
+	return (char *)chunk + pool->objects_offset + ((usize)index * pool->stride);
+}
+
+#endif
@@ -0,0 +1,746 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+// memfd_create() is a GNU extension.
+#define _GNU_SOURCE
+
+#include "persist.h"
+#include "alloc_init.h"
+#include "alloc_utils.h"
+#include "config.h"
+#include "deadzone.h"
+#include "debug.h"
+#include "defs.h"
+#include "free_node.h"
+#include "globals.h"
+#include "internal_alloc.h"
+#include "region_cache.h"
+#include "structs.h"
+#include "types.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdbit.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Only handles can outlive a process, raw ptrs are meaningless after a restart.
+#ifndef SYN_USE_RAW
+#include "handle.h"
+
+
+static inline void *persist_shift(void *ptr, const intptr_t delta)
+{
+	return (ptr == nullptr) ? nullptr : (void *)((uintptr_t)ptr + (uintptr_t)delta);
+}
+
+
+static inline arena_t *persist_arena(const persist_header_t *persist)
+{
+	return (arena_t *)((char *)persist_table_zone(persist) + persist->table_zone_size);
+}
+
+
+/// Moves one pool by delta, the struct and every deadzone in its used range point at it.
+static void pool_relocate(memory_pool_t *pool, arena_t *arena, const intptr_t delta)
+{
+	pool->mem = persist_shift(pool->mem, delta);
+	pool->heap_base = persist_shift(pool->heap_base, delta);
+	pool->arena = arena;
+	pool->first_free = persist_shift(pool->first_free, delta);
+	create_pool_deadzone(pool);
+
+	for (pool_free_node_t *node = pool->first_free; node != nullptr; node = node->next_node) {
+		node->next_node = persist_shift(node->next_node, delta);
+	}
+
+	// Every chunk below the bump offset ends in a deadzone that points back at the pool.
+	u32 offset = 0;
+	while (offset < pool->offset) {
+		pool_header_t *head = (pool_header_t *)((char *)pool->mem + offset);
+		if (head->chunk_size < STRUCT_SIZE_HEADER + DEADZONE_SIZE) {
+			break;
+		}
+		create_head_deadzone(head, pool);
+		offset += head->chunk_size;
+	}
+}
+
+
+void persist_relocate(arena_t *arena, const intptr_t delta)
+{
+	arena->first_mempool = persist_shift(arena->first_mempool, delta);
+	arena->persist = persist_shift(arena->persist, delta);
+	arena->quarantine = persist_shift(arena->quarantine, delta);
+	arena->table_slab = persist_shift(arena->table_slab, delta);
+	arena->first_hdl_tbl = persist_shift(arena->first_hdl_tbl, delta);
+
+	pool_relocate(arena->first_mempool, arena, delta);
+
+	for (void *block_ptr = arena->quarantine; block_ptr != nullptr; block_ptr = *(void **)block_ptr) {
+		*(void **)block_ptr = persist_shift(*(void **)block_ptr, delta);
+	}
+
+	for (handle_table_t *table = arena->first_hdl_tbl; table != nullptr; table = table->next_table) {
+		table->next_table = persist_shift(table->next_table, delta);
+		for (u32 col = 0; col < MAX_TABLE_HNDL_COLS; col++) {
+			table->handle_entries[col].header = persist_shift(table->handle_entries[col].header, delta);
+		}
+	}
+}
+
+
+/// Lays a new arena out in a freshly truncated file, which reads as zeroes.
+static arena_t *persist_format(void *mem, const usize map_size, const int fd)
+{
+	persist_header_t *persist = mem;
+	persist->magic = PERSIST_MAGIC;
+	persist->version = PERSIST_VERSION;
+	persist->clean = 0;
+	persist->base = (uintptr_t)mem;
+	persist->map_size = map_size;
+	persist->table_zone_size = ALIGN_PTR(map_size / 16, 4 * KIBIBYTE);
+	persist->root = UINT64_MAX;
+	persist->fd = fd;
+
+	arena_t *prev_arena = arena_thread;
+	void *raw_pool = persist_arena(persist);
+	const usize pool_bytes = map_size - ((uintptr_t)raw_pool - (uintptr_t)mem);
+
+	arena_setup(raw_pool, pool_bytes, 0);
+	arena_t *arena = arena_thread;
+	arena->persist = persist;
+	arena->slab_meta = false;
+
+	arena_thread = prev_arena;
+	return arena;
+}
+
+
+/// Sizes an empty file to the arena and lays a new arena out in it.
+static arena_t *persist_create(const int fd, const usize size, const char *caller)
+{
+	const usize map_size = ALIGN_PTR(size, 4 * KIBIBYTE);
+	if (map_size < PERSIST_MIN_SIZE || map_size > MAX_POOL_SIZE) {
+		sync_alloc_log.to_console(log_stderr, "%s: size out of range!\n", caller);
+		return nullptr;
+	}
+	if (ftruncate(fd, (off_t)map_size) != 0) {
+		return nullptr;
+	}
+
+	void *mem = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (mem == MAP_FAILED) {
+		return nullptr;
+	}
+	return persist_format(mem, map_size, fd);
+}
+
+
+/// Maps an existing arena file back in, at its old address if that is still free.
+static arena_t *persist_map_existing(const int fd, const usize file_size)
+{
+	persist_header_t header;
+	if (pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header)) {
+		return nullptr;
+	}
+	if (header.magic != PERSIST_MAGIC || header.version != PERSIST_VERSION ||
+	    header.map_size != file_size) {
+		sync_alloc_log.to_console(log_stderr, "syn_arena_open(): not a sync_alloc arena file!\n");
+		return nullptr;
+	}
+	if (!header.clean) {
+		sync_alloc_log.to_console(log_stderr,
+		                          "syn_arena_open(): arena file was not closed cleanly!\n");
+		return nullptr;
+	}
+
+	void *mem = mmap((void *)header.base,
+	                 header.map_size,
+	                 PROT_READ | PROT_WRITE,
+	                 MAP_SHARED | MAP_FIXED_NOREPLACE,
+	                 fd,
+	                 0);
+	if (mem == MAP_FAILED || mem != (void *)header.base) {
+		// Kernels without MAP_FIXED_NOREPLACE treat it as a hint and may place it elsewhere.
+		if (mem != MAP_FAILED) {
+			munmap(mem, header.map_size);
+		}
+		mem = mmap(nullptr, header.map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if (mem == MAP_FAILED) {
+			return nullptr;
+		}
+	}
+
+	persist_header_t *persist = mem;
+	arena_t *arena = persist_arena(persist);
+	const intptr_t delta = (intptr_t)((uintptr_t)mem - persist->base);
+	if (delta != 0) {
+		persist_relocate(arena, delta);
+	}
+
+	persist->base = (uintptr_t)mem;
+	persist->fd = fd;
+	persist->clean = 0;
+
+	// Nothing that is tied to a process comes back from the file.
+	arena->persist = persist;
+	arena->growbufs = nullptr;
+	arena->limit_bytes = alloc_config.arena_limit;
+	arena->scope_pool = nullptr;
+	arena->scope_offset = 0;
+	arena->scope_depth = 0;
+	arena->slab_meta = false;
+	for (u32 i = 0; i < SLAB_CLASS_COUNT; i++) {
+		arena->slab_partial[i] = nullptr;
+	}
+	arena->slabs = nullptr;
+	arena->tombstones = nullptr;
+	return arena;
+}
+
+
+syn_arena_t *syn_arena_open(const char *path, const size_t size)
+{
+	if (path == nullptr) {
+		return nullptr;
+	}
+	const int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+	if (fd < 0) {
+		return nullptr;
+	}
+
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) != 0) {
+		goto open_failure;
+	}
+
+	if (file_stat.st_size != 0) {
+		arena_t *arena = persist_map_existing(fd, (usize)file_stat.st_size);
+		if (arena == nullptr) {
+			goto open_failure;
+		}
+		return arena;
+	}
+
+	arena_t *arena = persist_create(fd, size, "syn_arena_open()");
+	if (arena == nullptr) {
+		goto open_failure;
+	}
+	return arena;
+
+open_failure:
+	close(fd);
+	return nullptr;
+}
+
+
+void persist_close(arena_t *arena)
+{
+	persist_header_t *persist = arena->persist;
+	const int fd = persist->fd;
+	const usize map_size = persist->map_size;
+
+	persist->fd = -1;
+	persist->clean = 1;
+
+	msync(persist, map_size, MS_SYNC);
+	munmap(persist, map_size);
+	close(fd);
+}
+
+
+syn_ref_t syn_arena_root(const syn_arena_t *arena)
+{
+	if (arena == nullptr || arena->persist == nullptr) {
+		return SYN_REF_INVALID;
+	}
+	return arena->persist->root;
+}
+
+
+void syn_arena_set_root(syn_arena_t *arena, const syn_ref_t ref)
+{
+	if (arena == nullptr || arena->persist == nullptr) {
+		return;
+	}
+	arena->persist->root = ref;
+}
+
+syn_arena_t *syn_arena_share(const size_t size)
+{
+	const int fd = memfd_create("sync_alloc", MFD_CLOEXEC);
+	if (fd < 0) {
+		return nullptr;
+	}
+	arena_t *arena = persist_create(fd, size, "syn_arena_share()");
+	if (arena == nullptr) {
+		close(fd);
+	}
+	return arena;
+}
+
+
+int syn_arena_fd(const syn_arena_t *arena)
+{
+	return (arena == nullptr || arena->persist == nullptr) ? -1 : arena->persist->fd;
+}
+
+
+syn_shared_t *syn_shared_attach(const int fd)
+{
+	struct stat file_stat;
+	if (fd < 0 || fstat(fd, &file_stat) != 0 || (usize)file_stat.st_size < PERSIST_MIN_SIZE) {
+		return nullptr;
+	}
+	const usize map_size = (usize)file_stat.st_size;
+
+	persist_header_t *shared = mmap(nullptr, map_size, PROT_READ, MAP_SHARED, fd, 0);
+	if (shared == MAP_FAILED) {
+		return nullptr;
+	}
+
+	const bool bad_header = shared->magic != PERSIST_MAGIC ||
+	                        shared->version != PERSIST_VERSION ||
+	                        shared->map_size != map_size ||
+	                        PERSIST_HEADER_SIZE + shared->table_zone_size + STRUCT_SIZE_ARENA > map_size;
+	if (bad_header) {
+		sync_alloc_log.to_console(log_stderr, "syn_shared_attach(): not a sync_alloc arena!\n");
+		munmap(shared, map_size);
+		return nullptr;
+	}
+	return shared;
+}
+
+
+const void *syn_shared_freeze(const syn_shared_t *shared, const syn_ref_t ref)
+{
+	if (shared == nullptr || ref == SYN_REF_INVALID) {
+		return nullptr;
+	}
+
+	/* Everything read here is written by the owner and may be garbage, so every offset is	*
+	 * checked against the mapping before it is followed, and ptrs are only ever translated.	*/
+	const arena_t *arena = persist_arena(shared);
+	const u32 matrix_index = (u32)ref;
+	const u32 row = matrix_index / MAX_TABLE_HNDL_COLS;
+	const u32 col = matrix_index % MAX_TABLE_HNDL_COLS;
+	const usize table_offset = TABLE_SLAB_HEADER + ((usize)row * TABLE_SLAB_STRIDE);
+	if (matrix_index >= arena->hdl_high_water || table_offset + TABLE_SLAB_STRIDE > shared->table_zone_size) {
+		return nullptr;
+	}
+
+	// Tables are carved from the zone in order, so a row is found without following next_table.
+	const handle_table_t *table = (const handle_table_t *)((char *)persist_table_zone(shared) + table_offset);
+	const handle_entry_t *entry = &table->handle_entries[col];
+	if (!(table->entries_bitmap & (1ULL << col)) || entry->generation != (u32)(ref >> 32)) {
+		return nullptr;
+	}
+	atomic_thread_fence(memory_order_acquire);
+
+	const uintptr_t pool_start = PERSIST_HEADER_SIZE + shared->table_zone_size;
+	const uintptr_t head_offset = (uintptr_t)entry->header - shared->base;
+	if (head_offset < pool_start || head_offset + STRUCT_SIZE_HEADER > shared->map_size) {
+		return nullptr;
+	}
+
+	const pool_header_t *head = (const pool_header_t *)((char *)shared + head_offset);
+	const void *block_ptr = return_block(head);
+	const usize block_end = (uintptr_t)block_ptr - (uintptr_t)shared + head->allocation_size;
+	if (!(head->bitflags & F_ALLOCATED) || block_end > shared->map_size) {
+		return nullptr;
+	}
+	return block_ptr;
+}
+
+
+void syn_shared_detach(syn_shared_t *shared)
+{
+	if (shared == nullptr) {
+		return;
+	}
+	munmap(shared, shared->map_size);
+}
+
+
+/// Writes the whole buffer, retrying short writes, so pipes and sockets work as well as files.
+static int persist_write(const int fd, const void *buf, usize bytes)
+{
+	const char *cursor = buf;
+	while (bytes > 0) {
+		const ssize_t written = write(fd, cursor, bytes);
+		if (written < 0 && errno == EINTR) {
+			continue;
+		}
+		if (written <= 0) {
+			return 1;
+		}
+		cursor += written;
+		bytes -= (usize)written;
+	}
+	return 0;
+}
+
+
+static int persist_read(const int fd, void *buf, usize bytes)
+{
+	char *cursor = buf;
+	while (bytes > 0) {
+		const ssize_t got = read(fd, cursor, bytes);
+		if (got < 0 && errno == EINTR) {
+			continue;
+		}
+		if (got <= 0) {
+			return 1;
+		}
+		cursor += got;
+		bytes -= (usize)got;
+	}
+	return 0;
+}
+
+
+/// Guarded, slab and growbuf blocks are not inside any pool, so they are saved on their own.
+static inline bool snapshot_is_loose(const pool_header_t *head)
+{
+	return (head->bitflags & (F_GUARDED | F_SLAB_BLOCK | F_GROWBUF)) != 0;
+}
+
+
+static usize snapshot_used_bytes(const memory_pool_t *pool)
+{
+	// The sentinel header right after the bump offset belongs to the used range too.
+	const u32 used = (pool->offset + STRUCT_SIZE_HEADER < pool->size) ? pool->offset + STRUCT_SIZE_HEADER
+	                                                                  : pool->size;
+	return ((uintptr_t)pool->mem - (uintptr_t)pool->heap_base) + used;
+}
+
+
+static int snapshot_write_arena(const int fd)
+{
+	memory_pool_t *pool_arr[arena_thread->pool_count];
+	const int pool_arr_len = return_pool_array(pool_arr);
+
+	snapshot_header_t header = {
+		.magic = SNAPSHOT_MAGIC,
+		.version = SNAPSHOT_VERSION,
+		.pool_count = (u32)pool_arr_len,
+		.table_count = 0,
+		.hdl_high_water = arena_thread->hdl_high_water,
+		.block_count = 0,
+		.slab_meta = arena_thread->slab_meta,
+	};
+	for (handle_table_t *table = arena_thread->first_hdl_tbl; table != nullptr; table = table->next_table) {
+		header.table_count++;
+		for (u32 col = 0; col < MAX_TABLE_HNDL_COLS; col++) {
+			const bool live = (table->entries_bitmap & (1ULL << col)) != 0;
+			if (live && snapshot_is_loose(table->handle_entries[col].header)) {
+				header.block_count++;
+			}
+		}
+	}
+	if (persist_write(fd, &header, sizeof(header)) != 0) {
+		return 1;
+	}
+
+	for (int i = 0; i < pool_arr_len; i++) {
+		const snapshot_pool_t record = {
+			.base = (uintptr_t)pool_arr[i]->heap_base,
+			.map_size = pool_mapped_bytes(pool_arr[i]),
+			.used_bytes = snapshot_used_bytes(pool_arr[i]),
+			.pool_offset = (u32)((uintptr_t)pool_arr[i] - (uintptr_t)pool_arr[i]->heap_base),
+		};
+		if (persist_write(fd, &record, sizeof(record)) != 0) {
+			return 1;
+		}
+	}
+	for (int i = 0; i < pool_arr_len; i++) {
+		if (persist_write(fd, pool_arr[i]->heap_base, snapshot_used_bytes(pool_arr[i])) != 0) {
+			return 1;
+		}
+	}
+
+	u32 row = 0;
+	for (handle_table_t *table = arena_thread->first_hdl_tbl; table != nullptr; table = table->next_table) {
+		snapshot_table_t record = {.entries_bitmap = table->entries_bitmap};
+		memcpy(record.handle_entries, table->handle_entries, sizeof(record.handle_entries));
+		if (persist_write(fd, &record, sizeof(record)) != 0) {
+			return 1;
+		}
+	}
+	for (handle_table_t *table = arena_thread->first_hdl_tbl; table != nullptr; table = table->next_table) {
+		for (u32 col = 0; col < MAX_TABLE_HNDL_COLS; col++) {
+			const pool_header_t *head = table->handle_entries[col].header;
+			if (!(table->entries_bitmap & (1ULL << col)) || !snapshot_is_loose(head)) {
+				continue;
+			}
+			const void *block_ptr = return_block(head);
+			const u32 align = 1U << stdc_trailing_zeros_ull((uintptr_t)block_ptr | MAX_ALLOC_ALIGN);
+			const snapshot_block_t record = {
+				.matrix_index = (row * MAX_TABLE_HNDL_COLS) + col,
+				.allocation_size = head->allocation_size,
+				.align = (align < ALIGNMENT) ? ALIGNMENT : align,
+				.bitflags = head->bitflags & SNAPSHOT_KEPT_FLAGS,
+			};
+			if (persist_write(fd, &record, sizeof(record)) != 0 ||
+			    persist_write(fd, block_ptr, head->allocation_size) != 0) {
+				return 1;
+			}
+		}
+		row++;
+	}
+	return 0;
+}
+
+
+int syn_arena_snapshot(syn_arena_t *arena, const int fd)
+{
+	arena_t *prev_arena = arena_thread;
+	arena_thread = (arena != nullptr) ? arena : prev_arena;
+	if (arena_thread == nullptr || fd < 0) {
+		arena_thread = prev_arena;
+		return 1;
+	}
+
+	// Quarantined secrets must not end up on disk.
+	syn_scrub_quarantine();
+	const int ret = snapshot_write_arena(fd);
+
+	arena_thread = prev_arena;
+	return ret;
+}
+
+
+/// Maps a pool back at its old address if that is free, anywhere otherwise.
+static void *snapshot_map_pool(const snapshot_pool_t *record, usize *dirty_bytes)
+{
+	*dirty_bytes = 0;
+	void *mem = mmap((void *)record->base,
+	                 record->map_size,
+	                 PROT_READ | PROT_WRITE,
+	                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE,
+	                 -1,
+	                 0);
+	if (mem == (void *)record->base) {
+		// It is retired through the cache like every other pool, so it is counted like one.
+		region_cache_account(0, record->map_size);
+		return mem;
+	}
+	if (mem != MAP_FAILED) {
+		munmap(mem, record->map_size);
+	}
+	return region_cache_map(record->map_size, dirty_bytes);
+}
+
+
+/// Moves an entry's header to wherever its pool was restored, NULL if no pool held it.
+static pool_header_t *snapshot_translate(const snapshot_pool_t *records, memory_pool_t **pools, const u32 pool_count,
+                                         const pool_header_t *head)
+{
+	for (u32 i = 0; i < pool_count; i++) {
+		if ((uintptr_t)head - records[i].base < records[i].used_bytes) {
+			const intptr_t delta = (intptr_t)((uintptr_t)pools[i]->heap_base - records[i].base);
+			return persist_shift((void *)head, delta);
+		}
+	}
+	return nullptr;
+}
+
+
+static void snapshot_unmap_pools(memory_pool_t **pools, const u32 count)
+{
+	for (u32 i = 0; i < count; i++) {
+		pool_unmap(pools[i]);
+	}
+}
+
+
+static int snapshot_read_pools(const int fd, snapshot_pool_t *records, memory_pool_t **pools, const u32 pool_count)
+{
+	if (persist_read(fd, records, sizeof(snapshot_pool_t) * pool_count) != 0) {
+		return 1;
+	}
+	for (u32 i = 0; i < pool_count; i++) {
+		const snapshot_pool_t *record = &records[i];
+		const bool bad_record = record->map_size > (usize)MAX_POOL_SIZE + (4 * KIBIBYTE) ||
+		                        record->used_bytes > record->map_size ||
+		                        record->pool_offset + STRUCT_SIZE_POOL > record->used_bytes;
+		usize dirty_bytes;
+		void *mem = bad_record ? nullptr : snapshot_map_pool(record, &dirty_bytes);
+		if (mem == nullptr) {
+			snapshot_unmap_pools(pools, i);
+			return 1;
+		}
+
+		memory_pool_t *pool = (memory_pool_t *)((char *)mem + record->pool_offset);
+		const bool bad_pool = persist_read(fd, mem, record->used_bytes) != 0 ||
+		                      (uintptr_t)pool->heap_base != record->base ||
+		                      pool_mapped_bytes(pool) != record->map_size ||
+		                      pool->offset > pool->size;
+		if (bad_pool) {
+			region_cache_unmap(mem, record->map_size, record->map_size);
+			snapshot_unmap_pools(pools, i);
+			return 1;
+		}
+
+		// The arena struct sits at the start of the first pool's mapping.
+		arena_t *arena = (i == 0) ? mem : pools[0]->heap_base;
+		pool_relocate(pool, arena, (intptr_t)((uintptr_t)mem - record->base));
+
+		const usize reserved_bytes = (uintptr_t)pool->mem - (uintptr_t)mem;
+		const usize touched = (dirty_bytes > record->used_bytes) ? dirty_bytes : record->used_bytes;
+		pool->untouched = (u32)(touched - reserved_bytes);
+		pool->next_pool = nullptr;
+		if (i > 0) {
+			pools[i - 1]->next_pool = pool;
+		}
+		pools[i] = pool;
+	}
+	return 0;
+}
+
+
+static int snapshot_read_tables(const int fd, const snapshot_header_t *header, const snapshot_pool_t *records,
+                                memory_pool_t **pools)
+{
+	for (u32 row = 0; row < header->table_count; row++) {
+		snapshot_table_t record;
+		handle_table_t *table = new_handle_table();
+		if (table == nullptr || persist_read(fd, &record, sizeof(record)) != 0) {
+			return 1;
+		}
+		table->entries_bitmap = record.entries_bitmap;
+		for (u32 col = 0; col < MAX_TABLE_HNDL_COLS; col++) {
+			handle_entry_t *entry = &table->handle_entries[col];
+			entry->generation = record.handle_entries[col].generation;
+			entry->header = snapshot_translate(records, pools, header->pool_count,
+			                                   record.handle_entries[col].header);
+		}
+	}
+	arena_thread->hdl_high_water = header->hdl_high_water;
+	return 0;
+}
+
+
+static int snapshot_read_blocks(const int fd, const snapshot_header_t *header)
+{
+	for (u32 i = 0; i < header->block_count; i++) {
+		snapshot_block_t record;
+		if (persist_read(fd, &record, sizeof(record)) != 0) {
+			return 1;
+		}
+		handle_entry_t *entry = return_live_entry(record.matrix_index);
+		const bool bad_record = entry == nullptr ||
+		                        record.allocation_size == 0 ||
+		                        record.allocation_size >= MAX_POOL_SIZE ||
+		                        record.align > MAX_ALLOC_ALIGN;
+		if (bad_record) {
+			return 1;
+		}
+
+		const u32 padded_size = ADD_ALIGNMENT_PADDING(record.allocation_size);
+		bool retried = false;
+	reloop:
+		pool_header_t *head = (record.align > ALIGNMENT)
+		                              ? find_or_create_aligned_header(padded_size, record.align)
+		                              : find_or_create_new_header(padded_size);
+		if (head == nullptr && !retried) {
+			constexpr u32 pool_overhead =
+				STRUCT_SIZE_POOL + (STRUCT_SIZE_HEADER * 2) + (DEADZONE_SIZE * 2) + 64;
+			if (pool_init(padded_size + record.align + MIN_FREE_CHUNK + pool_overhead) == nullptr) {
+				return 1;
+			}
+			retried = true;
+			goto reloop;
+		}
+		if (head == nullptr) {
+			return 1;
+		}
+
+		head->handle_matrix_index = record.matrix_index;
+		head->bitflags = (head->bitflags & ~F_ZEROED) | (record.bitflags & SNAPSHOT_KEPT_FLAGS);
+		entry->header = head;
+		if (persist_read(fd, return_block(head), record.allocation_size) != 0) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+
+syn_arena_t *syn_arena_restore(const int fd)
+{
+	snapshot_header_t header;
+	if (fd < 0 || persist_read(fd, &header, sizeof(header)) != 0) {
+		return nullptr;
+	}
+	if (header.magic != SNAPSHOT_MAGIC || header.version != SNAPSHOT_VERSION || header.pool_count == 0) {
+		sync_alloc_log.to_console(log_stderr, "syn_arena_restore(): not a sync_alloc snapshot!\n");
+		return nullptr;
+	}
+	config_load();
+
+	// Scratch for the pool records and where each pool landed, freed before returning.
+	const usize scratch_size = ALIGN_PTR((sizeof(snapshot_pool_t) + sizeof(memory_pool_t *)) * header.pool_count,
+	                                     4 * KIBIBYTE);
+	snapshot_pool_t *records = syn_map_page(scratch_size);
+	if (records == nullptr) {
+		return nullptr;
+	}
+	memory_pool_t **pools = (memory_pool_t **)(records + header.pool_count);
+
+	arena_t *prev_arena = arena_thread;
+	arena_t *arena = nullptr;
+	if (snapshot_read_pools(fd, records, pools, header.pool_count) != 0) {
+		goto restore_failure;
+	}
+
+	arena = pools[0]->heap_base;
+	arena->first_mempool = pools[0];
+	arena->first_hp_pool = nullptr;
+	arena->total_arena_bytes = 0;
+	for (u32 i = 0; i < header.pool_count; i++) {
+		arena->total_arena_bytes += records[i].map_size;
+	}
+	arena->scope_pool = nullptr;
+	arena->scope_offset = 0;
+	arena->scope_depth = 0;
+	arena->quarantine = nullptr;
+	arena->quarantine_bytes = 0;
+	for (u32 i = 0; i < SLAB_CLASS_COUNT; i++) {
+		arena->slab_partial[i] = nullptr;
+	}
+	arena->slabs = nullptr;
+	arena->slab_meta = (header.slab_meta != 0);
+	arena->persist = nullptr;
+	arena->growbufs = nullptr;
+	arena->limit_bytes = alloc_config.arena_limit;
+	arena->first_hdl_tbl = nullptr;
+	arena->table_slab = nullptr;
+	arena->table_count = 0;
+	arena->hdl_high_water = 0;
+	arena->tombstones = nullptr;
+	arena->pool_count = header.pool_count;
+
+	arena_thread = arena;
+	if (snapshot_read_tables(fd, &header, records, pools) != 0 || snapshot_read_blocks(fd, &header) != 0) {
+		syn_destroy();
+		arena = nullptr;
+		goto restore_failure;
+	}
+	arena_thread = prev_arena;
+	syn_unmap_page(records, scratch_size);
+	return arena;
+
+restore_failure:
+	arena_thread = prev_arena;
+	syn_unmap_page(records, scratch_size);
+	sync_alloc_log.to_console(log_stderr, "syn_arena_restore(): snapshot is truncated or corrupt!\n");
+	return nullptr;
+}
+
+#endif
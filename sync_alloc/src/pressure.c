@@ -0,0 +1,91 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#include "pressure.h"
+#include "alloc_utils.h"
+#include "config.h"
+#include "globals.h"
+#include "region_cache.h"
+#include "structs.h"
+#include "sync_alloc.h"
+#include "types.h"
+#include <stdatomic.h>
+#include <stdint.h>
+
+static _Atomic usize process_limit = 0;
+static _Atomic(syn_pressure_fn) pressure_fn = nullptr;
+static _Atomic(void *) pressure_user_data = nullptr;
+
+// The callback may allocate, and that allocation must not call it again.
+static _Thread_local bool pressure_in_callback = false;
+
+
+static inline pressure_status_t pressure_against(const usize bytes, const usize limit_bytes)
+{
+	if (limit_bytes == 0) {
+		return PRESSURE_NONE;
+	}
+	if (bytes > limit_bytes) {
+		return PRESSURE_OVER;
+	}
+	return (bytes > limit_bytes - (limit_bytes / PRESSURE_NEAR_DIVISOR)) ? PRESSURE_NEAR : PRESSURE_NONE;
+}
+
+
+void pressure_set_process_limit(const usize limit_bytes)
+{
+	atomic_store_explicit(&process_limit, limit_bytes, memory_order_relaxed);
+}
+
+
+pressure_status_t pressure_check(const usize map_bytes)
+{
+	pressure_status_t status = PRESSURE_NONE;
+	if (arena_thread != nullptr) {
+		status = pressure_against(arena_thread->total_arena_bytes + map_bytes, arena_thread->limit_bytes);
+	}
+
+	const usize limit_bytes = atomic_load_explicit(&process_limit, memory_order_relaxed);
+	const pressure_status_t process_status = pressure_against(region_cache_live_bytes() + map_bytes, limit_bytes);
+	return (process_status > status) ? process_status : status;
+}
+
+
+void pressure_relieve(const syn_pressure_t reason, const usize request_bytes, const usize map_bytes)
+{
+	const usize limit_bytes = atomic_load_explicit(&process_limit, memory_order_relaxed);
+	if (reason == SYN_PRESSURE_OOM ||
+	    pressure_against(region_cache_live_bytes() + map_bytes, limit_bytes) != PRESSURE_NONE) {
+		region_cache_trim(SIZE_MAX);
+	} else {
+		region_cache_trim(map_bytes);
+	}
+
+	const syn_pressure_fn fn = atomic_load_explicit(&pressure_fn, memory_order_acquire);
+	if (fn == nullptr || pressure_in_callback) {
+		return;
+	}
+	pressure_in_callback = true;
+	fn(arena_thread, reason, request_bytes, atomic_load_explicit(&pressure_user_data, memory_order_relaxed));
+	pressure_in_callback = false;
+}
+
+
+void syn_set_limit(syn_arena_t *arena, const size_t limit_bytes)
+{
+	if (arena == nullptr) {
+		config_override_begin();
+		alloc_config.process_limit = limit_bytes;
+		pressure_set_process_limit(limit_bytes);
+		return;
+	}
+	arena->limit_bytes = limit_bytes;
+}
+
+
+void syn_set_pressure_callback(const syn_pressure_fn fn, void *user_data)
+{
+	atomic_store_explicit(&pressure_user_data, user_data, memory_order_relaxed);
+	atomic_store_explicit(&pressure_fn, fn, memory_order_release);
+}
@@ -0,0 +1,168 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#include "region_cache.h"
+#include "alloc_init.h"
+#include "config.h"
+#include "defs.h"
+#include "globals.h"
+#include "types.h"
+#include <stdatomic.h>
+#include <stdbit.h>
+#include <stdint.h>
+
+/* The link lives in the first bytes of the retired region itself.	*/
+typedef struct Cached_Region {
+	struct Cached_Region *next_region;	/**< Next region in the bucket.		*/
+	usize bytes;				/**< Page-rounded size of the region.	*/
+	usize dirty_bytes;			/**< Leading bytes that were written.	*/
+} cached_region_t;
+
+typedef struct Region_Bucket {
+	atomic_flag lock;
+	cached_region_t *first_region;
+} __attribute__((aligned(64))) region_bucket_t;
+
+static region_bucket_t region_buckets[REGION_CACHE_BUCKETS];
+static _Atomic usize region_cache_bytes = 0;
+static _Atomic usize region_live_bytes = 0;
+
+
+static inline usize region_page_round(const usize bytes)
+{
+	return ALIGN_PTR(bytes, 4 * KIBIBYTE);
+}
+
+
+/// Buckets are powers of two from a single page up, the last one takes everything bigger.
+static inline u32 region_bucket_index(const usize bytes)
+{
+	const u32 width = (u32)stdc_bit_width_ull(bytes - 1);
+	if (width <= 12) {
+		return 0;
+	}
+	return (width - 12 < REGION_CACHE_BUCKETS) ? width - 12 : REGION_CACHE_BUCKETS - 1;
+}
+
+
+static inline void region_bucket_lock(region_bucket_t *bucket)
+{
+	while (atomic_flag_test_and_set_explicit(&bucket->lock, memory_order_acquire)) {
+		__builtin_ia32_pause();
+	}
+}
+
+
+static inline void region_bucket_unlock(region_bucket_t *bucket)
+{
+	atomic_flag_clear_explicit(&bucket->lock, memory_order_release);
+}
+
+
+void *region_cache_map(const usize bytes, usize *dirty_bytes)
+{
+	const usize map_bytes = region_page_round(bytes);
+	*dirty_bytes = 0;
+
+	if (atomic_load_explicit(&region_cache_bytes, memory_order_relaxed) == 0) {
+		goto map_new;
+	}
+
+	region_bucket_t *bucket = &region_buckets[region_bucket_index(map_bytes)];
+	region_bucket_lock(bucket);
+
+	cached_region_t **link = &bucket->first_region;
+	while (*link != nullptr && (*link)->bytes != map_bytes) {
+		link = &(*link)->next_region;
+	}
+	cached_region_t *region = *link;
+	if (region != nullptr) {
+		*link = region->next_region;
+	}
+	region_bucket_unlock(bucket);
+
+	if (region != nullptr) {
+		atomic_fetch_sub_explicit(&region_cache_bytes, map_bytes, memory_order_relaxed);
+		atomic_fetch_add_explicit(&region_live_bytes, map_bytes, memory_order_relaxed);
+		*dirty_bytes = region->dirty_bytes;
+		return region;
+	}
+
+map_new:
+	void *mem = syn_map_page(map_bytes);
+	if (mem != nullptr) {
+		atomic_fetch_add_explicit(&region_live_bytes, map_bytes, memory_order_relaxed);
+	}
+	return mem;
+}
+
+
+void region_cache_unmap(void *mem, const usize bytes, const usize dirty_bytes)
+{
+	const usize map_bytes = region_page_round(bytes);
+	atomic_fetch_sub_explicit(&region_live_bytes, map_bytes, memory_order_relaxed);
+
+	// Reserve the bytes first, so racing retirements can not overshoot the budget together.
+	const usize cached = atomic_fetch_add_explicit(&region_cache_bytes, map_bytes, memory_order_relaxed);
+	if (cached + map_bytes > alloc_config.cache_budget) {
+		atomic_fetch_sub_explicit(&region_cache_bytes, map_bytes, memory_order_relaxed);
+		syn_unmap_page(mem, map_bytes);
+		return;
+	}
+
+	cached_region_t *region = mem;
+	region->bytes = map_bytes;
+	region->dirty_bytes = (dirty_bytes > sizeof(cached_region_t)) ? dirty_bytes : sizeof(cached_region_t);
+	if (region->dirty_bytes > map_bytes) {
+		region->dirty_bytes = map_bytes;
+	}
+
+	region_bucket_t *bucket = &region_buckets[region_bucket_index(map_bytes)];
+	region_bucket_lock(bucket);
+	region->next_region = bucket->first_region;
+	bucket->first_region = region;
+	region_bucket_unlock(bucket);
+}
+
+
+void region_cache_account(const usize old_bytes, const usize new_bytes)
+{
+	atomic_fetch_add_explicit(&region_live_bytes, region_page_round(new_bytes), memory_order_relaxed);
+	atomic_fetch_sub_explicit(&region_live_bytes, region_page_round(old_bytes), memory_order_relaxed);
+}
+
+
+usize region_cache_live_bytes()
+{
+	return atomic_load_explicit(&region_live_bytes, memory_order_relaxed);
+}
+
+
+usize region_cache_trim(const usize want_bytes)
+{
+	usize trimmed_bytes = 0;
+
+	// Biggest buckets first, so a partial trim takes the fewest munmap() calls.
+	for (u32 i = REGION_CACHE_BUCKETS; i-- > 0 && trimmed_bytes < want_bytes;) {
+		region_bucket_t *bucket = &region_buckets[i];
+		while (trimmed_bytes < want_bytes) {
+			region_bucket_lock(bucket);
+			cached_region_t *region = bucket->first_region;
+			if (region != nullptr) {
+				bucket->first_region = region->next_region;
+			}
+			region_bucket_unlock(bucket);
+			if (region == nullptr) {
+				break;
+			}
+
+			// The region is unlinked, so the unmap runs without holding the bucket's lock.
+			const usize region_bytes = region->bytes;
+			atomic_fetch_sub_explicit(&region_cache_bytes, region_bytes, memory_order_relaxed);
+			syn_unmap_page(region, region_bytes);
+			trimmed_bytes += region_bytes;
+		}
+	}
+	return trimmed_bytes;
+}
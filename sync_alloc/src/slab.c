@@ -2,4 +2,239 @@
 // Created by SyncShard on 11/15/25.
 //
 
-#include "slab.h"
\ No newline at end of file
+#include "slab.h"
+#include "alloc_utils.h"
+#include "defs.h"
+#include "globals.h"
+#include "structs.h"
+#include "types.h"
+#include <stdatomic.h>
+#include <stdbit.h>
+#include <stdint.h>
+#include <sys/mman.h>
+
+_Atomic(uintptr_t) slab_region = 0;
+
+static _Atomic bool slab_layout = false;
+static _Atomic u32 slab_hint = 0;
+
+/* One bit per chunk of the region, claimed chunks are published by the acquire on it	*
+ * and every chunk is dropped before its bit is released, so a claim always starts zeroed.	*/
+static _Atomic u64 slab_used[SLAB_CHUNK_COUNT / 64];
+
+
+[[gnu::cold]]
+static uintptr_t slab_region_init()
+{
+	void *mem = mmap(nullptr,
+	                 SLAB_REGION_SIZE,
+	                 PROT_READ | PROT_WRITE,
+	                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+	                 -1,
+	                 0);
+	if (mem == MAP_FAILED) {
+		return 0;
+	}
+
+	uintptr_t region = 0;
+	if (!atomic_compare_exchange_strong_explicit(&slab_region,
+	                                             &region,
+	                                             (uintptr_t)mem,
+	                                             memory_order_acq_rel,
+	                                             memory_order_acquire)) {
+		// Another thread mapped the region first.
+		munmap(mem, SLAB_REGION_SIZE);
+		return region;
+	}
+	return (uintptr_t)mem;
+}
+
+
+static u32 slab_claim_chunk()
+{
+	constexpr u32 used_words = SLAB_CHUNK_COUNT / 64;
+	const u32 start = atomic_load_explicit(&slab_hint, memory_order_relaxed);
+
+	for (u32 i = 0; i < used_words; i++) {
+		const u32 word = (start + i) % used_words;
+		u64 used = atomic_load_explicit(&slab_used[word], memory_order_relaxed);
+
+		while (~used != 0) {
+			const u32 bit = stdc_trailing_zeros_ull(~used);
+			if (atomic_compare_exchange_weak_explicit(&slab_used[word],
+			                                          &used,
+			                                          used | (1ULL << bit),
+			                                          memory_order_acquire,
+			                                          memory_order_relaxed)) {
+				atomic_store_explicit(&slab_hint, word, memory_order_relaxed);
+				return (word * 64) + bit;
+			}
+		}
+	}
+	return UINT32_MAX;
+}
+
+
+static void slab_release_chunk(slab_t *slab)
+{
+	const uintptr_t region = atomic_load_explicit(&slab_region, memory_order_relaxed);
+	const u32 chunk = (u32)(((uintptr_t)slab - region) / SLAB_CHUNK_SIZE);
+
+	madvise(slab, SLAB_CHUNK_SIZE, MADV_DONTNEED);
+	atomic_fetch_and_explicit(&slab_used[chunk / 64], ~(1ULL << (chunk % 64)), memory_order_release);
+}
+
+
+static slab_t *slab_create(const u32 size)
+{
+	uintptr_t region = atomic_load_explicit(&slab_region, memory_order_acquire);
+	if (region == 0 && (region = slab_region_init()) == 0) {
+		return nullptr;
+	}
+
+	const u32 chunk = slab_claim_chunk();
+	if (chunk == UINT32_MAX) {
+		return nullptr;
+	}
+	slab_t *slab = (slab_t *)(region + ((usize)chunk * SLAB_CHUNK_SIZE));
+
+	// The cache line of slack covers aligning the payloads after the side array.
+	const u32 block_count = (SLAB_CHUNK_SIZE - sizeof(slab_t) - 64) / (STRUCT_SIZE_HEADER + size);
+
+	slab->arena = arena_thread;
+	slab->block_size = size;
+	slab->block_count = block_count;
+	slab->bump = 0;
+	slab->free_count = 0;
+	slab->payload_offset = ALIGN_PTR(sizeof(slab_t) + ((usize)block_count * STRUCT_SIZE_HEADER), 64);
+	slab->partial = true;
+
+	const u32 size_class = (size - MINIMUM_BLOCK_ALLOC) / ALIGNMENT;
+	slab->next_partial = arena_thread->slab_partial[size_class];
+	arena_thread->slab_partial[size_class] = slab;
+	slab->next_owned = arena_thread->slabs;
+	arena_thread->slabs = slab;
+
+	return slab;
+}
+
+
+pool_header_t *slab_alloc(const u32 size)
+{
+	const u32 size_class = (size - MINIMUM_BLOCK_ALLOC) / ALIGNMENT;
+
+	slab_t *slab = arena_thread->slab_partial[size_class];
+	if (slab == nullptr && (slab = slab_create(size)) == nullptr) {
+		return nullptr;
+	}
+
+	u32 idx;
+	bit32 zeroed = 0;
+	if (slab->free_count != 0) {
+		u32 word = 0;
+		while (slab->free_map[word] == 0) {
+			word++;
+		}
+		const u32 bit = stdc_trailing_zeros_ull(slab->free_map[word]);
+		slab->free_map[word] &= ~(1ULL << bit);
+		slab->free_count--;
+		idx = (word * 64) + bit;
+	} else {
+		idx = slab->bump++;
+		zeroed = F_ZEROED;
+	}
+
+	// Full slabs are only found again through their blocks, when one of them is freed.
+	if (slab->free_count == 0 && slab->bump == slab->block_count) {
+		arena_thread->slab_partial[size_class] = slab->next_partial;
+		slab->next_partial = nullptr;
+		slab->partial = false;
+	}
+
+	pool_header_t *head = &slab->meta[idx];
+	head->allocation_size = size;
+	head->chunk_size = size;
+	#ifndef SYN_USE_RAW
+	head->handle_matrix_index = 0;
+	#else
+	head->magic = RAW_HEADER_MAGIC;
+	#endif
+	head->bitflags = (F_ALLOCATED | F_SLAB_BLOCK | zeroed);
+
+	return head;
+}
+
+
+void slab_free(pool_header_t *head)
+{
+	slab_t *slab = slab_of(head);
+	const u32 idx = (u32)(head - slab->meta);
+
+	head->bitflags = (F_FREE | F_SLAB_BLOCK);
+	slab->free_map[idx / 64] |= (1ULL << (idx % 64));
+	slab->free_count++;
+
+	if (!slab->partial) {
+		const u32 size_class = (slab->block_size - MINIMUM_BLOCK_ALLOC) / ALIGNMENT;
+		slab->next_partial = slab->arena->slab_partial[size_class];
+		slab->arena->slab_partial[size_class] = slab;
+		slab->partial = true;
+	}
+}
+
+
+int slab_check(const void *block_ptr)
+{
+	const uintptr_t region = atomic_load_explicit(&slab_region, memory_order_relaxed);
+	const u32 chunk = (u32)(((uintptr_t)block_ptr - region) / SLAB_CHUNK_SIZE);
+	const u64 used = atomic_load_explicit(&slab_used[chunk / 64], memory_order_acquire);
+
+	// An unclaimed chunk reads as zeroes, so block_size has to be checked before dividing by it.
+	const slab_t *slab = slab_of(block_ptr);
+	if (!(used & (1ULL << (chunk % 64))) || slab->block_size == 0) {
+		return 1;
+	}
+
+	const uintptr_t payload = (uintptr_t)slab + slab->payload_offset;
+	if ((uintptr_t)block_ptr < payload || ((uintptr_t)block_ptr - payload) % slab->block_size != 0) {
+		return 1;
+	}
+	return (((uintptr_t)block_ptr - payload) / slab->block_size >= slab->bump) ? 1 : 0;
+}
+
+
+arena_t *slab_owner(const pool_header_t *head)
+{
+	return slab_of(head)->arena;
+}
+
+
+void slab_release_arena(arena_t *arena)
+{
+	for (u32 size_class = 0; size_class < SLAB_CLASS_COUNT; size_class++) {
+		arena->slab_partial[size_class] = nullptr;
+	}
+
+
+	// Full slabs are on no partial list, so every owned one is walked from the arena's own list.
+	slab_t *slab = arena->slabs;
+	arena->slabs = nullptr;
+	while (slab != nullptr) {
+		// Releasing the chunk drops the slab struct with it.
+		slab_t *next_slab = slab->next_owned;
+		slab_release_chunk(slab);
+		slab = next_slab;
+	}
+}
+
+
+bool slab_default_layout()
+{
+	return atomic_load_explicit(&slab_layout, memory_order_relaxed);
+}
+
+
+void slab_set_default_layout(const bool out_of_line)
+{
+	atomic_store_explicit(&slab_layout, out_of_line, memory_order_relaxed);
+}
@@ -0,0 +1,12 @@
+//
+// Created by SyncShard on 10/19/26.
+//
+
+#include "trace.h"
+
+#ifdef SYN_TRACE_SDT
+// The notes of sys/sdt.h point the tracer at these, it lives in .probes like the ones dtrace -G generates.
+#define SYN_TRACE_SEMAPHORE(name) [[gnu::section(".probes")]] unsigned short sync_alloc_##name##_semaphore = 0;
+SYN_TRACE_PROBES(SYN_TRACE_SEMAPHORE)
+#undef SYN_TRACE_SEMAPHORE
+#endif
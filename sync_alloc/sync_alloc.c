@@ -6,11 +6,19 @@
 #include "sync_alloc.h"
 #include "alloc_init.h"
 #include "alloc_utils.h"
+#include "config.h"
 #include "debug.h"
 #include "defs.h"
 #include "free_node.h"
 #include "globals.h"
+#include "growbuf.h"
+#include "guard_page.h"
+#include "huge_page.h"
 #include "internal_alloc.h"
+#include "persist.h"
+#include "pressure.h"
+#include "slab.h"
+#include "trace.h"
 #include "structs.h"
 #include "syn_memops.h"
 #include "types.h"
@@ -19,27 +27,450 @@
 #include "handle.h"
 #endif
 
+#include <stdatomic.h>
 #include <stdint.h>
 
+#ifdef SYN_USE_RAW
+#include <pthread.h>
+#endif
+
+
+typedef enum Pool_Growth : u32 {
+	GROWTH_OK,
+	GROWTH_FAILED,		/**< The arena can not take a pool this big, relief would not help.	*/
+	GROWTH_OVER_LIMIT,	/**< The pool would go past a soft limit.				*/
+	GROWTH_NO_MEMORY,	/**< mmap() refused the pool.						*/
+} pool_growth_t;
+
+static void relieve_pressure(syn_pressure_t reason, usize request_bytes, usize map_bytes);
+static int thread_arena_init();
+
 
-static inline int pool_constructor(const usize size)
+/**
+ * Maps the next pool of arena_thread, sized by the growth factor and big enough for the block.
+ *
+ * @param size Bytes the block needs, with any alignment gap.
+ * @param map_bytes Set to the size of the pool, whether it could be mapped or not.
+ * @return GROWTH_OK if the pool was added.
+ */
+static inline pool_growth_t pool_constructor(const usize size, usize *map_bytes)
 {
+	/* The new pool has to fit its own struct, the cache alignment slack, the block's	*
+	 * header and deadzone, and the sentinel header that trails the block.		*/
+	constexpr u64 pool_overhead =
+		STRUCT_SIZE_POOL + (STRUCT_SIZE_HEADER * 2) + (DEADZONE_SIZE * 2) + 64;
+
+	// A file-backed arena is the one pool its file holds.
+	if (arena_thread->persist != nullptr) {
+		return GROWTH_FAILED;
+	}
+
 	memory_pool_t *pool[arena_thread->pool_count + 1];
 	const int pool_arr_len = return_pool_array(pool);
-	u64 new_pool_size = pool[pool_arr_len - 1]->size * 2;
+	const u64 required_size = ADD_ALIGNMENT_PADDING((u64)size) + pool_overhead;
+	const u64 growth = alloc_config.pool_growth;
+	u64 new_pool_size = (u64)pool[pool_arr_len - 1]->size * growth;
 
-	while (new_pool_size < ADD_ALIGNMENT_PADDING(size)) {
-		if (new_pool_size * 2 >= MAX_POOL_SIZE) {
-			return 1;
+	if (new_pool_size > MAX_POOL_SIZE) {
+		new_pool_size = MAX_POOL_SIZE;
+	}
+	while (new_pool_size < required_size) {
+		if (new_pool_size * growth > MAX_POOL_SIZE) {
+			return GROWTH_FAILED;
 		}
-		new_pool_size *= 2;
+		new_pool_size *= growth;
 	}
 
-	pool[pool_arr_len] = pool_init(pool[pool_arr_len - 1]->size * 2);
+	*map_bytes = new_pool_size;
+	const pressure_status_t pressure = pressure_check(new_pool_size);
+	if (pressure == PRESSURE_OVER) {
+		return GROWTH_OVER_LIMIT;
+	}
+	pool[pool_arr_len] = pool_init(new_pool_size);
 	if (pool[pool_arr_len] == nullptr) {
+		return GROWTH_NO_MEMORY;
+	}
+	if (pressure == PRESSURE_NEAR) {
+		relieve_pressure(SYN_PRESSURE_NEAR, size, 0);
+	}
+	return GROWTH_OK;
+}
+
+
+/**
+ * Core allocation path shared by the handle and raw APIs.
+ * Initializes the arena if needed, then finds or carves a block, growing the pools once.
+ * If the pools can not grow for lack of memory, pressure relief runs and the search is retried once.
+ *
+ * @param size User-requested size.
+ * @param align Payload alignment, anything up to ALIGNMENT takes the normal path.
+ * @return The header of the new block, or nullptr if the allocation cannot be served.
+ */
+static pool_header_t *alloc_header(const usize size, const usize align)
+{
+	if (size == 0 || size >= MAX_POOL_SIZE) {
+		return nullptr;
+	}
+	if ((align & (align - 1)) != 0 || align > MAX_ALLOC_ALIGN) {
+		return nullptr;
+	}
+	if (arena_thread != nullptr) {
+		goto arena_initialized;
+	}
+	if (thread_arena_init() != 0) {
+		sync_alloc_log.to_console(log_stderr, "OOM\n");
+		return nullptr;
+	}
+
+arena_initialized:
+
+	const u32 padded_size = (size < MINIMUM_BLOCK_ALLOC)
+	                                ? ADD_ALIGNMENT_PADDING(MINIMUM_BLOCK_ALLOC)
+	                                : ADD_ALIGNMENT_PADDING((u32)size);
+
+	/* Scopes roll back by rewinding pools, so sampled blocks would outlive them,	*
+	 * and a guarded block of a file-backed arena would not be in its file.		*/
+	const bool may_sample = (arena_thread->scope_depth == 0 && arena_thread->persist == nullptr);
+	const bool over_aligned = (align > ALIGNMENT);
+	if (may_sample && guard_should_sample()) {
+		/* Unpadded and aligned no further than the size allows, so the first byte past it faults.	*
+		 * An object never needs more alignment than the largest power of two its size is a multiple of. */
+		const u32 guard_align = over_aligned ? (u32)align : 1U << stdc_trailing_zeros_ull(size | ALIGNMENT);
+		pool_header_t *guarded_head = guard_alloc((u32)size, guard_align);
+		if (guarded_head != nullptr) {
+			guarded_head->bitflags |= over_aligned ? F_OVER_ALIGNED : 0;
+			return guarded_head;
+		}
+	}
+
+	// Slabs are only reclaimed by a reset, so a scope pop could not roll them back.
+	const bool slab_fits = (padded_size <= alloc_config.slab_max_size && align <= ALIGNMENT);
+	if (arena_thread->slab_meta && slab_fits && arena_thread->scope_depth == 0) {
+		pool_header_t *slab_head = slab_alloc(padded_size);
+		if (slab_head != nullptr) {
+			return slab_head;
+		}
+	}
+
+	bool retried = false;
+	bool relieved = false;
+reloop:
+	pool_header_t *new_head = over_aligned
+	                                  ? find_or_create_aligned_header(padded_size, (u32)align)
+	                                  : find_or_create_new_header(padded_size);
+	if (!new_head && retried) {
+		return nullptr;
+	}
+	if (new_head == nullptr) {
+		// Worst case the leading gap is a whole alignment step on top of the smallest free chunk.
+		const usize gap_bytes = over_aligned ? align + MIN_FREE_CHUNK : 0;
+		usize map_bytes = 0;
+		const pool_growth_t growth = pool_constructor(size + gap_bytes, &map_bytes);
+		if (growth == GROWTH_OK) {
+			retried = true;
+			goto reloop;
+		}
+		if (growth == GROWTH_FAILED || relieved) {
+			return nullptr;
+		}
+		// Relief can free blocks that fit as well as room for the pool, so both are tried again.
+		relieve_pressure((growth == GROWTH_OVER_LIMIT) ? SYN_PRESSURE_LIMIT : SYN_PRESSURE_OOM, size, map_bytes);
+		relieved = true;
+		goto reloop;
+	}
+	new_head->bitflags |= over_aligned ? F_OVER_ALIGNED : 0;
+	return new_head;
+}
+
+
+/// Core growbuf path shared by the handle and raw APIs, initializes the arena if needed.
+static pool_header_t *alloc_growbuf_header(const usize max_bytes)
+{
+	if (arena_thread == nullptr && thread_arena_init() != 0) {
+		sync_alloc_log.to_console(log_stderr, "OOM\n");
+		return nullptr;
+	}
+	// A scope pop could not roll a growbuf back, and it would not be in a file-backed arena's file.
+	if (arena_thread->scope_depth != 0 || arena_thread->persist != nullptr) {
+		return nullptr;
+	}
+	return growbuf_alloc(max_bytes);
+}
+
+
+static inline bool block_in_scope(const pool_header_t *head)
+{
+	const memory_pool_t *scope_pool = arena_thread->scope_pool;
+	if (arena_thread->scope_depth == 0 || scope_pool == nullptr) {
+		return false;
+	}
+
+	const memory_pool_t *pool = return_pool(head);
+	if (pool->pool_id != scope_pool->pool_id) {
+		return pool->pool_id > scope_pool->pool_id;
+	}
+	return ((uintptr_t)head - (uintptr_t)pool->mem) >= arena_thread->scope_offset;
+}
+
+
+/**
+ * True if a block made before the open scope would have to move to be reallocated.
+ * The copy would be bumped above the mark, so the pop would reclaim it while its owner
+ * still holds it, these reallocs are refused until the scope is popped.
+ */
+static bool realloc_escapes_scope(const pool_header_t *head)
+{
+	if (arena_thread == nullptr || arena_thread->scope_depth == 0) {
+		return false;
+	}
+	// Guarded blocks, slab blocks and growbufs are never made inside a scope.
+	if (head->bitflags & (F_GUARDED | F_SLAB_BLOCK | F_GROWBUF)) {
+		return true;
+	}
+	return return_arena(head) != arena_thread || !block_in_scope(head);
+}
+
+
+/// Hands a dead chunk back to its pool's free list, unless a scope pop will reclaim it.
+static void recycle_header(pool_header_t *head)
+{
+	if (head->bitflags & F_SLAB_BLOCK) {
+		slab_free(head);
+		return;
+	}
+	head->bitflags |= F_FREE;
+
+	pool_free_node_t *node = (pool_free_node_t *)head;
+	node->next_node = nullptr;
+
+	// Blocks above the outermost scope mark are reclaimed by the pop, they must never be on a free list.
+	if (!block_in_scope(head)) {
+		free_node_add(node);
+	}
+
+	update_sentinel_and_free_flags(head);
+}
+
+
+/**
+ * Flags a block sensitive, and its pool as one whose pages are dropped before the region is cached.
+ * Guarded, slab and growbuf blocks have no pool, their memory is already dropped when it is released.
+ */
+static void mark_header_sensitive(pool_header_t *head)
+{
+	head->bitflags |= F_SENSITIVE;
+	if (!(head->bitflags & (F_GUARDED | F_SLAB_BLOCK | F_GROWBUF))) {
+		return_pool(head)->held_sensitive = true;
+	}
+}
+
+
+/**
+ * Scrubs every quarantined block in one batch and only then makes them reusable.
+ * Past the LLC threshold syn_memset streams, so a large scrub does not evict live data.
+ */
+static void quarantine_flush()
+{
+	void *block_ptr = arena_thread->quarantine;
+	arena_thread->quarantine = nullptr;
+	arena_thread->quarantine_bytes = 0;
+
+	while (block_ptr != nullptr) {
+		void *next_ptr = *(void **)block_ptr;
+		pool_header_t *head = return_header(block_ptr);
+
+		syn_memset_explicit(block_ptr, 0, head->allocation_size);
+		head->bitflags &= ~(F_SENSITIVE | F_RECENT_FREE);
+		recycle_header(head);
+		block_ptr = next_ptr;
+	}
+}
+
+
+/**
+ * Parks a freed sensitive block until the next batch scrub, so the free itself stays cheap.
+ * The block is neither allocated nor free meanwhile, so nothing can hand it out again.
+ * The link is stored in the dead payload, which the scrub overwrites anyway.
+ */
+static void quarantine_push(pool_header_t *head)
+{
+	void *block_ptr = return_block(head);
+
+	head->bitflags |= F_RECENT_FREE;
+	*(void **)block_ptr = arena_thread->quarantine;
+	arena_thread->quarantine = block_ptr;
+	arena_thread->quarantine_bytes += head->allocation_size;
+
+	if (arena_thread->quarantine_bytes >= alloc_config.quarantine_budget) {
+		quarantine_flush();
+	}
+}
+
+
+/**
+ * Core free path shared by the handle and raw APIs.
+ * Quarantines sensitive blocks, everything else goes straight back to its pool's free list.
+ * Guarded blocks give their slot back instead, the dropped page needs no scrub.
+ * Growbufs are unmapped whole, for the same reason.
+ */
+static void release_header(pool_header_t *head)
+{
+	if (head->bitflags & F_GUARDED) {
+		guard_free(head);
+		return;
+	}
+	if (head->bitflags & F_GROWBUF) {
+		growbuf_free(head);
+		return;
+	}
+	head->bitflags &= ~(F_ALLOCATED | F_FROZEN | F_ZEROED);
+
+	if (head->bitflags & F_SENSITIVE) {
+		quarantine_push(head);
+		return;
+	}
+	recycle_header(head);
+}
+
+
+#ifdef SYN_USE_RAW
+
+/**
+ * Pushes a block owned by another thread's arena onto that arena's remote free list.
+ * The link is stored in the dead payload, the header belongs to the owning thread.
+ * The caller has claimed the block by swapping its magic, the drain swaps it back.
+ */
+static void remote_free_push(arena_t *owner, void *block_ptr)
+{
+	void *old_first = atomic_load_explicit(&owner->remote_free, memory_order_relaxed);
+	do {
+		*(void **)block_ptr = old_first;
+	} while (!atomic_compare_exchange_weak_explicit(&owner->remote_free,
+	                                                &old_first,
+	                                                block_ptr,
+	                                                memory_order_release,
+	                                                memory_order_relaxed));
+}
+
+
+static void drain_remote_frees()
+{
+	void *block_ptr =
+		atomic_exchange_explicit(&arena_thread->remote_free, nullptr, memory_order_acquire);
+
+	while (block_ptr != nullptr) {
+		void *next_ptr = *(void **)block_ptr;
+		pool_header_t *head = return_header(block_ptr);
+		head->magic = RAW_HEADER_MAGIC;
+		release_header(head);
+		block_ptr = next_ptr;
+	}
+}
+
+
+/* Arenas of exited threads, other threads may still hold their blocks, so they are kept	*
+ * whole and handed to the next thread that needs an arena instead of being destroyed.	*/
+static arena_t *arena_orphans = nullptr;
+static atomic_flag orphan_lock = ATOMIC_FLAG_INIT;
+static pthread_key_t orphan_key;
+static pthread_once_t orphan_key_once = PTHREAD_ONCE_INIT;
+
+
+static inline void orphan_list_lock()
+{
+	while (atomic_flag_test_and_set_explicit(&orphan_lock, memory_order_acquire)) {
+		__builtin_ia32_pause();
+	}
+}
+
+
+static inline void orphan_list_unlock()
+{
+	atomic_flag_clear_explicit(&orphan_lock, memory_order_release);
+}
+
+
+/**
+ * Thread-exit destructor of the thread arena.
+ * Folds the remote frees and the quarantine back in, so the arena is parked with only
+ * blocks that are really live, and its scope marks died with the thread.
+ */
+static void arena_orphan(void *arena)
+{
+	arena_thread = arena;
+	drain_remote_frees();
+	quarantine_flush();
+	arena_thread->scope_pool = nullptr;
+	arena_thread->scope_offset = 0;
+	arena_thread->scope_depth = 0;
+
+	orphan_list_lock();
+	arena_thread->next_orphan = arena_orphans;
+	arena_orphans = arena_thread;
+	orphan_list_unlock();
+	arena_thread = nullptr;
+}
+
+
+static void orphan_key_create()
+{
+	if (pthread_key_create(&orphan_key, arena_orphan) != 0) {
+		syn_panic("could not create the thread-exit key!\n");
+	}
+}
+
+
+/// Drops the thread-exit hook of an arena that is being destroyed, so it is never parked.
+static void thread_arena_forget(const arena_t *arena)
+{
+	pthread_once(&orphan_key_once, orphan_key_create);
+	if (pthread_getspecific(orphan_key) == arena) {
+		pthread_setspecific(orphan_key, nullptr);
+	}
+}
+
+#endif
+
+
+/**
+ * Gives the calling thread its implicit arena.
+ * In raw mode a parked arena of an exited thread is adopted first, and the arena is
+ * registered to be parked in turn when this thread exits.
+ */
+static int thread_arena_init()
+{
+	#ifdef SYN_USE_RAW
+	pthread_once(&orphan_key_once, orphan_key_create);
+	orphan_list_lock();
+	arena_t *orphan = arena_orphans;
+	if (orphan != nullptr) {
+		arena_orphans = orphan->next_orphan;
+	}
+	orphan_list_unlock();
+
+	if (orphan != nullptr) {
+		// Frees queued while it was parked, the caller only drains an arena it already had.
+		arena_thread = orphan;
+		drain_remote_frees();
+	} else if (arena_init(0) != 0) {
 		return 1;
 	}
+	pthread_setspecific(orphan_key, arena_thread);
 	return 0;
+	#else
+	return arena_init(0);
+	#endif
+}
+
+
+/// Makes the arena's parked memory reusable, then hands over to the region cache and the application.
+static void relieve_pressure(const syn_pressure_t reason, const usize request_bytes, const usize map_bytes)
+{
+	#ifdef SYN_USE_RAW
+	drain_remote_frees();
+	#endif
+	quarantine_flush();
+	pressure_relieve(reason, request_bytes, map_bytes);
 }
 
 
@@ -48,10 +479,18 @@ void syn_destroy()
 	if (arena_thread == nullptr || (arena_thread->pool_count == 0)) {
 		return;
 	}
+	SYN_TRACE(arena_destroy, arena_thread->total_arena_bytes, arena_thread, arena_thread->pool_count);
+	quarantine_flush();
+	guard_release_arena(arena_thread);
+	slab_release_arena(arena_thread);
+	growbuf_release_arena(arena_thread);
 	#ifndef SYN_USE_RAW
+	tombstone_release_arena(arena_thread);
 	if (arena_thread->table_count > 0) {
 		table_destructor();
 	}
+	#else
+	thread_arena_forget(arena_thread);
 	#endif
 	if (arena_thread->pool_count > 0) {
 		pool_destructor();
@@ -68,120 +507,509 @@ void syn_reset()
 		return;
 	}
 
-	if (arena_thread->pool_count == 1) {
-		arena_thread->first_mempool->offset = 0;
-		arena_thread->first_mempool->free_count = 0;
-		arena_thread->first_mempool->first_free = nullptr;
-		table_destructor();
-		return;
+	// The first pool is kept, so its quarantined secrets have to be scrubbed before it is reused.
+	quarantine_flush();
+	guard_release_arena(arena_thread);
+	slab_release_arena(arena_thread);
+	growbuf_release_arena(arena_thread);
+
+	memory_pool_t *pool_arr[arena_thread->pool_count];
+	const int pool_arr_len = return_pool_array(pool_arr);
+
+	if (pool_arr_len == 0) {
+		return;
+	}
+	for (int i = pool_arr_len - 1; i > 0; i--) {
+		arena_thread->total_arena_bytes -= pool_mapped_bytes(pool_arr[i]);
+		pool_unmap(pool_arr[i]);
+	}
+
+	// Sensitive blocks still live at the reset are dropped unscrubbed, the next allocation would hand them out.
+	if (pool_arr[0]->held_sensitive) {
+		syn_memset_explicit(pool_arr[0]->mem, 0, pool_arr[0]->offset);
+		pool_arr[0]->held_sensitive = false;
+	}
+	pool_arr[0]->offset = 0;
+	pool_arr[0]->free_count = 0;
+	pool_arr[0]->next_pool = nullptr;
+	pool_arr[0]->first_free = nullptr;
+	arena_thread->pool_count = 1;
+	arena_thread->scope_pool = nullptr;
+	arena_thread->scope_offset = 0;
+	arena_thread->scope_depth = 0;
+
+	#ifndef SYN_USE_RAW
+	tombstone_release_arena(arena_thread);
+	table_destructor();
+	#else
+	// Anything still queued points into pools that were just reset or unmapped.
+	atomic_store_explicit(&arena_thread->remote_free, nullptr, memory_order_relaxed);
+	#endif
+}
+
+
+syn_scope_t syn_scope_push()
+{
+	if (arena_thread == nullptr && thread_arena_init() != 0) {
+		syn_panic("could not create an arena for syn_scope_push()!\n");
+	}
+
+	memory_pool_t *pool_arr[arena_thread->pool_count];
+	const int pool_arr_len = return_pool_array(pool_arr);
+	memory_pool_t *newest_pool = pool_arr[pool_arr_len - 1];
+
+	const syn_scope_t mark = {
+		.pool = newest_pool,
+		.offset = newest_pool->offset,
+	#ifndef SYN_USE_RAW
+		.handle_mark = arena_thread->hdl_high_water,
+	#else
+		.handle_mark = 0,
+	#endif
+		.depth = ++arena_thread->scope_depth,
+	};
+
+	if (mark.depth == 1) {
+		arena_thread->scope_pool = newest_pool;
+		arena_thread->scope_offset = newest_pool->offset;
+	}
+	return mark;
+}
+
+
+void syn_scope_pop(const syn_scope_t mark)
+{
+	if (arena_thread == nullptr) {
+		syn_panic("core arena context was lost!\n");
+	}
+	if (mark.depth == 0 || mark.depth > arena_thread->scope_depth || mark.pool == nullptr) {
+		sync_alloc_log.to_console(log_stderr, "syn_scope_pop() called with a stale mark!\n");
+		return;
+	}
+
+	#ifdef SYN_USE_RAW
+	// Queued remote frees may point above the mark, fold them back in while they are still valid.
+	drain_remote_frees();
+	#endif
+	// Quarantined blocks may sit above the mark, and the rewound memory is handed out again.
+	quarantine_flush();
+
+	memory_pool_t *pool = mark.pool->next_pool;
+	while (pool != nullptr) {
+		memory_pool_t *next_pool = pool->next_pool;
+
+		arena_thread->total_arena_bytes -= pool_mapped_bytes(pool);
+		arena_thread->pool_count--;
+		pool_unmap(pool);
+		pool = next_pool;
+	}
+	mark.pool->next_pool = nullptr;
+	pool_rewind(mark.pool, mark.offset);
+
+	#ifndef SYN_USE_RAW
+	table_rewind(mark.handle_mark);
+	#endif
+
+	arena_thread->scope_depth = mark.depth - 1;
+	if (arena_thread->scope_depth == 0) {
+		arena_thread->scope_pool = nullptr;
+		arena_thread->scope_offset = 0;
+	}
+}
+
+
+/* Every internal function works on arena_thread, so an explicit arena is swapped into	*
+ * it for the duration of the call, and whatever was there is put back afterwards.	*/
+static inline arena_t *arena_enter(arena_t *arena)
+{
+	arena_t *prev_arena = arena_thread;
+	arena_thread = arena;
+	return prev_arena;
+}
+
+
+syn_arena_t *syn_arena_create(const syn_arena_opts_t *opts)
+{
+	arena_t *prev_arena = arena_enter(nullptr);
+	const usize first_pool_size = (opts != nullptr) ? opts->first_pool_size : 0;
+
+	arena_t *new_arena = (arena_init(first_pool_size) == 0) ? arena_thread : nullptr;
+	if (new_arena == nullptr) {
+		sync_alloc_log.to_console(log_stderr, "OOM\n");
+	} else if (opts != nullptr && opts->meta_layout != SYN_META_DEFAULT) {
+		new_arena->slab_meta = (opts->meta_layout == SYN_META_OUT_OF_LINE);
+	}
+
+	arena_thread = prev_arena;
+	return new_arena;
+}
+
+
+void syn_arena_destroy(syn_arena_t *arena)
+{
+	if (arena == nullptr) {
+		return;
+	}
+	arena_t *prev_arena = arena_enter(arena);
+
+	#ifndef SYN_USE_RAW
+	// A file-backed arena outlives the process, so its blocks stay and only the file is closed.
+	if (arena->persist != nullptr) {
+		quarantine_flush();
+		arena->scope_pool = nullptr;
+		arena->scope_offset = 0;
+		arena->scope_depth = 0;
+		arena_thread = (prev_arena == arena) ? nullptr : prev_arena;
+		persist_close(arena);
+		return;
+	}
+	#endif
+	syn_destroy();
+	arena_thread = (prev_arena == arena) ? nullptr : prev_arena;
+}
+
+
+void syn_arena_reset(syn_arena_t *arena)
+{
+	if (arena == nullptr) {
+		return;
+	}
+	arena_t *prev_arena = arena_enter(arena);
+	syn_reset();
+	arena_thread = prev_arena;
+}
+
+
+void syn_set_sample_rate(const unsigned int rate)
+{
+	config_override_begin();
+	alloc_config.sample_rate = rate;
+	guard_set_sample_rate(rate);
+}
+
+
+void syn_set_meta_layout(const syn_meta_layout_t layout)
+{
+	config_override_begin();
+	alloc_config.meta_layout = (layout == SYN_META_OUT_OF_LINE) ? layout : SYN_META_INLINE;
+	slab_set_default_layout(layout == SYN_META_OUT_OF_LINE);
+}
+
+
+void syn_scrub_quarantine()
+{
+	if (arena_thread == nullptr || arena_thread->quarantine == nullptr) {
+		return;
+	}
+	quarantine_flush();
+}
+
+
+void syn_scrub_quarantine_in(syn_arena_t *arena)
+{
+	if (arena == nullptr) {
+		return;
+	}
+	arena_t *prev_arena = arena_enter(arena);
+	syn_scrub_quarantine();
+	arena_thread = prev_arena;
+}
+
+
+int syn_growbuf_reserve(void *restrict block_ptr, const size_t size)
+{
+	if (block_ptr == nullptr) {
+		return 1;
+	}
+	pool_header_t *head = return_header(block_ptr);
+	if ((head->bitflags & (F_GROWBUF | F_ALLOCATED)) != (F_GROWBUF | F_ALLOCATED)) {
+		sync_alloc_log.to_console(log_stderr, "syn_growbuf_reserve(): ptr %p is not a growbuf!\n", block_ptr);
+		return 1;
+	}
+	return growbuf_commit(head, size);
+}
+
+
+#ifdef SYN_USE_RAW
+
+void *syn_alloc(const usize size)
+{
+	return syn_alloc_aligned(size, ALIGNMENT);
+}
+
+
+void *syn_alloc_aligned(const usize size, const usize align)
+{
+	if (arena_thread != nullptr &&
+	    atomic_load_explicit(&arena_thread->remote_free, memory_order_relaxed) != nullptr) {
+		drain_remote_frees();
+	}
+
+	pool_header_t *new_head = alloc_header(size, align);
+	if (new_head == nullptr) {
+		return invalid_block();
+	}
+
+	new_head->bitflags |= F_RAW;
+	SYN_TRACE(alloc, size, trace_pool(new_head), trace_handle_index(new_head));
+	return return_block(new_head);
+}
+
+
+void *syn_calloc(const usize size)
+{
+	void *block_ptr = syn_alloc(size);
+	if (block_ptr == nullptr) {
+		return invalid_block();
+	}
+
+	pool_header_t *head = return_header(block_ptr);
+	if (!(head->bitflags & F_ZEROED)) {
+		syn_memset(block_ptr, 0, head->allocation_size);
+	}
+	return block_ptr;
+}
+
+
+void *syn_growbuf_create(const usize max_bytes)
+{
+	pool_header_t *new_head = alloc_growbuf_header(max_bytes);
+	if (new_head == nullptr) {
+		return invalid_block();
+	}
+
+	new_head->bitflags |= F_RAW;
+	return return_block(new_head);
+}
+
+
+void syn_free(void *restrict block_ptr)
+{
+	if (bad_alloc_check(block_ptr, 1) != 0) {
+		return;
+	}
+
+	pool_header_t *head = return_header(block_ptr);
+	SYN_TRACE(free, head->allocation_size, trace_pool(head), trace_handle_index(head));
+	// Guarded slots are process-wide, any thread can give them back.
+	if (head->bitflags & F_GUARDED) {
+		guard_free(head);
+		return;
+	}
+	arena_t *owner = return_arena(head);
+
+	if (owner != arena_thread) {
+		/* The owner does not clear F_ALLOCATED until it drains the block, so two threads	*
+		 * freeing it at once would both queue it. Only the one that swaps the magic does.	*/
+		u32 magic = RAW_HEADER_MAGIC;
+		if (!__atomic_compare_exchange_n(&head->magic, &magic, RAW_REMOTE_MAGIC, false,
+		                                 __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+			sync_alloc_log.to_console(log_stderr, "double free of %p detected!\n", block_ptr);
+			return;
+		}
+		remote_free_push(owner, block_ptr);
+		return;
+	}
+	release_header(head);
+}
+
+
+void *syn_realloc(void *restrict block_ptr, const usize size)
+{
+	if (block_ptr == nullptr) {
+		return syn_alloc(size);
+	}
+	if (size == 0) {
+		syn_free(block_ptr);
+		return invalid_block();
+	}
+	if (bad_alloc_check(block_ptr, 1) != 0) {
+		return invalid_block();
+	}
+
+	pool_header_t *old_head = return_header(block_ptr);
+	SYN_TRACE(realloc, size, trace_pool(old_head), trace_handle_index(old_head), old_head->allocation_size);
+	if (size <= old_head->allocation_size) {
+		return block_ptr;
+	}
+	// A growbuf only ever grows in place, past its reservation it fails instead of moving.
+	if (old_head->bitflags & F_GROWBUF) {
+		return (growbuf_commit(old_head, size) == 0) ? block_ptr : invalid_block();
+	}
+
+	// Only the owning thread may move a pool, blocks of other threads take the copying path.
+	if (return_arena(old_head) == arena_thread) {
+		pool_header_t *remapped_head = huge_remap(old_head, size);
+		if (remapped_head != nullptr) {
+			return return_block(remapped_head);
+		}
+	}
+	if (realloc_escapes_scope(old_head)) {
+		sync_alloc_log.to_console(log_stderr, "syn_realloc(): block predates the open scope and can not move!\n");
+		return invalid_block();
+	}
+
+	void *new_block_ptr = syn_alloc(size);
+	if (new_block_ptr == nullptr) {
+		return invalid_block();
+	}
+
+	syn_memcpy(new_block_ptr, block_ptr, old_head->allocation_size);
+	if (old_head->bitflags & F_SENSITIVE) {
+		mark_header_sensitive(return_header(new_block_ptr));
+	}
+
+	syn_free(block_ptr);
+	return new_block_ptr;
+}
+
+
+void *syn_freeze(void *restrict block_ptr)
+{
+	if (bad_alloc_check(block_ptr, 1) != 0) {
+		return nullptr;
+	}
+
+	pool_header_t *head = return_header(block_ptr);
+	SYN_TRACE(freeze, head->allocation_size, trace_pool(head), trace_handle_index(head));
+	head->bitflags |= F_FROZEN;
+	return block_ptr;
+}
+
+
+void syn_thaw(void *restrict block_ptr)
+{
+	if (bad_alloc_check(block_ptr, 1) != 2) {
+		return;
+	}
+
+	pool_header_t *head = return_header(block_ptr);
+	SYN_TRACE(thaw, head->allocation_size, trace_pool(head), trace_handle_index(head));
+	head->bitflags &= ~F_FROZEN;
+}
+
+
+int syn_mark_sensitive(void *restrict block_ptr)
+{
+	const int status = bad_alloc_check(block_ptr, 1);
+	if (status != 0 && status != 2) {
+		return 1;
+	}
+
+	mark_header_sensitive(return_header(block_ptr));
+	return 0;
+}
+
+
+void *syn_alloc_in(syn_arena_t *arena, const usize size)
+{
+	if (arena == nullptr) {
+		return invalid_block();
+	}
+	arena_t *prev_arena = arena_enter(arena);
+	void *block_ptr = syn_alloc(size);
+	arena_thread = prev_arena;
+	return block_ptr;
+}
+
+
+void *syn_calloc_in(syn_arena_t *arena, const usize size)
+{
+	if (arena == nullptr) {
+		return invalid_block();
 	}
+	arena_t *prev_arena = arena_enter(arena);
+	void *block_ptr = syn_calloc(size);
+	arena_thread = prev_arena;
+	return block_ptr;
+}
 
-	memory_pool_t *pool_arr[arena_thread->pool_count];
-	const int pool_arr_len = return_pool_array(pool_arr);
 
-	if (pool_arr_len == 0) {
+void syn_free_in(syn_arena_t *arena, void *restrict block_ptr)
+{
+	if (arena == nullptr) {
 		return;
 	}
-	pool_arr[0]->offset = 0;
-	for (int i = pool_arr_len - 1; i > 0; i--) {
-		syn_unmap_page(pool_arr[i]->mem, pool_arr[i]->size);
-	}
-
-	pool_arr[0]->offset = 0;
-	pool_arr[0]->free_count = 0;
-	pool_arr[0]->next_pool = nullptr;
-	pool_arr[0]->first_free = nullptr;
-	table_destructor();
+	arena_t *prev_arena = arena_enter(arena);
+	syn_free(block_ptr);
+	arena_thread = prev_arena;
 }
 
 
-[[nodiscard]]
-#ifdef SYN_USE_RAW
-
-void *syn_alloc(const usize size)
+void *syn_realloc_in(syn_arena_t *arena, void *restrict block_ptr, const usize size)
 {
+	if (arena == nullptr) {
+		return invalid_block();
+	}
+	arena_t *prev_arena = arena_enter(arena);
+	void *new_block_ptr = syn_realloc(block_ptr, size);
+	arena_thread = prev_arena;
+	return new_block_ptr;
 }
 
 #else
 
 syn_handle_t syn_alloc(const usize size)
 {
-	if (size == 0) {
-		return invalid_block();
-	}
-	if (arena_thread != nullptr) {
-		goto arena_initialized;
-	}
-	if (arena_init() != 0) {
-		sync_alloc_log.to_console(log_stderr, "OOM\n");
-		return invalid_block();
-	}
-
-arena_initialized:
+	return syn_alloc_aligned(size, ALIGNMENT);
+}
 
-	// TODO implement slabs for fast small-scale allocations
-	const u32 padded_size = (size < MINIMUM_BLOCK_ALLOC)
-	                                ? ADD_ALIGNMENT_PADDING(MINIMUM_BLOCK_ALLOC)
-	                                : ADD_ALIGNMENT_PADDING(size);
 
-	//if ((usize)MAX_ALLOC_POOL_SIZE < size) {
-	//	// TODO implement large page allocation
-	//	return invalid_block();
-	//}
-	bool retried = false;
-reloop:
-	pool_header_t *new_head = find_or_create_new_header(padded_size);
-	if (!new_head && retried) {
+syn_handle_t syn_alloc_aligned(const usize size, const usize align)
+{
+	pool_header_t *new_head = alloc_header(size, align);
+	if (new_head == nullptr) {
 		return invalid_block();
 	}
-	if (new_head == nullptr) {
-		pool_constructor(size);
-		retried = true;
-		goto reloop;
+
+	const syn_handle_t hdl = create_handle_and_entry(new_head);
+	if (hdl.generation == UINT32_MAX) {
+		release_header(new_head);
+		return hdl;
 	}
-	return create_handle_and_entry(new_head);
+	SYN_TRACE(alloc, size, trace_pool(new_head), trace_handle_index(new_head));
+	return hdl;
 }
-#endif
 
 
-inline syn_handle_t syn_calloc(const usize size)
+syn_handle_t syn_calloc(const usize size)
 {
 	if (size == 0) {
 		return invalid_block();
 	}
 
 	const syn_handle_t hdl = syn_alloc(size);
-	const bool is_invalid_hdl = (hdl.generation == UINT32_MAX ||
-	                             hdl.header->handle_matrix_index == UINT32_MAX ||
-	                             hdl.header == nullptr) != 0;
+	const bool is_invalid_hdl = (hdl.generation == UINT32_MAX || hdl.header == nullptr) != 0;
 
 	if (is_invalid_hdl) {
 		return invalid_block();
 	}
 
-	syn_memset(hdl.addr, 0, hdl.header->allocation_size);
+	if (!(hdl.header->bitflags & F_ZEROED)) {
+		syn_memset(hdl.addr, 0, hdl.header->allocation_size);
+	}
 	return hdl;
 }
 
 
-void syn_free(syn_handle_t *restrict user_handle)
+syn_handle_t syn_growbuf_create(const usize max_bytes)
 {
-	if (bad_alloc_check(user_handle, 1)) {
-		return;
+	pool_header_t *new_head = alloc_growbuf_header(max_bytes);
+	if (new_head == nullptr) {
+		return invalid_block();
 	}
 
-	pool_header_t *head = user_handle->header;
-	head->bitflags &= ~F_ALLOCATED;
-
-	if (head->bitflags & F_SENSITIVE) {
-		syn_memset((void *)BLOCK_ALIGN_PTR(head, ALIGNMENT), 0, head->allocation_size);
-		head->bitflags &= ~F_SENSITIVE;
+	const syn_handle_t hdl = create_handle_and_entry(new_head);
+	if (hdl.generation == UINT32_MAX) {
+		release_header(new_head);
 	}
+	return hdl;
+}
 
-	head->bitflags |= F_FREE;
-	user_handle->generation++;
-	user_handle->addr = nullptr;
 
+/// Retires a block's handle entry, then frees the block itself.
+static void release_handle(pool_header_t *head)
+{
 	const u32 row = head->handle_matrix_index / MAX_TABLE_HNDL_COLS;
 	const u32 col = head->handle_matrix_index % MAX_TABLE_HNDL_COLS;
 
@@ -193,11 +1021,38 @@ void syn_free(syn_handle_t *restrict user_handle)
 
 	table->entries_bitmap &= ~(1ULL << col);
 
-	pool_free_node_t *node = (pool_free_node_t *)head;
-	node->next_node = nullptr;
-	free_node_add(node);
+	head->bitflags &= ~F_FREE_PENDING;
+	release_header(head);
+}
 
-	update_sentinel_and_free_flags(head);
+
+void syn_free(syn_handle_t *restrict user_handle)
+{
+	const int status = bad_alloc_check(user_handle, 1);
+	if (status != 0 && status != 2) {
+		return;
+	}
+
+	pool_header_t *head = user_handle->header;
+	const bool pinned = (return_pin_count(head) != 0);
+	if (status == 2 && (!pinned || (head->bitflags & F_FROZEN))) {
+		return;
+	}
+	if (head->bitflags & F_FREE_PENDING) {
+		sync_alloc_log.to_console(log_stderr, "double free of a pinned block detected!\n");
+		return;
+	}
+	SYN_TRACE(free, head->allocation_size, trace_pool(head), trace_handle_index(head));
+
+	user_handle->generation++;
+	user_handle->addr = nullptr;
+
+	// The entry stays live so the holders of the pins can still release them.
+	if (pinned) {
+		head->bitflags |= F_FREE_PENDING;
+		return;
+	}
+	release_handle(head);
 }
 
 
@@ -207,46 +1062,48 @@ int syn_realloc(syn_handle_t *restrict user_handle, const usize size)
 		return 1;
 	}
 
-	// TODO huge page allocations
-	// TODO split the core allocation logic into a subfunction
-
 	pool_header_t *old_head = user_handle->header;
-	bool retried = false;
-retry:
-	pool_header_t *new_head = find_or_create_new_header(ADD_ALIGNMENT_PADDING(size));
-	if (new_head == nullptr && retried) {
+	SYN_TRACE(realloc, size, trace_pool(old_head), trace_handle_index(old_head), old_head->allocation_size);
+	// A growbuf only ever grows in place, past its reservation it fails instead of moving.
+	if (old_head->bitflags & F_GROWBUF) {
+		return growbuf_commit(old_head, size);
+	}
+
+	pool_header_t *remapped_head = huge_remap(old_head, size);
+	if (remapped_head != nullptr) {
+		handle_entry_t *entry = return_entry(remapped_head->handle_matrix_index);
+		entry->header = remapped_head;
+		entry->generation++;
+		*user_handle = handle_from_entry(entry);
+		return 0;
+	}
+	if (realloc_escapes_scope(old_head)) {
+		sync_alloc_log.to_console(log_stderr, "syn_realloc(): block predates the open scope and can not move!\n");
 		return 1;
 	}
 
+	pool_header_t *new_head = alloc_header(size, return_block_align(old_head));
 	if (new_head == nullptr) {
-		pool_constructor(size);
-		retried = true;
-		goto retry;
+		return 1;
 	}
 
-	const u32 new_block_data_size = old_head->chunk_size - STRUCT_SIZE_HEADER;
-
-	const void *old_block_data = ((char *)old_head + STRUCT_SIZE_HEADER);
-	void *new_block_data = ((char *)new_head + STRUCT_SIZE_HEADER);
+	const u32 copy_size = (old_head->allocation_size < new_head->allocation_size)
+	                              ? old_head->allocation_size
+	                              : new_head->allocation_size;
 
-	syn_memcpy(new_block_data, old_block_data, new_block_data_size);
-
-	user_handle->generation++;
-	user_handle->header = new_head;
-	user_handle->addr = (void *)BLOCK_ALIGN_PTR(new_head, ALIGNMENT);
-	new_head->bitflags = old_head->bitflags;
+	syn_memcpy(return_block(new_head), return_block(old_head), copy_size);
 
 	if (old_head->bitflags & F_SENSITIVE) {
-		syn_memset((char *)old_head + STRUCT_SIZE_HEADER,
-		           0,
-		           old_head->chunk_size - STRUCT_SIZE_HEADER);
-		old_head->bitflags &= ~F_SENSITIVE;
+		mark_header_sensitive(new_head);
 	}
+	new_head->handle_matrix_index = old_head->handle_matrix_index;
 
-	old_head->bitflags &= ~F_ALLOCATED;
-	old_head->bitflags |= F_FREE;
+	handle_entry_t *entry = return_entry(new_head->handle_matrix_index);
+	entry->header = new_head;
+	entry->generation++;
+	*user_handle = handle_from_entry(entry);
 
-	update_table_generation(user_handle->header->handle_matrix_index);
+	release_header(old_head);
 	return 0;
 }
 
@@ -257,8 +1114,10 @@ void *syn_freeze(syn_handle_t *restrict user_handle)
 		return nullptr;
 	}
 
-	user_handle->header->bitflags |= F_FROZEN;
-	user_handle->addr = (void *)BLOCK_ALIGN_PTR(user_handle->header, ALIGNMENT);
+	pool_header_t *head = user_handle->header;
+	SYN_TRACE(freeze, head->allocation_size, trace_pool(head), trace_handle_index(head));
+	head->bitflags |= F_FROZEN;
+	user_handle->addr = return_block(head);
 
 	update_table_generation(user_handle->header->handle_matrix_index);
 	return user_handle->addr;
@@ -276,13 +1135,290 @@ syn_handle_t syn_thaw(void *restrict block_ptr)
 		sync_alloc_log.to_console(log_stderr, "invalid block_ptr!\n");
 		return invalid_block();
 	}
-	syn_handle_t *table_hdl = return_handle(head->handle_matrix_index);
-	syn_handle_t user_hdl = *table_hdl;
-
-	table_hdl->generation++;
-	user_hdl.generation++;
+	if (arena_thread == nullptr || return_arena(head) != arena_thread) {
+		sync_alloc_log.to_console(log_stderr, "block_ptr belongs to a different arena!\n");
+		return invalid_block();
+	}
+	SYN_TRACE(thaw, head->allocation_size, trace_pool(head), trace_handle_index(head));
+	handle_entry_t *entry = return_entry(head->handle_matrix_index);
+	entry->generation++;
 
 	head->bitflags &= ~F_FROZEN;
 
-	return user_hdl;
+	return handle_from_entry(entry);
+}
+
+
+void *syn_pin(syn_handle_t *restrict user_handle)
+{
+	const int status = bad_alloc_check(user_handle, 1);
+	if (status != 0 && status != 2) {
+		return nullptr;
+	}
+
+	pool_header_t *head = user_handle->header;
+	if (head->bitflags & F_FREE_PENDING) {
+		sync_alloc_log.to_console(log_stderr, "syn_pin() called on a freed block!\n");
+		return nullptr;
+	}
+	if (return_pin_count(head) == PIN_COUNT_MAX) {
+		sync_alloc_log.to_console(log_stderr, "pin count overflow!\n");
+		return nullptr;
+	}
+	head->bitflags += (1U << PIN_COUNT_SHIFT);
+
+	return return_block(head);
+}
+
+
+void syn_unpin(syn_handle_t *restrict user_handle)
+{
+	const int status = bad_alloc_check(user_handle, 1);
+	if (status != 0 && status != 2) {
+		return;
+	}
+
+	pool_header_t *head = user_handle->header;
+	if (return_pin_count(head) == 0) {
+		sync_alloc_log.to_console(log_stderr, "syn_unpin() called on a block that is not pinned!\n");
+		return;
+	}
+	head->bitflags -= (1U << PIN_COUNT_SHIFT);
+
+	if (return_pin_count(head) == 0 && (head->bitflags & F_FREE_PENDING)) {
+		release_handle(head);
+	}
+}
+
+
+int syn_mark_sensitive(syn_handle_t *restrict user_handle)
+{
+	const int status = bad_alloc_check(user_handle, 1);
+	if (status != 0 && status != 2) {
+		return 1;
+	}
+
+	mark_header_sensitive(user_handle->header);
+	return 0;
+}
+
+
+syn_handle_t syn_alloc_in(syn_arena_t *arena, const usize size)
+{
+	if (arena == nullptr) {
+		return invalid_block();
+	}
+	arena_t *prev_arena = arena_enter(arena);
+	const syn_handle_t hdl = syn_alloc(size);
+	arena_thread = prev_arena;
+	return hdl;
+}
+
+
+syn_handle_t syn_calloc_in(syn_arena_t *arena, const usize size)
+{
+	if (arena == nullptr) {
+		return invalid_block();
+	}
+	arena_t *prev_arena = arena_enter(arena);
+	const syn_handle_t hdl = syn_calloc(size);
+	arena_thread = prev_arena;
+	return hdl;
+}
+
+
+void syn_free_in(syn_arena_t *arena, syn_handle_t *restrict user_handle)
+{
+	if (arena == nullptr) {
+		return;
+	}
+	arena_t *prev_arena = arena_enter(arena);
+	syn_free(user_handle);
+	arena_thread = prev_arena;
+}
+
+
+int syn_realloc_in(syn_arena_t *arena, syn_handle_t *restrict user_handle, const usize size)
+{
+	if (arena == nullptr) {
+		return 1;
+	}
+	arena_t *prev_arena = arena_enter(arena);
+	const int ret = syn_realloc(user_handle, size);
+	arena_thread = prev_arena;
+	return ret;
+}
+
+
+void *syn_freeze_in(syn_arena_t *arena, syn_handle_t *restrict user_handle)
+{
+	if (arena == nullptr) {
+		return nullptr;
+	}
+	arena_t *prev_arena = arena_enter(arena);
+	void *block_ptr = syn_freeze(user_handle);
+	arena_thread = prev_arena;
+	return block_ptr;
+}
+
+
+syn_handle_t syn_thaw_in(syn_arena_t *arena, void *restrict block_ptr)
+{
+	if (arena == nullptr) {
+		return invalid_block();
+	}
+	arena_t *prev_arena = arena_enter(arena);
+	const syn_handle_t hdl = syn_thaw(block_ptr);
+	arena_thread = prev_arena;
+	return hdl;
+}
+
+
+void *syn_pin_in(syn_arena_t *arena, syn_handle_t *restrict user_handle)
+{
+	if (arena == nullptr) {
+		return nullptr;
+	}
+	arena_t *prev_arena = arena_enter(arena);
+	void *block_ptr = syn_pin(user_handle);
+	arena_thread = prev_arena;
+	return block_ptr;
+}
+
+
+void syn_unpin_in(syn_arena_t *arena, syn_handle_t *restrict user_handle)
+{
+	if (arena == nullptr) {
+		return;
+	}
+	arena_t *prev_arena = arena_enter(arena);
+	syn_unpin(user_handle);
+	arena_thread = prev_arena;
+}
+
+
+
+static inline syn_ref_t ref_from_handle(const syn_handle_t *hdl)
+{
+	if (hdl->generation == UINT32_MAX || hdl->header == nullptr) {
+		return SYN_REF_INVALID;
+	}
+	return ((syn_ref_t)hdl->generation << 32) | hdl->header->handle_matrix_index;
+}
+
+
+/// Resolves a compact handle through the handle table, a stale ref comes back as an invalid handle.
+static syn_handle_t handle_from_ref(const syn_ref_t ref)
+{
+	if (ref == SYN_REF_INVALID || arena_thread == nullptr) {
+		return invalid_block();
+	}
+
+	const handle_entry_t *entry = return_live_entry((u32)ref);
+	if (entry == nullptr || entry->generation != (u32)(ref >> 32)) {
+		sync_alloc_log.to_console(log_stderr, "stale ref detected!\n");
+		return invalid_block();
+	}
+	return handle_from_entry(entry);
+}
+
+
+syn_ref_t syn_ref_alloc(const usize size)
+{
+	const syn_handle_t hdl = syn_alloc(size);
+	return ref_from_handle(&hdl);
+}
+
+
+syn_ref_t syn_ref_calloc(const usize size)
+{
+	const syn_handle_t hdl = syn_calloc(size);
+	return ref_from_handle(&hdl);
+}
+
+
+void syn_ref_free(const syn_ref_t ref)
+{
+	syn_handle_t hdl = handle_from_ref(ref);
+	syn_free(&hdl);
+}
+
+
+syn_ref_t syn_ref_realloc(const syn_ref_t ref, const usize size)
+{
+	syn_handle_t hdl = handle_from_ref(ref);
+	if (syn_realloc(&hdl, size) != 0) {
+		return SYN_REF_INVALID;
+	}
+	return ref_from_handle(&hdl);
+}
+
+
+void *syn_ref_freeze(const syn_ref_t ref)
+{
+	syn_handle_t hdl = handle_from_ref(ref);
+	return syn_freeze(&hdl);
+}
+
+
+syn_ref_t syn_ref_thaw(void *restrict block_ptr)
+{
+	const syn_handle_t hdl = syn_thaw(block_ptr);
+	return ref_from_handle(&hdl);
+}
+
+
+void *syn_ref_pin(const syn_ref_t ref)
+{
+	syn_handle_t hdl = handle_from_ref(ref);
+	return syn_pin(&hdl);
+}
+
+
+void syn_ref_unpin(const syn_ref_t ref)
+{
+	syn_handle_t hdl = handle_from_ref(ref);
+	syn_unpin(&hdl);
+}
+
+
+syn_ref_t syn_ref_from_handle(const syn_handle_t *user_handle)
+{
+	const int status = bad_alloc_check(user_handle, 1);
+	if (status != 0 && status != 2) {
+		return SYN_REF_INVALID;
+	}
+	return ref_from_handle(user_handle);
+}
+
+
+syn_handle_t syn_handle_from_ref(const syn_ref_t ref)
+{
+	return handle_from_ref(ref);
+}
+
+
+syn_ref_t syn_ref_from_handle_in(syn_arena_t *arena, const syn_handle_t *user_handle)
+{
+	if (arena == nullptr) {
+		return SYN_REF_INVALID;
+	}
+	arena_t *prev_arena = arena_enter(arena);
+	const syn_ref_t ref = syn_ref_from_handle(user_handle);
+	arena_thread = prev_arena;
+	return ref;
+}
+
+
+syn_handle_t syn_handle_from_ref_in(syn_arena_t *arena, const syn_ref_t ref)
+{
+	if (arena == nullptr) {
+		return invalid_block();
+	}
+	arena_t *prev_arena = arena_enter(arena);
+	const syn_handle_t hdl = handle_from_ref(ref);
+	arena_thread = prev_arena;
+	return hdl;
 }
+
+#endif